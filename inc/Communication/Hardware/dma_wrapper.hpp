@@ -6,25 +6,10 @@
  *
  ***********************************************************************/
 
+#pragma once
 #include "hardware/dma.h"
 #include "message_format.hpp"
 
-#define COUNT_MODE_SELF (1<<28)
-
-// Macro to get the number of bits in the ring buffer at compile time
-constexpr uint8_t RING_BITS = [](){
-    constexpr size_t n = Communication::BUFFER_SIZE;
-    static_assert((n & (n - 1)) == 0, "n must be a power of 2");
-    size_t m = Communication::BUFFER_SIZE;
-    uint8_t log = 0;
-    while (m > 1)
-    {
-        m >>= 1;
-        ++log;
-    }
-    return log;
-}();
-
 namespace Communication {
 namespace Hardware {
 
@@ -36,7 +21,7 @@ namespace Hardware {
     {
         public:
             /**
-             * @brief Configures the DMA channel for receiving data from a circular buffer.
+             * @brief Configures the DMA channel for receiving data into linear frame buffers.
              */
             RxDMA()
             {
@@ -48,8 +33,6 @@ namespace Hardware {
                 channel_config_set_transfer_data_size(&config, DMA_SIZE_8); // 8 bits transfer
                 channel_config_set_read_increment(&config, false);  // static read address
                 channel_config_set_write_increment(&config, true);  // write address increments
-                channel_config_set_ring(&config, true, RING_BITS);  // circular buffer
-                dma_channel_hw_addr(channel)->transfer_count |= COUNT_MODE_SELF; // self trigger
             }
             
             ~RxDMA()
@@ -59,11 +42,175 @@ namespace Hardware {
             }
 
             /**
-             * @brief Returns the next write address in the circular buffer.
+             * @brief Start receiving into a buffer.
+             * @param[in] buffer Destination buffer.
+             * @param[in] size Maximum number of bytes to receive.
+             * @param[in] crc Running Crc32 remainder the sniffer continues from, when sniffing.
+             */
+            void arm(uint8_t * buffer, size_t size, uint32_t crc = Crc32<>::initial())
+            {
+                armedSize = size;
+                if (sniffing)
+                {
+                    // The sniffer accumulates the bit reversed remainder
+                    dma_sniffer_set_data_accumulator(reverseBits(crc));
+                }
+                dma_channel_transfer_to_buffer_now(channel, buffer, size);
+            }
+
+            /**
+             * @brief Number of bytes written since the channel was armed, 0 if not armed.
+             */
+            size_t received() const
+            {
+                if (armedSize == 0)
+                {
+                    return 0;
+                }
+                return armedSize - dma_channel_hw_addr(channel)->transfer_count;
+            }
+
+            /**
+             * @brief Stop receiving.
+             * @return Number of bytes written to the buffer since it was armed, 0 if not armed.
+             */
+            size_t disarm()
+            {
+                if (armedSize == 0)
+                {
+                    return 0;
+                }
+                size_t length = received();
+                dma_channel_abort(channel);
+                armedSize = 0;
+                return length;
+            }
+
+            /**
+             * @brief Compute the CRC-32 of the received bytes with the DMA sniffer while they are
+             *        written, see Crc32. There is a single sniffer, shared by every channel.
+             * @param[in] enable Attach the sniffer to this channel or detach it.
+             */
+            void enableSniffer(bool enable)
+            {
+                channel_config_set_sniff_enable(&config, enable);
+                dma_channel_set_config(channel, &config, false);
+                if (enable)
+                {
+                    // Bit reversed data, reversed and inverted result gives the reflected CRC-32
+                    dma_sniffer_enable(channel, DMA_SNIFF_CTRL_CALC_VALUE_CRC32R, true);
+                    dma_sniffer_set_output_reverse_enabled(true);
+                    dma_sniffer_set_output_invert_enabled(true);
+                }
+                else if (sniffing)
+                {
+                    dma_sniffer_disable();
+                }
+                sniffing = enable;
+            }
+
+            /**
+             * @brief CRC-32 of the bytes received since the channel was armed, including any CRC
+             *        they end with.
+             */
+            uint32_t sniffedCrc() const
+            {
+                return dma_sniffer_get_data_accumulator();
+            }
+
+            /**
+             * @brief Wrap the write address on a ring buffer instead of a linear one.
+             * @param[in] sizeBits Log2 of the ring size, the ring must be aligned to its size.
+             */
+            void enableRing(uint sizeBits)
+            {
+                channel_config_set_ring(&config, true, sizeBits);
+                dma_channel_set_config(channel, &config, false);
+            }
+
+            /**
+             * @brief Address the next received byte will be written to.
+             */
+            uintptr_t writeAddress() const
+            {
+                return static_cast<uintptr_t>(dma_channel_hw_addr(channel)->write_addr);
+            }
+
+            bool isBusy() const
+            {
+                return dma_channel_is_busy(channel);
+            }
+
+            uint channel;
+            dma_channel_config config;
+            size_t armedSize = 0;
+            bool sniffing = false;
+
+        private:
+            static constexpr uint32_t reverseBits(uint32_t value)
+            {
+                value = ((value >> 1) & 0x55555555) | ((value & 0x55555555) << 1);
+                value = ((value >> 2) & 0x33333333) | ((value & 0x33333333) << 2);
+                value = ((value >> 4) & 0x0F0F0F0F) | ((value & 0x0F0F0F0F) << 4);
+                value = ((value >> 8) & 0x00FF00FF) | ((value & 0x00FF00FF) << 8);
+                return (value >> 16) | (value << 16);
+            }
+    };
+
+    /**
+     * @class TxDMA
+     * @brief RAII class to manage DMA transfers to send data to peripherals.
+     */
+    class TxDMA
+    {
+        public:
+            /**
+             * @brief Configures the DMA channel for sending from a linear buffer. 16 bit words keep
+             *        the upper bits of data registers (e.g. i2c CMD/STOP) cleared.
+             * @param[in] size Transfer data size.
+             */
+            explicit TxDMA(dma_channel_transfer_size size = DMA_SIZE_16)
+            {
+                // Allocate a dma channel
+                channel = dma_claim_unused_channel(true);
+
+                // Configure the dma channel
+                config = dma_channel_get_default_config(channel);
+                channel_config_set_transfer_data_size(&config, size);
+                channel_config_set_read_increment(&config, true);    // read address increments
+                channel_config_set_write_increment(&config, false);  // static write address
+            }
+
+            ~TxDMA()
+            {
+                // Free the dma channel
+                dma_channel_unclaim(channel);
+            }
+
+            /**
+             * @brief Start sending a buffer.
+             * @param[in] data Source buffer, must stay untouched until the transfer ends.
+             * @param[in] count Number of elements of the transfer data size to send.
+             */
+            void send(const void * data, size_t count)
+            {
+                dma_channel_transfer_from_buffer_now(channel, data, count);
+            }
+
+            bool isBusy() const
+            {
+                return dma_channel_is_busy(channel);
+            }
+
+            /**
+             * @brief Stop sending, if still in progress.
              */
-            uint8_t * getWriteAddress()
+            void stop()
             {
-                return reinterpret_cast<uint8_t*> (dma_channel_hw_addr(channel)->write_addr);
+                if (dma_channel_is_busy(channel))
+                {
+                    dma_channel_abort(channel);
+                }
             }
 
             uint channel;
@@ -10,12 +10,17 @@
 
 #include <cstdint>
 #include <cstdio>
+#include <atomic>
 #include "message_format.hpp"
+#include "frame_pool.hpp"
+#include "response_buffer.hpp"
+#include "comm_statistics.hpp"
 
 #include "hardware/i2c.h"
 #include "hardware/dma.h"
 #include "hardware/gpio.h"
 #include "hardware/irq.h"
+#include "hardware/timer.h"
 #include "dma_wrapper.hpp"
 
 // Declare the bits in the registers we use
@@ -37,11 +42,30 @@ namespace Hardware {
     // Declare config constants
     constexpr uint DEFAULT_I2C_BAUD_RATE = 400000;      // I2C baud rate b/s
     constexpr uint8_t DEFAULT_I2C_SLAVE_ADDRESS = 0x55; // I2C device address
-
     /**
      * @class I2CSlave
      * @brief Static class that configures I2C hardware as a slave and 
      * installs callbacks for read and write ISRs.
+     *
+     * @details
+     * Every received frame is written (by DMA or by the RX ISR) directly into a free slot of a
+     * frame pool, STOP_DET only publishes the slot. In Immediate mode the rxHandler is called
+     * from the ISR for each published frame. In Deferred mode the ISR does nothing else and the
+     * rxHandler is called from pump(), which keeps the interrupt latency bounded regardless of
+     * the handler's work. Without an rxHandler, frames are borrowed with receiveFrame().
+     *
+     * A response can be published ahead of time with publishResponse(). With DMA enabled, the
+     * first read request of the next master read starts a DMA transfer of the whole response
+     * into the TX FIFO, so the read costs one interrupt instead of one per byte. The response
+     * stays armed after a completed read until a newer one is published, so a master polling it
+     * without writing is served by DMA too. Bytes read past the end of the response, or without a
+     * published response, are fetched from the txHandler.
+     *
+     * Frames can carry an integrity check, see setIntegrity(). Corrupted frames are dropped
+     * before reaching the rxHandler or receiveFrame().
+     *
+     * A message id can be recognised on the first data byte, see setUrgentHandler(). With DMA,
+     * the first byte of each frame is then read by the RX ISR, which arms the DMA for the rest.
      */
     class I2CSlave
     {
@@ -54,13 +78,21 @@ namespace Hardware {
              * @param[in] txHandlerPtr Pointer to function that will be called
              *            once a message request is received.
              * @param[in] address I2C slave address.
-             * @param[in] dmaEnabled Enable or disable DMA transfers.
+             * @param[in] baudRate I2C baud rate.
+             * @param[in] enableDMA Enable or disable DMA transfers.
+             * @param[in] mode Context in which rxHandler is called.
              */
-            static void init(RxHandler rxHandlerPtr, TxHandler txHandlerPtr, uint8_t address, uint baudRate, bool enableDMA = true)
+            static void init(RxHandler rxHandlerPtr, TxHandler txHandlerPtr, uint8_t address, uint baudRate,
+                             bool enableDMA = true, DispatchMode mode = DispatchMode::Immediate)
             {
                 rxHandler = rxHandlerPtr;
                 txHandler = txHandlerPtr;
                 dmaEnabled = enableDMA;
+                dispatchMode = mode;
+                transactionStarted = false;
+                urgentHandler = nullptr;
+                // A response kept armed by a previous initialization is not sent
+                responses.withdraw();
 
                 // Use I2C0 on the default SDA and SCL pins (GP4, GP5 on a Pico)
                 gpio_set_dir(PICO_DEFAULT_I2C_SDA_PIN, GPIO_IN);
@@ -84,29 +116,162 @@ namespace Hardware {
                 // Enable dma transfers
                 if (dmaEnabled)
                 {
-                    i2c0_hw->dma_cr = DMA_RX;
+                    i2c0_hw->dma_cr = DMA_RX | DMA_TX;
                     channel_config_set_dreq(&dma.config, DREQ_I2C0_RX);
-                    dma_channel_configure(dma.channel, &dma.config, &rxBuffer.data_, &i2c0_hw->data_cmd, 1, true);
+                    dma_channel_configure(dma.channel, &dma.config, nullptr, &i2c0_hw->data_cmd, 0, false);
+                    channel_config_set_dreq(&txDma.config, DREQ_I2C0_TX);
+                    dma_channel_configure(txDma.channel, &txDma.config, &i2c0_hw->data_cmd, nullptr, 0, false);
                 }
                 else // enable irq otherwise
                 {
-                    i2c0_hw->intr_mask |= RX_FULL;
+                    hw_set_bits(&i2c0_hw->intr_mask, RX_FULL);
+                }
+
+                // Frames carry no integrity check until setIntegrity() is called
+                setIntegrity(Integrity::None);
+            }
+
+            /**
+             * @brief Set the integrity check received frames carry. To be called after init().
+             *        With DMA, CRC-32 is checked by the DMA sniffer while frames are received,
+             *        otherwise the CRC is computed when frames are dispatched or borrowed.
+             * @param[in] integrity Integrity check appended by the master.
+             */
+            static void setIntegrity(Integrity integrity)
+            {
+                sniffIntegrity = dmaEnabled && integrity == Integrity::Crc32;
+                if (dmaEnabled)
+                {
+                    dma.enableSniffer(sniffIntegrity);
+                }
+                rxFrames.setIntegrity(sniffIntegrity ? Integrity::None : integrity);
+            }
+
+            /**
+             * @brief Call a handler from the ISR as soon as the first data byte of a frame is
+             *        msgId, before the frame ends. The frame is still received and dispatched.
+             *        To be called after init().
+             * @param[in] msgId Message id to recognise.
+             * @param[in] handler Handler, nullptr to stop recognising the id.
+             */
+            static void setUrgentHandler(RxMessageId msgId, UrgentHandler handler)
+            {
+                urgentId = msgId;
+                urgentHandler = handler;
+            }
+
+            /**
+             * @brief Borrow the oldest received frame. To be used when no rxHandler is installed,
+             *        from a single context.
+             * @param[out] view View of the frame, the slot is reused once the view is released.
+             * @return False if no frame is pending.
+             */
+            static bool receiveFrame(RxFrames::View & view)
+            {
+                return rxFrames.receive(view);
+            }
+
+            /**
+             * @brief Call the rxHandler for the frames received so far, in Deferred mode. 
+             *        To be called periodically from a single context (main loop or core1).
+             * @param[in] budget Maximum number of frames to handle in this call.
+             * @return Number of frames handled.
+             */
+            static size_t pump(size_t budget = DEFAULT_DISPATCH_BUDGET)
+            {
+                if (dispatchMode != DispatchMode::Deferred || rxHandler == nullptr)
+                {
+                    return 0;
                 }
+                return rxFrames.dispatch(rxHandler, budget);
+            }
+
+            /**
+             * @brief Publish the response to send on the next master reads. To be called from a
+             *        single context. The previous response is replaced.
+             * @param[in] data Response bytes, copied.
+             * @param[in] length Response length.
+             * @return False if DMA is disabled or the response is longer than BUFFER_SIZE.
+             */
+            static bool publishResponse(const uint8_t * data, size_t length)
+            {
+                if (!dmaEnabled)
+                {
+                    return false;
+                }
+                return responses.publish(data, length);
+            }
+
+            /**
+             * @brief Number of responses cut short by a transmit abort.
+             */
+            static uint32_t txAborts()
+            {
+                return txAbortCount;
+            }
+
+            /**
+             * @brief Number of frames lost because every slot was in use.
+             */
+            static uint32_t droppedFrames()
+            {
+                return rxFrames.droppedFrames();
+            }
+
+            /**
+             * @brief Number of frames dropped because of a failed integrity check.
+             */
+            static uint32_t corruptedFrames()
+            {
+                return rxFrames.corruptedFrames();
+            }
+
+            /**
+             * @brief Longest time spent in the I2C interrupt handler since the last reset.
+             * @return Duration in microseconds.
+             */
+            static uint32_t worstIsrDuration()
+            {
+                return worstIsrUs;
+            }
+
+            /**
+             * @brief Restart the worst-case interrupt handler duration measurement.
+             */
+            static void resetWorstIsrDuration()
+            {
+                worstIsrUs = 0;
             }
 
         private:
             I2CSlave()= default; // Private constructor to avoid instance creation
             static RxHandler rxHandler;
             static TxHandler txHandler;
-            static Queue<uint8_t> rxBuffer;
+            static RxFrames rxFrames;
+            static Frame * rxFrame;
+            static uint8_t rxDiscard[BUFFER_SIZE];
             static bool txInProgress;
-            static bool rxInProgress;
             static RxDMA dma;
+            static TxDMA txDma;
             static bool dmaEnabled;
-            static uint8_t * bufferFront;
+            static bool sniffIntegrity;
+            static DispatchMode dispatchMode;
+            static volatile uint32_t worstIsrUs;
+            static uint32_t transactionStartUs;
+            static bool transactionStarted;
+            static UrgentHandler urgentHandler;
+            static RxMessageId urgentId;
+            static bool awaitingFirstByte;
+            static size_t rxHeadLength;   // Bytes of the frame read by the ISR before arming the DMA
+
+            // Responses as data_cmd words, CMD, STOP and RESTART bits cleared
+            static ResponseBuffer<uint16_t> responses;
+            static volatile uint32_t txAbortCount;
 
             static void i2c0_irq_handler()
             {
+                uint32_t start = time_us_32();
+
                 // Get interrupt status
                 uint32_t status = i2c0_hw->intr_stat;
                 
@@ -114,15 +279,23 @@ namespace Hardware {
                 if (status & (TX_ABRT | STOP_DET | START_DET)) {
                     if (status & TX_ABRT) {
                         i2c0_hw->clr_tx_abrt;
+                        if (finishResponse()) {
+                            txAbortCount = txAbortCount + 1;
+                        }
                     }
                     if (status & STOP_DET) {
                         stop_irq();
+                        if (transactionStarted) {
+                            transactionStarted = false;
+                            commStatistics.transactionLatency.record(start - transactionStartUs);
+                        }
                     }
                     if (status & START_DET) {
                         start_irq();
+                        transactionStarted = true;
+                        transactionStartUs = start;
                     }
                     txInProgress = false;
-                    rxInProgress = false;
                 }
 
                 // Check if we have received data from the I2C master
@@ -134,6 +307,13 @@ namespace Hardware {
                 if (status & TX_IRQ) {
                     tx_irq();
                 }
+
+                // Keep track of the service time
+                uint32_t elapsed = time_us_32() - start;
+                commStatistics.isrDuration.record(elapsed);
+                if (elapsed > worstIsrUs) {
+                    worstIsrUs = elapsed;
+                }
             }
 
             inline static void rx_irq()
@@ -142,12 +322,40 @@ namespace Hardware {
                 uint32_t value = i2c0_hw->data_cmd;
                 uint8_t data = value & DAT;
 
-                rxBuffer.push(data);
-                rxInProgress = true;
+                if (awaitingFirstByte)
+                {
+                    awaitingFirstByte = false;
+                    if (urgentHandler != nullptr && data == urgentId)
+                    {
+                        urgentHandler();
+                    }
+                    if (dmaEnabled)
+                    {
+                        receiveFirstByte(data);
+                        return;
+                    }
+                }
+
+                // Without a free slot the frame is dropped
+                if (rxFrame != nullptr && rxFrame->length < BUFFER_SIZE)
+                {
+                    rxFrame->data[rxFrame->length++] = data;
+                }
             }
 
             inline static void tx_irq()
             {
+                // First byte requested in this read, send the published response by DMA
+                if (!txInProgress)
+                {
+                    txInProgress = true;
+                    if (startResponse())
+                    {
+                        i2c0_hw->clr_rd_req;
+                        return;
+                    }
+                }
+
                 uint8_t data = 0;
                 if (txHandler != nullptr)
                 {
@@ -164,29 +372,135 @@ namespace Hardware {
             {
                 // Clear the interruption
                 i2c0_hw->clr_stop_det;
-                // If the transfer finished, call the handler
-                if (rxInProgress && rxHandler != nullptr)
+                // The master may have read less than the whole response, which is kept for the next read
+                finishResponse(true);
+                size_t length = 0;
+                if (dmaEnabled)
+                {
+                    hw_clear_bits(&i2c0_hw->intr_mask, RX_FULL);
+                    length = rxHeadLength + dma.disarm();
+                    rxHeadLength = 0;
+                }
+                if (rxFrame == nullptr)
+                {
+                    return;
+                }
+                if (dmaEnabled)
+                {
+                    rxFrame->length = length;
+                    if (sniffIntegrity && rxFrame->length > 0)
+                    {
+                        checkSniffedIntegrity();
+                    }
+                }
+                // Publish the slot if the master wrote something, otherwise it is reused
+                rxFrame = nullptr;
+                if (!rxFrames.publish())
+                {
+                    return;
+                }
+                commStatistics.frames.increment();
+                commStatistics.pendingFrames.update(static_cast<uint32_t>(rxFrames.pending()));
+                if (dispatchMode == DispatchMode::Immediate && rxHandler != nullptr)
+                {
+                    // Dispatch from the ISR
+                    rxFrames.dispatch(rxHandler, RX_FRAME_SLOTS);
+                }
+            }
+
+            /**
+             * @brief Strip the CRC-32 of the received frame if the sniffed CRC matches, otherwise reject it.
+             */
+            inline static void checkSniffedIntegrity()
+            {
+                constexpr uint32_t residue = Crc32<>::residue();
+                if (rxFrame->length > Crc32<>::SIZE && dma.sniffedCrc() == residue)
+                {
+                    rxFrame->length -= Crc32<>::SIZE;
+                }
+                else
                 {
-                    rxHandler(*bufferFront, rxBuffer.capacity, (bufferFront+1));
-                    rxBuffer.clear();
+                    rxFrames.reject();
                 }
             }
 
+            /**
+             * @brief Take the published response, if any, and start sending it.
+             * @return True if a DMA transfer was started.
+             */
+            inline static bool startResponse()
+            {
+                if (!dmaEnabled)
+                {
+                    return false;
+                }
+                size_t length;
+                const uint16_t * words = responses.take(length);
+                if (words == nullptr)
+                {
+                    return false;
+                }
+                txDma.send(words, length);
+                return true;
+            }
+
+            /**
+             * @brief Stop sending the current response, if any.
+             * @param[in] rearm Send the response again on the next read, unless a newer one was published.
+             * @return True if a response was being sent.
+             */
+            inline static bool finishResponse(bool rearm = false)
+            {
+                if (!responses.isSending())
+                {
+                    return false;
+                }
+                txDma.stop();
+                return responses.finish(rearm);
+            }
+
             inline static void start_irq()
             {
                 // Clear the interruption
                 i2c0_hw->clr_start_det;
-                // Get buffer front
+                // Get a slot for the incoming frame
+                rxFrame = rxFrames.acquire();
+                awaitingFirstByte = true;
                 if (dmaEnabled)
                 {
-                    bufferFront = dma.getWriteAddress();
-                }
-                else
-                {
-                    bufferFront = rxBuffer.front();
+                    if (urgentHandler != nullptr)
+                    {
+                        // The first byte is read by rx_irq, which arms the DMA
+                        hw_set_bits(&i2c0_hw->intr_mask, RX_FULL);
+                    }
+                    else
+                    {
+                        dma.arm(rxBuffer(), BUFFER_SIZE);
+                    }
                 }
-                // assert bufferFront is within the addresses of rxBuffer
-                assert(bufferFront >= rxBuffer.data_ && bufferFront <= rxBuffer.data_ + BUFFER_SIZE);
+            }
+
+            /**
+             * @brief Store the first byte of the frame and let the DMA receive the rest.
+             */
+            inline static void receiveFirstByte(uint8_t data)
+            {
+                hw_clear_bits(&i2c0_hw->intr_mask, RX_FULL);
+                uint8_t * buffer = rxBuffer();
+                buffer[0] = data;
+                rxHeadLength = 1;
+                // The sniffer continues the CRC from the first byte
+                dma.arm(buffer + 1, BUFFER_SIZE - 1, Crc32<>::update(Crc32<>::initial(), buffer, 1));
+            }
+
+            /**
+             * @brief Buffer the frame is received into. Without a free slot the frame is still
+             *        drained, so that its bytes do not stay in the RX FIFO and end up at the
+             *        beginning of the next frame.
+             */
+            inline static uint8_t * rxBuffer()
+            {
+                return (rxFrame != nullptr) ? rxFrame->data : rxDiscard;
             }
 
     };
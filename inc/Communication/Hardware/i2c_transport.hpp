@@ -0,0 +1,76 @@
+/***********************************************************************
+ * @file	:	i2c_transport.hpp
+ * @brief 	:	I2C transport
+ * 				ITransport implementation over the I2C slave of rp2350.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#pragma once
+#include "transport.hpp"
+#include "i2c_slave.hpp"
+
+namespace Communication {
+namespace Hardware {
+
+    /**
+     * @class I2CTransport
+     * @brief Adapter of the static I2CSlave to ITransport. There is a single I2C slave, so only
+     *        one instance should be started.
+     */
+    class I2CTransport : public ITransport
+    {
+        public:
+            /**
+             * @brief Constructor.
+             * @param[in] address I2C slave address.
+             * @param[in] baudRate I2C baud rate.
+             * @param[in] enableDMA Enable or disable DMA transfers.
+             */
+            explicit I2CTransport(uint8_t address = DEFAULT_I2C_SLAVE_ADDRESS, uint baudRate = DEFAULT_I2C_BAUD_RATE,
+                                  bool enableDMA = true)
+                : address(address), baudRate(baudRate), enableDMA(enableDMA) {}
+
+            void start(RxHandler rxHandler, TxHandler txHandler, DispatchMode mode) override
+            {
+                I2CSlave::init(rxHandler, txHandler, address, baudRate, enableDMA, mode);
+            }
+
+            void setIntegrity(Integrity integrity) override
+            {
+                I2CSlave::setIntegrity(integrity);
+            }
+
+            size_t pump(size_t budget = DEFAULT_DISPATCH_BUDGET) override
+            {
+                return I2CSlave::pump(budget);
+            }
+
+            bool publishResponse(const uint8_t * data, size_t length) override
+            {
+                return I2CSlave::publishResponse(data, length);
+            }
+
+            void setUrgentHandler(RxMessageId msgId, UrgentHandler handler) override
+            {
+                I2CSlave::setUrgentHandler(msgId, handler);
+            }
+
+            uint32_t droppedFrames() const override
+            {
+                return I2CSlave::droppedFrames();
+            }
+
+            uint32_t corruptedFrames() const override
+            {
+                return I2CSlave::corruptedFrames();
+            }
+
+        private:
+            uint8_t address;
+            uint baudRate;
+            bool enableDMA;
+    };
+
+} // namespace Hardware
+} // namespace Communication
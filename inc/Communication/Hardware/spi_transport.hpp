@@ -0,0 +1,85 @@
+/***********************************************************************
+ * @file	:	spi_transport.hpp
+ * @brief 	:	SPI transport
+ * 				ITransport implementation over the spi slave of rp2350.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#pragma once
+#include <cstdint>
+#include "transport.hpp"
+#include "response_buffer.hpp"
+
+#include "hardware/spi.h"
+#include "hardware/dma.h"
+#include "hardware/gpio.h"
+#include "dma_wrapper.hpp"
+
+namespace Communication {
+namespace Hardware {
+
+    // Declare config constants
+    constexpr uint DEFAULT_SPI_BAUD_RATE = 10000000; // Highest SPI clock expected from the master
+    constexpr uint DEFAULT_SPI_RX_PIN = 16;          // spi0 RX (MOSI in slave mode)
+    constexpr uint DEFAULT_SPI_CS_PIN = 17;          // spi0 CSn
+    constexpr uint DEFAULT_SPI_SCK_PIN = 18;         // spi0 SCK
+    constexpr uint DEFAULT_SPI_TX_PIN = 19;          // spi0 TX (MISO in slave mode)
+
+    /**
+     * @class SpiTransport
+     * @brief Transport over an spi slave, one frame per chip select assertion.
+     *
+     * @details
+     * On the chip select falling edge a frame slot is armed for the RX DMA and the published
+     * response, padded with zeros to BUFFER_SIZE, is loaded by the TX DMA. On the rising edge the
+     * frame is published. Being full duplex, the response to a frame is clocked out during the
+     * next transaction, and the master should leave a few microseconds between chip select and
+     * the first clock edge. Only one SpiTransport can be started, the chip select interrupt is
+     * shared by all gpios. The txHandler is not used.
+     */
+    class SpiTransport : public PooledTransport
+    {
+        public:
+            /**
+             * @brief Constructor.
+             * @param[in] spi Spi instance.
+             * @param[in] rxPin RX pin.
+             * @param[in] csPin Chip select pin.
+             * @param[in] sckPin Clock pin.
+             * @param[in] txPin TX pin.
+             * @param[in] baudRate Highest clock rate expected from the master.
+             */
+            explicit SpiTransport(spi_inst_t * spi = spi0, uint rxPin = DEFAULT_SPI_RX_PIN, uint csPin = DEFAULT_SPI_CS_PIN,
+                                  uint sckPin = DEFAULT_SPI_SCK_PIN, uint txPin = DEFAULT_SPI_TX_PIN,
+                                  uint baudRate = DEFAULT_SPI_BAUD_RATE);
+
+            void start(RxHandler rxHandler, TxHandler txHandler, DispatchMode mode) override;
+
+            /**
+             * @brief Publish the response clocked out during the next transaction. A response
+             *        not yet sent is replaced.
+             */
+            bool publishResponse(const uint8_t * data, size_t length) override;
+
+        private:
+            static void csIrqHandler(uint gpio, uint32_t events);
+            void transactionStart();
+            void transactionEnd();
+
+            static SpiTransport * active;
+
+            spi_inst_t * spi;
+            uint rxPin;
+            uint csPin;
+            uint sckPin;
+            uint txPin;
+            uint baudRate;
+            RxDMA rxDma;
+            TxDMA txDma;
+            Frame * rxFrame;
+            ResponseBuffer<uint8_t> responses;
+    };
+
+} // namespace Hardware
+} // namespace Communication
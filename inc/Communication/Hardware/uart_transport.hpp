@@ -0,0 +1,79 @@
+/***********************************************************************
+ * @file	:	uart_transport.hpp
+ * @brief 	:	UART transport
+ * 				ITransport implementation over a DMA driven uart of rp2350.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#pragma once
+#include <cstdint>
+#include "transport.hpp"
+#include "stream_framing.hpp"
+
+#include "hardware/uart.h"
+#include "hardware/dma.h"
+#include "hardware/gpio.h"
+#include "dma_wrapper.hpp"
+
+namespace Communication {
+namespace Hardware {
+
+    // Declare config constants
+    constexpr uint DEFAULT_UART_BAUD_RATE = 921600; // UART baud rate b/s
+    constexpr uint DEFAULT_UART_TX_PIN = 8;         // uart1 TX, uart0 is kept for stdio
+    constexpr uint DEFAULT_UART_RX_PIN = 9;         // uart1 RX
+    constexpr uint UART_RX_RING_BITS = 8;           // Log2 of the receive ring size
+    constexpr size_t UART_RX_RING_SIZE = 1u << UART_RX_RING_BITS;
+
+    /**
+     * @class UartTransport
+     * @brief Transport over a full duplex uart, frames delimited with stream framing.
+     *
+     * @details
+     * A DMA channel writes every received byte into a ring buffer with no interrupt at all. pump()
+     * decodes the bytes received since the last call into the frame pool and dispatches them, so
+     * frames are handled from pump() whatever the dispatch mode, and pump() must be called before
+     * UART_RX_RING_SIZE bytes arrive, older bytes are overwritten and counted as ring overruns.
+     * Responses are sent right away by a second DMA channel,
+     * there are no master reads so the txHandler is not used.
+     */
+    class UartTransport : public PooledTransport
+    {
+        public:
+            /**
+             * @brief Constructor.
+             * @param[in] uart Uart instance, uart0 is used by stdio.
+             * @param[in] txPin TX pin.
+             * @param[in] rxPin RX pin.
+             * @param[in] baudRate Baud rate.
+             */
+            explicit UartTransport(uart_inst_t * uart = uart1, uint txPin = DEFAULT_UART_TX_PIN,
+                                   uint rxPin = DEFAULT_UART_RX_PIN, uint baudRate = DEFAULT_UART_BAUD_RATE);
+
+            void start(RxHandler rxHandler, TxHandler txHandler, DispatchMode mode) override;
+            size_t pump(size_t budget = DEFAULT_DISPATCH_BUDGET) override;
+
+            /**
+             * @brief Send a response.
+             * @return False if the previous response is still being sent.
+             */
+            bool publishResponse(const uint8_t * data, size_t length) override;
+
+        private:
+            void drainRing();
+
+            uart_inst_t * uart;
+            uint txPin;
+            uint rxPin;
+            uint baudRate;
+            RxDMA rxDma;
+            TxDMA txDma;
+            StreamDecoder decoder;
+            size_t rxConsumed;  // Bytes decoded since the channel was armed
+            alignas(UART_RX_RING_SIZE) uint8_t rxRing[UART_RX_RING_SIZE];
+            uint8_t txBuffer[STREAM_FRAME_SIZE];
+    };
+
+} // namespace Hardware
+} // namespace Communication
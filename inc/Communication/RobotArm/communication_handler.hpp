@@ -7,12 +7,17 @@
 
 #pragma once
 #include <cstdint>
-#include <unordered_map>
 #include <cstring>
 #include <memory>
-#include <functional>
+#include <array>
 #include "message_format.hpp"
+#include "segmented_transfer.hpp"
+#include "transport.hpp"
+#include "comm_statistics.hpp"
+#include "transaction_table.hpp"
+#include "frame_trace.hpp"
 #include "trajectory.hpp"
+#include "task_scheduler.hpp"
 
 namespace Communication {
 namespace RobotArm {
@@ -33,52 +38,220 @@ namespace RobotArm {
         PAUSE = 0x05,
         RESUME = 0x06,
         PROGRAM_DATA = 0x07,
-        MCU_RESET = 0x08
+        MCU_RESET = 0x08,
+        PROGRAM_SEGMENT = 0x09,     // PROGRAM_DATA sent as one segmented message
+        DIAGNOSTICS = 0x0A,         // Select a page of the communication statistics as response
+        PROGRAM_QUANTIZED = 0x0B,   // Segmented program of a WaypointScale_t followed by QuantizedWaypoint_t
+        PROGRAM_COMPRESSED = 0x0C   // Segmented program of a WaypointScale_t followed by a WaypointEncoder stream
     };
 
-    // Define callback function signature
-    using Callback = std::function<void(const uint8_t * msgData, const size_t dataLength)>;
+    // Segmented program transfer parameters
+    constexpr uint8_t PROGRAM_BLOCK_SIZE = 0;          // No flow control frame needed between consecutive frames
+    constexpr uint8_t PROGRAM_SEPARATION_TIME = 0;     // Consecutive frames can be sent back to back
+    constexpr uint32_t MAX_PROGRAM_WAYPOINTS = 10000;  // Longest program accepted in a single transfer
 
-    void emergencyStopCallback(const uint8_t * msgData, const size_t dataLength);
-    void cancelOperationCallback(const uint8_t * msgData, const size_t dataLength);
-    void loadProgramCallback(const uint8_t * msgData, const size_t dataLength);
-    void programDataCallback(const uint8_t * msgData, const size_t dataLength);
-    void teachProgramCallback(const uint8_t * msgData, const size_t dataLength);
-    void startProgramCallback(const uint8_t * msgData, const size_t dataLength);
-    void pauseProgramCallback(const uint8_t * msgData, const size_t dataLength);
-    void resumeProgramCallback(const uint8_t * msgData, const size_t dataLength);
-    void resetCallback(const uint8_t * msgData, const size_t dataLength);
+    // Integrity check carried by received frames and responses, the master must append the same one
+    constexpr Integrity FRAME_INTEGRITY = Integrity::None;
+
+    // Diagnostic responses are [DIAGNOSTICS][page][words], words of the snapshot in little endian
+    constexpr uint8_t DIAGNOSTIC_RESET_PAGE = 0xFF;    // Requesting this page restarts the statistics
+    constexpr size_t DIAGNOSTIC_HEADER_SIZE = 2;
+    constexpr size_t DIAGNOSTIC_PAGE_WORDS =
+        (BUFFER_SIZE - DIAGNOSTIC_HEADER_SIZE - integritySize(FRAME_INTEGRITY)) / sizeof(uint32_t);
+    // Pages from DIAGNOSTIC_TASK_PAGE on hold the words of the scheduler set with setTaskScheduler(),
+    // TASK_STAT_WORDS per task, after the communication statistics
+    constexpr size_t DIAGNOSTIC_TASK_PAGE =
+        (static_cast<size_t>(StatWord::Count) + DIAGNOSTIC_PAGE_WORDS - 1) / DIAGNOSTIC_PAGE_WORDS;
+    constexpr size_t DIAGNOSTIC_WORDS =
+        DIAGNOSTIC_TASK_PAGE * DIAGNOSTIC_PAGE_WORDS + Utilities::MAX_TASKS * Utilities::TASK_STAT_WORDS;
+    static_assert(DIAGNOSTIC_WORDS <= DIAGNOSTIC_RESET_PAGE * DIAGNOSTIC_PAGE_WORDS, "Diagnostic pages overlap the reset page");
+
+    // Requests tagged with a transaction id whose responses are remembered, see TransactionTable
+    constexpr size_t TRANSACTION_SLOTS = 6;
+    static_assert(TRANSACTION_SLOTS * NEGATIVE_RESPONSE_SIZE + integritySize(FRAME_INTEGRITY) <= BUFFER_SIZE,
+                  "Transaction responses do not fit in a frame");
+
+    // Define callback function signature, returning the outcome of the request
+    using Callback = ResponseCode (*)(const uint8_t * msgData, const size_t dataLength);
 
     /**
-     * @brief Dictionary to map received message ids to their respective callbacks.
+     * @brief Association of a received message id with its callback.
      */
-    const std::unordered_map<RxMessageId, Callback> messageDictionary =
+    struct MessageEntry
+    {
+        RxIds id;
+        Callback callback;
+    };
+
+    /**
+     * @brief Dispatch table with one callback slot per possible message id.
+     */
+    using MessageTable = std::array<Callback, 256>;
+
+    /**
+     * @brief Check at compile time that no message id is registered twice.
+     * @param[in] entries Message entries.
+     * @return True if all ids are unique.
+     */
+    template <size_t N>
+    consteval bool hasUniqueIds(const MessageEntry (&entries)[N])
+    {
+        for (size_t i = 0; i < N; i++)
         {
-            {RAW(RxIds::EMERGENCY_STOP), emergencyStopCallback},
-            {RAW(RxIds::CANCEL), cancelOperationCallback},
-            {RAW(RxIds::LOAD), loadProgramCallback},
-            {RAW(RxIds::TEACH), teachProgramCallback},
-            {RAW(RxIds::START), startProgramCallback},
-            {RAW(RxIds::PAUSE), pauseProgramCallback},
-            {RAW(RxIds::RESUME), resumeProgramCallback},
-            {RAW(RxIds::PROGRAM_DATA), programDataCallback},
-            {RAW(RxIds::MCU_RESET), resetCallback}
+            for (size_t j = i + 1; j < N; j++)
+            {
+                if (entries[i].id == entries[j].id)
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Check at compile time that message ids leave room for the transaction flag and
+     *        their positive response ids.
+     * @param[in] entries Message entries.
+     * @return True if all ids are below POSITIVE_RESPONSE_OFFSET.
+     */
+    template <size_t N>
+    consteval bool hasResponseIds(const MessageEntry (&entries)[N])
+    {
+        for (size_t i = 0; i < N; i++)
+        {
+            if (static_cast<RxMessageId>(entries[i].id) >= POSITIVE_RESPONSE_OFFSET)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Build the dispatch table at compile time. Unregistered ids map to nullptr.
+     * @param[in] entries Message entries.
+     * @return Table indexed by message id.
+     */
+    template <size_t N>
+    consteval MessageTable makeMessageTable(const MessageEntry (&entries)[N])
+    {
+        MessageTable table{};
+        for (size_t i = 0; i < N; i++)
+        {
+            table[RAW(entries[i].id)] = entries[i].callback;
+        }
+        return table;
+    }
+
+    ResponseCode emergencyStopCallback(const uint8_t * msgData, const size_t dataLength);
+    ResponseCode cancelOperationCallback(const uint8_t * msgData, const size_t dataLength);
+    ResponseCode loadProgramCallback(const uint8_t * msgData, const size_t dataLength);
+    ResponseCode programDataCallback(const uint8_t * msgData, const size_t dataLength);
+    ResponseCode teachProgramCallback(const uint8_t * msgData, const size_t dataLength);
+    ResponseCode startProgramCallback(const uint8_t * msgData, const size_t dataLength);
+    ResponseCode pauseProgramCallback(const uint8_t * msgData, const size_t dataLength);
+    ResponseCode resumeProgramCallback(const uint8_t * msgData, const size_t dataLength);
+    ResponseCode resetCallback(const uint8_t * msgData, const size_t dataLength);
+    ResponseCode programSegmentCallback(const uint8_t * msgData, const size_t dataLength);
+    ResponseCode quantizedProgramCallback(const uint8_t * msgData, const size_t dataLength);
+    ResponseCode compressedProgramCallback(const uint8_t * msgData, const size_t dataLength);
+    ResponseCode diagnosticsCallback(const uint8_t * msgData, const size_t dataLength);
+
+    /**
+     * @brief Received message ids and their respective callbacks.
+     */
+    inline constexpr MessageEntry messageEntries[] =
+        {
+            {RxIds::EMERGENCY_STOP, emergencyStopCallback},
+            {RxIds::CANCEL, cancelOperationCallback},
+            {RxIds::LOAD, loadProgramCallback},
+            {RxIds::TEACH, teachProgramCallback},
+            {RxIds::START, startProgramCallback},
+            {RxIds::PAUSE, pauseProgramCallback},
+            {RxIds::RESUME, resumeProgramCallback},
+            {RxIds::PROGRAM_DATA, programDataCallback},
+            {RxIds::MCU_RESET, resetCallback},
+            {RxIds::PROGRAM_SEGMENT, programSegmentCallback},
+            {RxIds::DIAGNOSTICS, diagnosticsCallback},
+            {RxIds::PROGRAM_QUANTIZED, quantizedProgramCallback},
+            {RxIds::PROGRAM_COMPRESSED, compressedProgramCallback}
         };
 
+    static_assert(hasUniqueIds(messageEntries), "A message id is registered more than once");
+    static_assert(hasResponseIds(messageEntries), "A message id overlaps its positive response id");
+
+    /**
+     * @brief Dictionary to map received message ids to their respective callbacks,
+     *        generated at compile time so dispatch is a single indexed call.
+     */
+    inline constexpr MessageTable messageDictionary = makeMessageTable(messageEntries);
+
     /**
-     * @brief Callback function to be called when a message is received.
+     * @brief Callback function to be called when a message is received. A message id with
+     *        TRANSACTION_FLAG set is a request whose first data byte is a transaction id, its
+     *        outcome is recorded for getResponse() instead of being discarded.
      * @param[in] msgId Received message id.
      * @param[in] dataLength Length of the received message.
      * @param[in] msgData Pointer to the received message.
      */
-    void rxCallback(RxMessageId msgId, size_t dataLength, uint8_t * msgData);
+    void rxCallback(RxMessageId msgId, size_t dataLength, const uint8_t * msgData);
 
     /**
-     * @brief Callback function to be called when a message is transmitted.
+     * @brief Callback function to be called when a message is transmitted, one byte at a time.
+     *        The response of getResponse() is sent, from its first byte after every received message.
      * @param[out] msgData Pointer to the transmitted message.
      */
     void txCallback(uint8_t * msgData);
 
+    /**
+     * @brief Build the response to the messages received so far, so that it can be published
+     *        as a whole ahead of the next master read. After a request with a transaction id,
+     *        it is the responses to the last TRANSACTION_SLOTS such requests, in completion order.
+     *        After a DIAGNOSTICS message, it is the selected statistics page. While a segmented
+     *        program transfer is active, it is the flow control frame.
+     * @param[out] msgData Buffer of at least BUFFER_SIZE bytes.
+     * @return Response length.
+     */
+    size_t getResponse(uint8_t * msgData);
+
+    /**
+     * @brief Start the services on a transport, with rxCallback and txCallback as handlers.
+     *        Emergency stops latch Motor::EmergencyStopLatch from the receive interrupt on
+     *        transports that recognise message ids, and from rxCallback otherwise.
+     * @param[in] transport Transport to serve, any bus or a host loopback.
+     * @param[in] mode Context in which received messages are handled.
+     */
+    void startServices(ITransport & transport, DispatchMode mode);
+
+    /**
+     * @brief Stop serving the transport of startServices(), which can then be destroyed, and drop
+     *        the program transfers, transactions and diagnostic page in progress.
+     */
+    void stopServices();
+
+    /**
+     * @brief Handle the messages received by a transport and publish the response, when some
+     *        were handled. To be called periodically from a single context.
+     * @param[in] transport Transport started with startServices().
+     * @param[in] budget Maximum number of messages to handle in this call.
+     * @return Number of messages handled.
+     */
+    size_t serviceTransport(ITransport & transport, size_t budget = DEFAULT_DISPATCH_BUDGET);
+
+    /**
+     * @brief Record every received message, as handed to rxCallback, for replay on the host.
+     * @param[in] recorder Recorder, nullptr to stop recording.
+     */
+    void setTraceRecorder(TraceRecorder * recorder);
+
+    /**
+     * @brief Serve the task statistics of a scheduler on the diagnostic pages from
+     *        DIAGNOSTIC_TASK_PAGE on. Read while the scheduler runs, a word may mix two runs.
+     * @param[in] scheduler Scheduler, nullptr to serve zeros.
+     */
+    void setTaskScheduler(const Utilities::TaskScheduler * scheduler);
+
     /**
      * @brief Install the program data container.
      * @param[in] via_points Pointer to the trajectory object.
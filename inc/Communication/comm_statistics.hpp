@@ -0,0 +1,173 @@
+/***********************************************************************
+ * @file	:	comm_statistics.hpp
+ * @brief 	:	Communication statistics
+ *              Low overhead counters, log2 histograms and high
+ *              watermarks, cheap enough for the interrupt path.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <bit>
+
+namespace Communication {
+
+    /**
+     * @class StatCounter
+     * @brief Counter with a single writing context and any number of readers.
+     *
+     * @details
+     * A relaxed load and store instead of a read-modify-write, so no exclusive monitor loop nor
+     * critical section is needed on the interrupt path. Counts wrap at 2^32.
+     */
+    class StatCounter
+    {
+        public:
+            inline void increment()
+            {
+                value.store(value.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            }
+
+            inline uint32_t get() const
+            {
+                return value.load(std::memory_order_relaxed);
+            }
+
+            inline void reset()
+            {
+                value.store(0, std::memory_order_relaxed);
+            }
+
+        private:
+            std::atomic<uint32_t> value{0};
+    };
+
+    /**
+     * @class HighWatermark
+     * @brief Highest value seen, with a single writing context.
+     */
+    class HighWatermark
+    {
+        public:
+            inline void update(uint32_t sample)
+            {
+                if (sample > value.load(std::memory_order_relaxed))
+                {
+                    value.store(sample, std::memory_order_relaxed);
+                }
+            }
+
+            inline uint32_t get() const
+            {
+                return value.load(std::memory_order_relaxed);
+            }
+
+            inline void reset()
+            {
+                value.store(0, std::memory_order_relaxed);
+            }
+
+        private:
+            std::atomic<uint32_t> value{0};
+    };
+
+    constexpr size_t HISTOGRAM_BUCKETS = 16;
+
+    /**
+     * @class Log2Histogram
+     * @brief Histogram with power of 2 buckets, with a single writing context.
+     *        Bucket 0 counts 0, bucket k counts [2^(k-1), 2^k) and the last one everything above.
+     */
+    class Log2Histogram
+    {
+        public:
+            inline void record(uint32_t sample)
+            {
+                buckets[bucketOf(sample)].increment();
+            }
+
+            static constexpr size_t bucketOf(uint32_t sample)
+            {
+                size_t bucket = static_cast<size_t>(std::bit_width(sample));
+                return (bucket < HISTOGRAM_BUCKETS) ? bucket : HISTOGRAM_BUCKETS - 1;
+            }
+
+            inline uint32_t count(size_t bucket) const
+            {
+                return buckets[bucket].get();
+            }
+
+            void reset()
+            {
+                for (StatCounter & bucket : buckets)
+                {
+                    bucket.reset();
+                }
+            }
+
+        private:
+            StatCounter buckets[HISTOGRAM_BUCKETS];
+    };
+
+    /**
+     * @brief Words of a statistics snapshot, as served by the diagnostic service.
+     *        Histograms take HISTOGRAM_BUCKETS words and message counts one word per id.
+     */
+    enum class StatWord : uint16_t
+    {
+        Frames = 0,             // Frames completed by the transport
+        UnknownIds,             // Frames whose message id has no handler
+        DroppedFrames,          // Frames lost for lack of a free slot
+        CorruptedFrames,        // Frames failing the integrity check
+        PendingHighWatermark,   // Most frames waiting to be handled at once
+        RingWraps,              // Wraps of DMA receive rings
+        RingOverruns,           // Bytes overwritten in DMA receive rings before being read
+        TransactionLatency,     // START_DET to STOP_DET histogram, in us
+        IsrDuration = TransactionLatency + HISTOGRAM_BUCKETS, // Interrupt handler histogram, in us
+        MessageCounts = IsrDuration + HISTOGRAM_BUCKETS,      // Frames handled per message id
+        Count = MessageCounts + 256
+    };
+
+    /**
+     * @class CommStatistics
+     * @brief Statistics block of the communication stack. Each member has a single writing
+     *        context: the transport ISR for frames, latencies and watermarks, the dispatch
+     *        context for message counts.
+     */
+    class CommStatistics
+    {
+        public:
+            StatCounter frames;
+            StatCounter unknownIds;
+            StatCounter ringWraps;
+            StatCounter ringOverruns;
+            HighWatermark pendingFrames;
+            Log2Histogram transactionLatency;
+            Log2Histogram isrDuration;
+            StatCounter messages[256];
+
+            /**
+             * @brief Read a word of the snapshot.
+             * @param[in] index Word index, see StatWord.
+             * @param[in] dropped Frames dropped, counted by the transport.
+             * @param[in] corrupted Frames corrupted, counted by the transport.
+             * @return Word value, 0 past the end of the snapshot.
+             */
+            uint32_t word(size_t index, uint32_t dropped = 0, uint32_t corrupted = 0) const;
+
+            /**
+             * @brief Restart every statistic. Not synchronized with the writers, counts of the
+             *        frames being handled meanwhile may be kept.
+             */
+            void reset();
+    };
+
+    /**
+     * @brief Statistics of the communication stack, shared by transports and services.
+     */
+    extern CommStatistics commStatistics;
+
+} // namespace Communication
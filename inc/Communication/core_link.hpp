@@ -0,0 +1,93 @@
+/***********************************************************************
+ * @file	:	core_link.hpp
+ * @brief 	:	Inter-core program link
+ *              Hands program data received on the communication core
+ *              to the trajectory of the control core.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include "message_format.hpp"
+#include "trajectory.hpp"
+
+namespace Communication {
+
+    constexpr size_t CORE_LINK_SLOTS = 16;                                  // Chunks in flight between cores
+    constexpr size_t CORE_LINK_CHUNK_SIZE = sizeof(Robotics::WaypointScale_t); // Holds a scale, 2 or 4 waypoints
+
+    /**
+     * @brief Kind of program data carried by a chunk.
+     */
+    enum class ChunkKind : uint8_t
+    {
+        Waypoints,          // Waypoint_t records
+        QuantizedWaypoints, // QuantizedWaypoint_t records
+        Scale               // WaypointScale_t
+    };
+
+    /**
+     * @brief Piece of program data in flight between cores.
+     */
+    struct ProgramChunk
+    {
+        ChunkKind kind;
+        uint8_t length;
+        uint8_t data[CORE_LINK_CHUNK_SIZE];
+    };
+
+    /**
+     * @class ProgramLink
+     * @brief Trajectory to install on the communication core, forwarding the program data it is
+     *        given through a lock-free ring to the trajectory of the control core.
+     *
+     * @details
+     * The communication core saves into the link as it would into a trajectory, and the control
+     * core applies the chunks to its own trajectory with drain(), from its loop. No lock is shared,
+     * so waypoints never delay the control loop. When the ring is full the communication core
+     * waits for the control core to drain it, so no program data is lost.
+     */
+    class ProgramLink : public Robotics::Trajectory
+    {
+        public:
+            ProgramLink() = default;
+
+            void saveWaypoints(const uint8_t * rawWaypoints, const size_t size) override;
+            void setScale(const Robotics::WaypointScale_t & scale) override;
+            void saveQuantizedWaypoints(const uint8_t * rawWaypoints, const size_t size) override;
+
+            /**
+             * @brief Apply the chunks received so far. To be called from the control core only.
+             * @param[in] trajectory Trajectory run by the control core.
+             * @param[in] budget Maximum number of chunks to apply in this call.
+             * @return Number of chunks applied.
+             */
+            size_t drain(Robotics::Trajectory & trajectory, size_t budget = CORE_LINK_SLOTS);
+
+            /**
+             * @brief Check if chunks are waiting to be drained.
+             */
+            bool isPending() const
+            {
+                return !chunks.isEmpty();
+            }
+
+            /**
+             * @brief Number of times the communication core waited for room in the ring.
+             */
+            uint32_t stalls() const
+            {
+                return stallCount.load(std::memory_order_relaxed);
+            }
+
+        private:
+            void forward(ChunkKind kind, const uint8_t * data, size_t size, size_t recordSize);
+
+            SpscQueue<ProgramChunk, CORE_LINK_SLOTS> chunks;
+            std::atomic<uint32_t> stallCount{0};
+    };
+
+} // namespace Communication
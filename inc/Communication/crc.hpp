@@ -0,0 +1,155 @@
+/***********************************************************************
+ * @file	:	crc.hpp
+ * @brief 	:	Table driven CRC
+ *              Reflected CRC-16 and CRC-32 computed slice-by-N with
+ *              lookup tables generated at compile time.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <array>
+
+namespace Communication {
+
+    /**
+     * @class Crc
+     * @brief Reflected CRC (LSB first, as sent on the wire) processing Slices bytes per step.
+     *
+     * @details
+     * Table k holds the CRC of a byte followed by k zero bytes, so Slices bytes are folded into
+     * the remainder with Slices independent lookups instead of a chain of Slices dependent ones.
+     * The tables take Slices * 256 * sizeof(T) bytes of flash, see tableBytes(); more slices are
+     * faster as long as the tables stay in cache (or in XIP cache on RP2350).
+     *
+     * @tparam T Remainder type, uint16_t or uint32_t.
+     * @tparam Poly Reflected generator polynomial.
+     * @tparam Init Initial remainder.
+     * @tparam XorOut Value xored into the final remainder.
+     * @tparam Slices Bytes processed per step, 1 for the classic byte-wise algorithm.
+     */
+    template <typename T, T Poly, T Init, T XorOut, size_t Slices>
+    class Crc
+    {
+        static_assert(Slices >= 1 && Slices <= 16, "Unsupported number of slices");
+
+        public:
+            using Value = T;
+            static constexpr size_t SIZE = sizeof(T); // Bytes appended to a frame
+
+            /**
+             * @brief Compute the CRC of a buffer.
+             * @param[in] data Data to protect.
+             * @param[in] length Data length.
+             * @return CRC value.
+             */
+            static constexpr T compute(const uint8_t * data, size_t length)
+            {
+                return finalize(update(Init, data, length));
+            }
+
+            /**
+             * @brief Fold more data into a running remainder, starting from initial().
+             * @param[in] crc Running remainder.
+             * @param[in] data Data to fold.
+             * @param[in] length Data length.
+             * @return Updated remainder.
+             */
+            static constexpr T update(T crc, const uint8_t * data, size_t length)
+            {
+                while (length >= Slices)
+                {
+                    T folded = 0;
+                    for (size_t i = 0; i < Slices; i++)
+                    {
+                        uint8_t index = data[i];
+                        if (i < SIZE)
+                        {
+                            index ^= static_cast<uint8_t>(crc >> (8 * i));
+                        }
+                        folded ^= tables[Slices - 1 - i][index];
+                    }
+                    // Remainder bytes that were not folded in this step
+                    if constexpr (Slices < SIZE)
+                    {
+                        folded ^= static_cast<T>(crc >> (8 * Slices));
+                    }
+                    crc = folded;
+                    data += Slices;
+                    length -= Slices;
+                }
+                while (length-- > 0)
+                {
+                    crc = static_cast<T>((crc >> 8) ^ tables[0][static_cast<uint8_t>(crc ^ *data++)]);
+                }
+                return crc;
+            }
+
+            static constexpr T initial() { return Init; }
+            static constexpr T finalize(T crc) { return crc ^ XorOut; }
+
+            /**
+             * @brief CRC of any data followed by its own CRC, least significant byte first.
+             *        A frame is intact if its CRC including the trailing CRC equals this value.
+             */
+            static constexpr T residue()
+            {
+                uint8_t crcBytes[SIZE] = {};
+                T crc = compute(nullptr, 0);
+                for (size_t i = 0; i < SIZE; i++)
+                {
+                    crcBytes[i] = static_cast<uint8_t>(crc >> (8 * i));
+                }
+                return compute(crcBytes, SIZE);
+            }
+
+            static constexpr size_t tableBytes() { return sizeof(tables); }
+
+        private:
+            using Tables = std::array<std::array<T, 256>, Slices>;
+
+            static constexpr Tables makeTables()
+            {
+                Tables result = {};
+                for (size_t byte = 0; byte < 256; byte++)
+                {
+                    T crc = static_cast<T>(byte);
+                    for (int bit = 0; bit < 8; bit++)
+                    {
+                        crc = (crc & 1) ? static_cast<T>((crc >> 1) ^ Poly) : static_cast<T>(crc >> 1);
+                    }
+                    result[0][byte] = crc;
+                }
+                // Table k is table k-1 followed by one zero byte
+                for (size_t k = 1; k < Slices; k++)
+                {
+                    for (size_t byte = 0; byte < 256; byte++)
+                    {
+                        T previous = result[k - 1][byte];
+                        result[k][byte] = static_cast<T>((previous >> 8) ^ result[0][previous & 0xFF]);
+                    }
+                }
+                return result;
+            }
+
+            static constexpr Tables tables = makeTables();
+    };
+
+    constexpr size_t CRC_SLICES = 4; // Slices used by the framing layer, 4 KiB of CRC-32 tables
+
+    /**
+     * @brief CRC-16/X-25 (CCITT polynomial, reflected). Check value 0x906E.
+     */
+    template <size_t Slices = CRC_SLICES>
+    using Crc16 = Crc<uint16_t, 0x8408, 0xFFFF, 0xFFFF, Slices>;
+
+    /**
+     * @brief CRC-32/ISO-HDLC (Ethernet, zlib). Check value 0xCBF43926.
+     *        Also computed by the RP2350 DMA sniffer, see RxDMA::enableSniffer().
+     */
+    template <size_t Slices = CRC_SLICES>
+    using Crc32 = Crc<uint32_t, 0xEDB88320, 0xFFFFFFFF, 0xFFFFFFFF, Slices>;
+
+} // namespace Communication
@@ -0,0 +1,267 @@
+/***********************************************************************
+ * @file	:	frame_pool.hpp
+ * @brief 	:	Received frame pool
+ *              Fixed pool of frame buffers handed over from the receive
+ *              ISR to the application without copying.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include "message_format.hpp"
+
+namespace Communication {
+
+    /**
+     * @brief Frame descriptor. The first byte of data is the message id, the rest is the payload.
+     */
+    struct Frame
+    {
+        uint8_t data[BUFFER_SIZE];
+        size_t length;
+    };
+
+    /**
+     * @class FramePool
+     * @brief Pool of N frame slots cycled between the receive ISR and the application.
+     *
+     * @details
+     * Slots flow free -> filling -> ready -> borrowed -> free. The ISR (or DMA) writes straight
+     * into the slot it acquired and only publishes the slot index once the frame is complete, so
+     * a new frame can be received while previous ones are still being handled. Both handoffs use
+     * SpscQueue, so no critical section is needed as long as a single context receives and a
+     * single context fills.
+     *
+     * With an integrity check set, frames are verified when received, in the receiving context,
+     * and corrupted ones are dropped before reaching the application. The check is stripped from
+     * the length of the frames handed over.
+     *
+     * @tparam N Number of slots, must be a power of 2 and at most 256.
+     */
+    template <size_t N>
+    class FramePool
+    {
+        static_assert(N <= 256, "Slot indices must fit in a byte");
+
+        public:
+            /**
+             * @class View
+             * @brief Borrowed read-only view of a ready frame. The slot is given back to the
+             *        pool when the view is released or destroyed.
+             */
+            class View
+            {
+                public:
+                    View() : pool(nullptr), index(0) {}
+                    ~View() { release(); }
+
+                    View(View && obj) noexcept : pool(obj.pool), index(obj.index)
+                    {
+                        obj.pool = nullptr;
+                    }
+
+                    View & operator=(View && obj) noexcept
+                    {
+                        if (this != &obj)
+                        {
+                            release();
+                            pool = obj.pool;
+                            index = obj.index;
+                            obj.pool = nullptr;
+                        }
+                        return *this;
+                    }
+
+                    // A slot can only be borrowed once
+                    View(const View & obj) = delete;
+                    View & operator=(const View & obj) = delete;
+
+                    bool isValid() const noexcept { return pool != nullptr; }
+                    RxMessageId msgId() const { return frame().data[0]; }
+                    const uint8_t * payload() const { return frame().data + 1; }
+                    size_t payloadLength() const { return frame().length - 1; }
+                    const Frame & frame() const { return pool->frames[index]; }
+
+                    /**
+                     * @brief Give the slot back to the pool.
+                     */
+                    void release()
+                    {
+                        if (pool != nullptr)
+                        {
+                            pool->freeSlots.push(index);
+                            pool = nullptr;
+                        }
+                    }
+
+                private:
+                    friend class FramePool;
+                    View(FramePool * owner, uint8_t slot) : pool(owner), index(slot) {}
+                    FramePool * pool;
+                    uint8_t index;
+            };
+
+            FramePool() : filling(NONE), integrity(Integrity::None), dropped(0), corrupted(0)
+            {
+                for (size_t i = 0; i < N; i++)
+                {
+                    freeSlots.push(static_cast<uint8_t>(i));
+                }
+            }
+
+            FramePool(const FramePool & obj) = delete;
+            FramePool & operator=(const FramePool & obj) = delete;
+
+            /**
+             * @brief Get a slot to write the next frame into. To be called from the filling context.
+             *        A slot acquired but never published is reused by the next call.
+             * @return Pointer to an empty frame, nullptr if every slot is in use.
+             */
+            Frame * acquire()
+            {
+                if (filling == NONE)
+                {
+                    uint8_t index;
+                    if (!freeSlots.pop(index))
+                    {
+                        dropped.fetch_add(1, std::memory_order_relaxed);
+                        return nullptr;
+                    }
+                    filling = index;
+                }
+                frames[filling].length = 0;
+                return &frames[filling];
+            }
+
+            /**
+             * @brief Hand the acquired slot over to the receiving context. Empty frames are not published.
+             * @return True if a frame was published.
+             */
+            bool publish()
+            {
+                if (filling == NONE || frames[filling].length == 0)
+                {
+                    return false;
+                }
+                // Cannot fail, there are only N indices in circulation
+                readySlots.push(filling);
+                filling = NONE;
+                return true;
+            }
+
+            /**
+             * @brief Drop the frame being filled as corrupted, e.g. when it was already verified
+             *        while being received. Its slot is reused by the next acquire().
+             */
+            void reject()
+            {
+                if (filling != NONE)
+                {
+                    frames[filling].length = 0;
+                    corrupted.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+
+            /**
+             * @brief Borrow the oldest ready frame. To be called from the receiving context.
+             * @param[out] view View of the frame, valid until released.
+             * @return False if no intact frame is ready.
+             */
+            bool receive(View & view)
+            {
+                uint8_t index;
+                while (readySlots.pop(index))
+                {
+                    Frame & frame = frames[index];
+                    size_t length = verifyIntegrity(integrity, frame.data, frame.length);
+                    if (length > 0)
+                    {
+                        frame.length = length;
+                        view = View(this, index);
+                        return true;
+                    }
+                    // Drop the corrupted frame, it never reaches the application
+                    corrupted.fetch_add(1, std::memory_order_relaxed);
+                    freeSlots.push(index);
+                }
+                return false;
+            }
+
+            /**
+             * @brief Set the integrity check that received frames carry. To be called before
+             *        frames are received.
+             */
+            void setIntegrity(Integrity check)
+            {
+                integrity = check;
+            }
+
+            /**
+             * @brief Call a handler for each ready frame, oldest first. To be called from the
+             *        receiving context.
+             * @param[in] handler Handler to call with the message id and payload.
+             * @param[in] budget Maximum number of frames to handle in this call.
+             * @return Number of frames handled.
+             */
+            size_t dispatch(RxHandler handler, size_t budget)
+            {
+                size_t handled = 0;
+                View view;
+                while (handled < budget && receive(view))
+                {
+                    handler(view.msgId(), view.payloadLength(), view.payload());
+                    view.release();
+                    handled++;
+                }
+                return handled;
+            }
+
+            /**
+             * @brief Number of frames waiting to be received.
+             */
+            size_t pending() const
+            {
+                return readySlots.size();
+            }
+
+            /**
+             * @brief Number of frames dropped because no slot was free.
+             */
+            uint32_t droppedFrames() const
+            {
+                return dropped.load(std::memory_order_relaxed);
+            }
+
+            /**
+             * @brief Number of frames dropped because of a failed integrity check.
+             */
+            uint32_t corruptedFrames() const
+            {
+                return corrupted.load(std::memory_order_relaxed);
+            }
+
+            static constexpr size_t slots()
+            {
+                return N;
+            }
+
+        private:
+            static constexpr uint16_t NONE = 0xFFFF;
+            Frame frames[N];
+            SpscQueue<uint8_t, N> freeSlots;    // filled by the receiver, drained by the filler
+            SpscQueue<uint8_t, N> readySlots;   // filled by the filler, drained by the receiver
+            uint16_t filling;
+            Integrity integrity;
+            std::atomic<uint32_t> dropped;
+            std::atomic<uint32_t> corrupted;
+    };
+
+    constexpr size_t RX_FRAME_SLOTS = 4;                        // Frames that can be buffered before dropping
+    constexpr size_t DEFAULT_DISPATCH_BUDGET = RX_FRAME_SLOTS;  // Frames handled per pump() call
+
+    using RxFrames = FramePool<RX_FRAME_SLOTS>;
+
+} // namespace Communication
@@ -0,0 +1,234 @@
+/***********************************************************************
+ * @file	:	frame_trace.hpp
+ * @brief 	:	Frame trace
+ *              Compact binary trace of timestamped received frames,
+ *              recorded on target and replayed on the host.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include "message_format.hpp"
+
+namespace Communication {
+
+    /**
+     * Trace: [TRACE_MAGIC][TRACE_VERSION] followed by records
+     * Record: [time since the previous record in us, LEB128][length][msg id][payload...]
+     * The first record's time is counted from 0, length counts the message id and the payload,
+     * from 1 to BUFFER_SIZE. Timestamps wrap at 2^32 us, as time_us_32() does.
+     */
+    constexpr uint8_t TRACE_MAGIC[] = {'R', 'A', 'T', 'R'};
+    constexpr uint8_t TRACE_VERSION = 1;
+    constexpr size_t TRACE_HEADER_SIZE = sizeof(TRACE_MAGIC) + 1;
+    constexpr size_t TRACE_MAX_VARINT = 5;      // A 32 bit delta in 7 bit groups
+    constexpr size_t TRACE_MAX_RECORD = TRACE_MAX_VARINT + 1 + BUFFER_SIZE;
+
+    /**
+     * @brief Function pointer signature called with full blocks of trace bytes.
+     */
+    typedef void (*TraceSink)(const uint8_t * data, size_t length);
+
+    /**
+     * @class TraceRecorder
+     * @brief Records received frames into a buffer, handed to a sink when full or flushed.
+     *
+     * @details
+     * Records are appended from the dispatch context. Without a sink, recording stops when the
+     * buffer is full and the trace can be read from buffer() afterwards. The trace header is
+     * written ahead of the first record.
+     */
+    class TraceRecorder
+    {
+        public:
+            /**
+             * @brief Constructor.
+             * @param[in] buffer Buffer of at least TRACE_HEADER_SIZE + TRACE_MAX_RECORD bytes.
+             * @param[in] capacity Buffer size.
+             * @param[in] sink Called with the buffered bytes when the buffer is full, or nullptr.
+             */
+            TraceRecorder(uint8_t * buffer, size_t capacity, TraceSink sink = nullptr)
+                : data(buffer), capacity(capacity), sink(sink), length(0), lastUs(0), dropped(0), started(false) {}
+
+            /**
+             * @brief Append a frame.
+             * @param[in] timeUs Reception time in microseconds.
+             * @param[in] msgId Message id.
+             * @param[in] payload Payload.
+             * @param[in] payloadLength Payload length.
+             * @return False if the frame was not recorded, see droppedRecords().
+             */
+            bool record(uint32_t timeUs, RxMessageId msgId, const uint8_t * payload, size_t payloadLength)
+            {
+                if (payloadLength >= BUFFER_SIZE || (payload == nullptr && payloadLength > 0))
+                {
+                    dropped++;
+                    return false;
+                }
+                if (!started)
+                {
+                    if (capacity - length < TRACE_HEADER_SIZE)
+                    {
+                        dropped++;
+                        return false;
+                    }
+                    memcpy(data + length, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+                    data[length + sizeof(TRACE_MAGIC)] = TRACE_VERSION;
+                    length += TRACE_HEADER_SIZE;
+                    lastUs = timeUs;
+                    started = true;
+                }
+                if (capacity - length < TRACE_MAX_RECORD)
+                {
+                    flush();
+                    if (capacity - length < TRACE_MAX_RECORD)
+                    {
+                        dropped++;
+                        return false;
+                    }
+                }
+                // Deltas keep the record small and wrap with the timer
+                uint32_t delta = timeUs - lastUs;
+                lastUs = timeUs;
+                do
+                {
+                    uint8_t group = delta & 0x7F;
+                    delta >>= 7;
+                    data[length++] = group | ((delta != 0) ? 0x80 : 0x00);
+                } while (delta != 0);
+                data[length++] = static_cast<uint8_t>(payloadLength + 1);
+                data[length++] = msgId;
+                if (payloadLength > 0)
+                {
+                    memcpy(data + length, payload, payloadLength);
+                    length += payloadLength;
+                }
+                return true;
+            }
+
+            /**
+             * @brief Hand the buffered bytes to the sink, if any.
+             */
+            void flush()
+            {
+                if (sink != nullptr && length > 0)
+                {
+                    sink(data, length);
+                    length = 0;
+                }
+            }
+
+            /**
+             * @brief Trace bytes buffered so far.
+             */
+            const uint8_t * buffer() const
+            {
+                return data;
+            }
+
+            size_t size() const
+            {
+                return length;
+            }
+
+            /**
+             * @brief Number of frames not recorded for lack of space or being too long.
+             */
+            uint32_t droppedRecords() const
+            {
+                return dropped;
+            }
+
+        private:
+            uint8_t * data;
+            size_t capacity;
+            TraceSink sink;
+            size_t length;
+            uint32_t lastUs;
+            uint32_t dropped;
+            bool started;
+    };
+
+    /**
+     * @brief Frame read from a trace.
+     */
+    struct TraceRecord
+    {
+        uint64_t timeUs;        // Since the first record, unwrapped
+        const uint8_t * frame;  // Message id followed by the payload
+        size_t length;
+    };
+
+    /**
+     * @class TraceReader
+     * @brief Walks the records of a trace held in memory.
+     */
+    class TraceReader
+    {
+        public:
+            TraceReader(const uint8_t * trace, size_t length) : data(trace), length(length), offset(0), timeUs(0)
+            {
+                valid = length >= TRACE_HEADER_SIZE && memcmp(trace, TRACE_MAGIC, sizeof(TRACE_MAGIC)) == 0 &&
+                        trace[sizeof(TRACE_MAGIC)] == TRACE_VERSION;
+                offset = valid ? TRACE_HEADER_SIZE : length;
+            }
+
+            /**
+             * @brief Check the trace header.
+             */
+            bool isValid() const
+            {
+                return valid;
+            }
+
+            /**
+             * @brief Read the next record.
+             * @param[out] record Record, pointing into the trace.
+             * @return False at the end of the trace or on a truncated record.
+             */
+            bool next(TraceRecord & record)
+            {
+                uint32_t delta = 0;
+                size_t shift = 0;
+                while (true)
+                {
+                    if (offset >= length || shift >= 7 * TRACE_MAX_VARINT)
+                    {
+                        return false;
+                    }
+                    uint8_t group = data[offset++];
+                    delta |= static_cast<uint32_t>(group & 0x7F) << shift;
+                    shift += 7;
+                    if ((group & 0x80) == 0)
+                    {
+                        break;
+                    }
+                }
+                if (offset >= length)
+                {
+                    return false;
+                }
+                size_t frameLength = data[offset++];
+                if (frameLength == 0 || frameLength > BUFFER_SIZE || length - offset < frameLength)
+                {
+                    offset = length;
+                    return false;
+                }
+                timeUs += delta;
+                record = {timeUs, data + offset, frameLength};
+                offset += frameLength;
+                return true;
+            }
+
+        private:
+            const uint8_t * data;
+            size_t length;
+            size_t offset;
+            uint64_t timeUs;
+            bool valid;
+    };
+
+} // namespace Communication
@@ -0,0 +1,107 @@
+/***********************************************************************
+ * @file	:	loopback_transport.hpp
+ * @brief 	:	Loopback transport
+ *              In-process transport where the master is a function
+ *              call, to run the services on a host.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include "transport.hpp"
+
+namespace Communication {
+
+    constexpr size_t LOOPBACK_RESPONSE_SLOTS = 4; // Responses queued before publishResponse() fails
+
+    /**
+     * @class LoopbackTransport
+     * @brief Transport whose master side is driven in-process with masterWrite() and masterRead().
+     *
+     * @details
+     * masterWrite() plays the role of the receive ISR and the service side may run on another
+     * thread, the same single filler / single receiver rules as on hardware apply. Unlike I2C,
+     * responses are queued instead of replaced, so that none is lost when the master lags behind.
+     */
+    class LoopbackTransport : public PooledTransport
+    {
+        public:
+            /**
+             * @brief Send a frame to the services. To be called from the master context.
+             * @param[in] frame Message id followed by the payload (and integrity check, if any).
+             * @param[in] length Frame length, at most BUFFER_SIZE.
+             * @return False if the frame is empty, too long or every slot is in use.
+             */
+            bool masterWrite(const uint8_t * frame, size_t length)
+            {
+                if (length == 0 || length > BUFFER_SIZE)
+                {
+                    return false;
+                }
+                Frame * slot = rxFrames.acquire();
+                if (slot == nullptr)
+                {
+                    return false;
+                }
+                memcpy(slot->data, frame, length);
+                slot->length = length;
+                return frameReceived();
+            }
+
+            /**
+             * @brief Read the oldest published response. To be called from the master context.
+             *        Bytes past the response, or without a response, come from the txHandler.
+             * @param[out] buffer Buffer of at least length bytes.
+             * @param[in] length Number of bytes to read.
+             * @return Length of the response read, without the bytes from the txHandler.
+             */
+            size_t masterRead(uint8_t * buffer, size_t length)
+            {
+                size_t responseLength = 0;
+                Frame * response = responses.front();
+                if (response != nullptr)
+                {
+                    responseLength = (response->length < length) ? response->length : length;
+                    memcpy(buffer, response->data, responseLength);
+                    Frame discarded;
+                    responses.pop(discarded);
+                }
+                for (size_t i = responseLength; i < length; i++)
+                {
+                    buffer[i] = 0;
+                    if (txHandler != nullptr)
+                    {
+                        txHandler(&buffer[i]);
+                    }
+                }
+                return responseLength;
+            }
+
+            bool publishResponse(const uint8_t * data, size_t length) override
+            {
+                if (length == 0 || length > BUFFER_SIZE)
+                {
+                    return false;
+                }
+                Frame response;
+                memcpy(response.data, data, length);
+                response.length = length;
+                return responses.push(response);
+            }
+
+            /**
+             * @brief Number of responses not yet read by the master.
+             */
+            size_t pendingResponses() const
+            {
+                return responses.size();
+            }
+
+        private:
+            SpscQueue<Frame, LOOPBACK_RESPONSE_SLOTS> responses;
+    };
+
+} // namespace Communication
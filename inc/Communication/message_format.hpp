@@ -9,6 +9,8 @@
 #pragma once
 #include <cstdint>
 #include <cstring>
+#include <atomic>
+#include "crc.hpp"
 
 namespace Communication {
 
@@ -18,10 +20,10 @@ namespace Communication {
     typedef uint8_t RxMessageId;
 
     /**
-     * @brief Function pointer signature that is called by the system when a received message
-     *        interruption occurs.
+     * @brief Function pointer signature that is called by the system when a message is received.
+     *        dataLength is the length of the payload that follows the message id.
      */
-    typedef void (*RxHandler)(RxMessageId msgId, size_t dataLength, uint8_t * data);
+    typedef void (*RxHandler)(RxMessageId msgId, size_t dataLength, const uint8_t * data);
 
     /**
      * @brief Function pointer signature that is called by the system when a message request
@@ -29,8 +31,23 @@ namespace Communication {
      */
     typedef void (*TxHandler)(uint8_t * data);
 
+    /**
+     * @brief Function pointer signature that is called from the receive interrupt as soon as a
+     *        message id is recognised, ahead of the frame being complete or dispatched.
+     */
+    typedef void (*UrgentHandler)();
+
     constexpr size_t BUFFER_SIZE = 32; // Maximum message length in bytes
 
+    /**
+     * @brief Context in which received messages are handed to the RxHandler.
+     */
+    enum class DispatchMode
+    {
+        Immediate,  // From the receive ISR, as soon as the frame is complete
+        Deferred    // From the application, each time pump() is called
+    };
+
     /**
      * @brief Circular buffer data structure to store received messages through ISR. Not thread safe.
      * @tparam T Data type to store in the buffer
@@ -96,4 +113,189 @@ namespace Communication {
         }
     };
 
+    /**
+     * @brief Lock-free single-producer/single-consumer circular buffer. One context (e.g. an ISR)
+     *        may push while another (e.g. the main loop) pops, without critical sections.
+     * 
+     * Indices are free-running and wrapped with a mask, so every slot is usable and no modulo
+     * is needed. The producer only writes writeNode and the consumer only writes readNode.
+     * 
+     * @tparam T Data type to store in the buffer
+     * @tparam Capacity Number of elements, must be a power of 2
+     */
+    template <typename T, size_t Capacity = BUFFER_SIZE>
+    class SpscQueue
+    {
+        static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of 2");
+
+        public:
+            SpscQueue() : readNode(0), writeNode(0) {}
+
+            // Shared indices shouldn't be copied
+            SpscQueue(const SpscQueue & obj) = delete;
+            SpscQueue & operator=(const SpscQueue & obj) = delete;
+
+            /**
+             * @brief Push an element. To be called from the producer context only.
+             * @param[in] data Element to push.
+             * @return False if the buffer is full.
+             */
+            inline bool push(const T & data)
+            {
+                const size_t write = writeNode.load(std::memory_order_relaxed);
+                if (write - readNode.load(std::memory_order_acquire) == Capacity) {
+                    return false; // Buffer is full
+                }
+                data_[write & MASK] = data;
+                writeNode.store(write + 1, std::memory_order_release);
+                return true;
+            }
+
+            /**
+             * @brief Pop an element. To be called from the consumer context only.
+             * @param[out] data Popped element.
+             * @return False if the buffer is empty.
+             */
+            inline bool pop(T & data)
+            {
+                const size_t read = readNode.load(std::memory_order_relaxed);
+                if (read == writeNode.load(std::memory_order_acquire)) {
+                    return false; // Buffer is empty
+                }
+                data = data_[read & MASK];
+                readNode.store(read + 1, std::memory_order_release);
+                return true;
+            }
+
+            /**
+             * @brief Peek the oldest element. To be called from the consumer context only.
+             * @return Pointer to the oldest element, nullptr if the buffer is empty.
+             */
+            inline T * front()
+            {
+                const size_t read = readNode.load(std::memory_order_relaxed);
+                if (read == writeNode.load(std::memory_order_acquire)) {
+                    return nullptr;
+                }
+                return & data_[read & MASK];
+            }
+
+            /**
+             * @brief Discard all elements. To be called from the consumer context only.
+             */
+            inline void clear()
+            {
+                readNode.store(writeNode.load(std::memory_order_acquire), std::memory_order_release);
+            }
+
+            inline bool isEmpty() const
+            {
+                return size() == 0;
+            }
+
+            inline bool isFull() const
+            {
+                return size() == Capacity;
+            }
+
+            inline size_t size() const
+            {
+                // Load readNode first so that it can never overtake the loaded writeNode
+                const size_t read = readNode.load(std::memory_order_acquire);
+                return writeNode.load(std::memory_order_acquire) - read;
+            }
+
+            static constexpr size_t capacity()
+            {
+                return Capacity;
+            }
+
+        private:
+            static constexpr size_t MASK = Capacity - 1;
+            T data_[Capacity];
+            std::atomic<size_t> readNode;
+            std::atomic<size_t> writeNode;
+    };
+
+    /**
+     * @brief Integrity check appended to frames: [msg id][payload][CRC, least significant byte first].
+     *        The CRC covers the message id and the payload.
+     */
+    enum class Integrity : uint8_t
+    {
+        None,
+        Crc16,
+        Crc32
+    };
+
+    /**
+     * @brief Number of bytes the integrity check adds to a frame.
+     */
+    constexpr size_t integritySize(Integrity integrity)
+    {
+        switch (integrity)
+        {
+            case Integrity::Crc16: return Crc16<>::SIZE;
+            case Integrity::Crc32: return Crc32<>::SIZE;
+            default: return 0;
+        }
+    }
+
+    /**
+     * @brief Append the integrity check to a frame.
+     * @param[in] integrity Integrity check to append.
+     * @param[in,out] frame Frame buffer of BUFFER_SIZE bytes.
+     * @param[in] length Frame length without the check.
+     * @return Frame length with the check, 0 if it doesn't fit in BUFFER_SIZE.
+     */
+    inline size_t appendIntegrity(Integrity integrity, uint8_t * frame, size_t length)
+    {
+        size_t size = integritySize(integrity);
+        if (length + size > BUFFER_SIZE)
+        {
+            return 0;
+        }
+        if (size == 0)
+        {
+            return length;
+        }
+        uint32_t crc = (integrity == Integrity::Crc16) ? Crc16<>::compute(frame, length)
+                                                       : Crc32<>::compute(frame, length);
+        for (size_t i = 0; i < size; i++)
+        {
+            frame[length + i] = static_cast<uint8_t>(crc >> (8 * i));
+        }
+        return length + size;
+    }
+
+    /**
+     * @brief Verify the integrity check of a received frame.
+     * @param[in] integrity Integrity check the frame carries.
+     * @param[in] frame Received frame.
+     * @param[in] length Frame length with the check.
+     * @return Frame length without the check, 0 if the frame is corrupted or too short.
+     */
+    inline size_t verifyIntegrity(Integrity integrity, const uint8_t * frame, size_t length)
+    {
+        size_t size = integritySize(integrity);
+        if (size == 0)
+        {
+            return length;
+        }
+        // At least the message id must be protected
+        if (length <= size)
+        {
+            return 0;
+        }
+        size_t dataLength = length - size;
+        uint32_t expected = 0;
+        for (size_t i = 0; i < size; i++)
+        {
+            expected |= static_cast<uint32_t>(frame[dataLength + i]) << (8 * i);
+        }
+        uint32_t crc = (integrity == Integrity::Crc16) ? Crc16<>::compute(frame, dataLength)
+                                                       : Crc32<>::compute(frame, dataLength);
+        return (crc == expected) ? dataLength : 0;
+    }
+
 } // namespace Communication
@@ -0,0 +1,142 @@
+/***********************************************************************
+ * @file	:	response_buffer.hpp
+ * @brief 	:	Response buffer
+ *              Double buffered response handed over from the
+ *              application to the transmit ISR or DMA.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include "message_format.hpp"
+
+namespace Communication {
+
+    /**
+     * @class ResponseBuffer
+     * @brief Latest-wins response shared by one publishing context and one sending context.
+     *
+     * @details
+     * One slot may be sent (e.g. by DMA) while the other is being written. Both slot indices are
+     * packed in a single atomic byte, published slot in the low nibble and sent slot in the high
+     * nibble, so no critical section is needed. A response not yet taken is replaced. A response
+     * sent can be published again by finish(), for masters polling the same response.
+     *
+     * @tparam T Element type sent, wide enough for the data register the response is written to.
+     */
+    template <typename T>
+    class ResponseBuffer
+    {
+        public:
+            ResponseBuffer() : slots(packSlots(NO_SLOT, NO_SLOT)) {}
+
+            ResponseBuffer(const ResponseBuffer & obj) = delete;
+            ResponseBuffer & operator=(const ResponseBuffer & obj) = delete;
+
+            /**
+             * @brief Publish a response. To be called from the publishing context.
+             * @param[in] data Response bytes, copied.
+             * @param[in] length Response length.
+             * @return False if the response is empty or longer than BUFFER_SIZE.
+             */
+            bool publish(const uint8_t * data, size_t length)
+            {
+                if (length == 0 || length > BUFFER_SIZE)
+                {
+                    return false;
+                }
+                // Withdraw the pending response so that it cannot be taken while written
+                uint8_t current = slots.load(std::memory_order_acquire);
+                while (!slots.compare_exchange_weak(current, packSlots(NO_SLOT, sendingSlot(current)),
+                                                    std::memory_order_acq_rel)) {}
+                // Write into the slot that is not being sent
+                uint8_t slot = (sendingSlot(current) == 0) ? 1 : 0;
+                for (size_t i = 0; i < length; i++)
+                {
+                    buffers[slot][i] = data[i];
+                }
+                lengths[slot] = length;
+                current = slots.load(std::memory_order_acquire);
+                while (!slots.compare_exchange_weak(current, packSlots(slot, sendingSlot(current)),
+                                                    std::memory_order_acq_rel)) {}
+                return true;
+            }
+
+            /**
+             * @brief Withdraw the published response, if any. To be called from the publishing context.
+             */
+            void withdraw()
+            {
+                uint8_t current = slots.load(std::memory_order_acquire);
+                while (!slots.compare_exchange_weak(current, packSlots(NO_SLOT, sendingSlot(current)),
+                                                    std::memory_order_acq_rel)) {}
+            }
+
+            /**
+             * @brief Take the published response to send it. To be called from the sending context.
+             * @param[out] length Response length.
+             * @return Response elements, untouched until finish(), nullptr if none was published.
+             */
+            const T * take(size_t & length)
+            {
+                uint8_t current = slots.load(std::memory_order_acquire);
+                uint8_t slot;
+                do {
+                    slot = publishedSlot(current);
+                    if (slot == NO_SLOT)
+                    {
+                        return nullptr;
+                    }
+                } while (!slots.compare_exchange_weak(current, packSlots(NO_SLOT, slot), std::memory_order_acq_rel));
+                length = lengths[slot];
+                return buffers[slot];
+            }
+
+            /**
+             * @brief Give back the response being sent. To be called from the sending context.
+             * @param[in] rearm Publish the response sent again, unless a newer one was published.
+             * @return True if a response was being sent.
+             */
+            bool finish(bool rearm = false)
+            {
+                uint8_t current = slots.load(std::memory_order_acquire);
+                uint8_t sending = sendingSlot(current);
+                if (sending == NO_SLOT)
+                {
+                    return false;
+                }
+                uint8_t published;
+                do {
+                    published = publishedSlot(current);
+                    if (rearm && published == NO_SLOT)
+                    {
+                        published = sending;
+                    }
+                } while (!slots.compare_exchange_weak(current, packSlots(published, NO_SLOT), std::memory_order_acq_rel));
+                return true;
+            }
+
+            bool isSending() const
+            {
+                return sendingSlot(slots.load(std::memory_order_acquire)) != NO_SLOT;
+            }
+
+        private:
+            static constexpr uint8_t NO_SLOT = 0xF;
+
+            static constexpr uint8_t packSlots(uint8_t published, uint8_t sending)
+            {
+                return static_cast<uint8_t>((sending << 4) | published);
+            }
+            static constexpr uint8_t publishedSlot(uint8_t packed) { return packed & 0xF; }
+            static constexpr uint8_t sendingSlot(uint8_t packed) { return packed >> 4; }
+
+            T buffers[2][BUFFER_SIZE];
+            size_t lengths[2];
+            std::atomic<uint8_t> slots;
+    };
+
+} // namespace Communication
@@ -0,0 +1,162 @@
+/***********************************************************************
+ * @file	:	segmented_transfer.hpp
+ * @brief 	:	Segmented transfer protocol
+ *              ISO-TP like segmentation of long messages over frames
+ *              of BUFFER_SIZE bytes.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include "message_format.hpp"
+
+namespace Communication {
+
+    /**
+     * @brief Frame type, high nibble of the protocol control information (PCI) byte.
+     *
+     * First frame:       [0x10][total length, 4 bytes big endian][data...]
+     * Consecutive frame: [0x2N][data...] with N the sequence number, starting at 1 and wrapping at 15
+     * Flow control:      [0x3S][block size][separation time] with S the FlowStatus
+     */
+    enum class SegmentType : uint8_t
+    {
+        First = 0x1,
+        Consecutive = 0x2,
+        FlowControl = 0x3
+    };
+
+    /**
+     * @brief Flow status reported by the receiver in flow control frames.
+     */
+    enum class FlowStatus : uint8_t
+    {
+        ContinueToSend = 0x0,
+        Wait = 0x1,
+        Overflow = 0x2      // Transfer aborted, restart with a first frame
+    };
+
+    /**
+     * @brief State of the segmented transfer being received.
+     */
+    enum class TransferStatus : uint8_t
+    {
+        Idle,
+        InProgress,
+        Complete,
+        WrongSequence,  // A consecutive frame is missing
+        Overflow,       // Announced or received length not accepted
+        Malformed       // Frame too short or of unknown type
+    };
+
+    constexpr size_t FIRST_FRAME_HEADER = 5;        // PCI + total length
+    constexpr size_t CONSECUTIVE_FRAME_HEADER = 1;  // PCI
+    constexpr size_t FLOW_CONTROL_SIZE = 3;         // PCI + block size + separation time
+    constexpr size_t MAX_RECORD_SIZE = BUFFER_SIZE; // Largest record the receiver can reassemble
+
+    /**
+     * @brief Function pointer signature called with reassembled data, always a whole number of records.
+     */
+    typedef void (*SegmentSink)(const uint8_t * data, size_t length);
+
+    /**
+     * @class SegmentedReceiver
+     * @brief Reassembles a segmented message frame by frame and streams it to a sink.
+     *
+     * @details
+     * Data is forwarded as soon as whole records are available, so no buffer for the whole message
+     * is needed, only a carry of one record for records split across frames. A repeated consecutive
+     * frame is ignored and counted, a missing one aborts the transfer.
+     */
+    class SegmentedReceiver
+    {
+        public:
+            /**
+             * @brief Constructor.
+             * @param[in] sink Function called with reassembled records.
+             * @param[in] recordSize Size of the records the message is made of.
+             * @param[in] blockSize Consecutive frames the sender may send between flow control frames, 0 for no limit.
+             * @param[in] separationTime Minimum time between consecutive frames, in ISO-TP STmin encoding.
+             * @param[in] maxLength Maximum accepted message length in bytes.
+             */
+            SegmentedReceiver(SegmentSink sink, size_t recordSize, uint8_t blockSize, uint8_t separationTime, uint32_t maxLength);
+
+            /**
+             * @brief Process a received frame.
+             * @param[in] payload Frame payload, starting with the PCI byte.
+             * @param[in] length Payload length.
+             * @return Transfer status after processing the frame.
+             */
+            TransferStatus receive(const uint8_t * payload, size_t length);
+
+            /**
+             * @brief Build the flow control frame for the sender.
+             * @param[out] frame Buffer of at least FLOW_CONTROL_SIZE bytes.
+             * @return Length of the flow control frame.
+             */
+            size_t flowControl(uint8_t * frame) const;
+
+            /**
+             * @brief Abort any transfer in progress and return to idle.
+             */
+            void reset();
+
+            TransferStatus getStatus() const noexcept { return status; }
+            uint32_t getReceivedLength() const noexcept { return received; }
+            uint32_t getTotalLength() const noexcept { return total; }
+            uint32_t getDuplicates() const noexcept { return duplicates; }
+
+        private:
+            void consume(const uint8_t * data, size_t length);
+
+            SegmentSink sink;
+            size_t recordSize;
+            uint8_t blockSize;
+            uint8_t separationTime;
+            uint32_t maxLength;
+
+            TransferStatus status;
+            uint32_t total;
+            uint32_t received;
+            uint32_t duplicates;
+            uint8_t expectedSequence;
+            uint8_t carry[MAX_RECORD_SIZE];
+            size_t carryLength;
+    };
+
+    /**
+     * @class SegmentedSender
+     * @brief Splits a message into a first frame and consecutive frames. Used by masters and host tools.
+     */
+    class SegmentedSender
+    {
+        public:
+            /**
+             * @brief Constructor.
+             * @param[in] msgId Message id prepended to every frame.
+             * @param[in] data Message to send, must outlive the sender.
+             * @param[in] length Message length.
+             */
+            SegmentedSender(RxMessageId msgId, const uint8_t * data, uint32_t length);
+
+            /**
+             * @brief Build the next frame, including the message id.
+             * @param[out] frame Buffer of BUFFER_SIZE bytes.
+             * @return Frame length, 0 once the whole message was sent.
+             */
+            size_t nextFrame(uint8_t * frame);
+
+            bool isComplete() const noexcept { return sent == length && started; }
+
+        private:
+            RxMessageId msgId;
+            const uint8_t * data;
+            uint32_t length;
+            uint32_t sent;
+            uint8_t sequence;
+            bool started;
+    };
+
+} // namespace Communication
@@ -0,0 +1,128 @@
+/***********************************************************************
+ * @file	:	stream_framing.hpp
+ * @brief 	:	Stream framing
+ *              Delimitation of frames over byte streams without start
+ *              and stop conditions (UART, pty).
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include "frame_pool.hpp"
+
+namespace Communication {
+
+    /**
+     * Stream frame: [STREAM_SYNC][length][msg id][payload...], length counts the message id
+     * and the payload (and the integrity check, if any), from 1 to BUFFER_SIZE.
+     */
+    constexpr uint8_t STREAM_SYNC = 0x7E;
+    constexpr size_t STREAM_HEADER = 2;
+    constexpr size_t STREAM_FRAME_SIZE = STREAM_HEADER + BUFFER_SIZE;
+
+    /**
+     * @brief Wrap a frame to be sent over a stream.
+     * @param[in] frame Frame to send.
+     * @param[in] length Frame length.
+     * @param[out] out Buffer of at least STREAM_FRAME_SIZE bytes.
+     * @return Stream frame length, 0 if the frame is empty or longer than BUFFER_SIZE.
+     */
+    inline size_t encodeStreamFrame(const uint8_t * frame, size_t length, uint8_t * out)
+    {
+        if (length == 0 || length > BUFFER_SIZE)
+        {
+            return 0;
+        }
+        out[0] = STREAM_SYNC;
+        out[1] = static_cast<uint8_t>(length);
+        memcpy(out + STREAM_HEADER, frame, length);
+        return STREAM_HEADER + length;
+    }
+
+    /**
+     * @class StreamDecoder
+     * @brief Cuts a received byte stream into frames, written straight into a frame pool.
+     *
+     * @details
+     * Bytes are skipped until a sync byte followed by a valid length. Frames are not escaped, so
+     * after line noise the decoder may lock on a sync value inside a payload; an integrity check
+     * is recommended on noisy links so that such frames are dropped.
+     */
+    class StreamDecoder
+    {
+        public:
+            explicit StreamDecoder(RxFrames & pool) : pool(pool), state(State::Sync), expected(0), frame(nullptr) {}
+
+            /**
+             * @brief Process a received byte. To be called from the filling context of the pool.
+             * @return True if the byte completed a frame, which is ready to be published.
+             */
+            bool feed(uint8_t byte)
+            {
+                switch (state)
+                {
+                    case State::Sync:
+                        if (byte == STREAM_SYNC)
+                        {
+                            state = State::Length;
+                        }
+                        return false;
+                    case State::Length:
+                        if (byte == 0 || byte > BUFFER_SIZE)
+                        {
+                            state = (byte == STREAM_SYNC) ? State::Length : State::Sync;
+                            return false;
+                        }
+                        expected = byte;
+                        // Without a free slot the frame is skipped, but still delimited
+                        frame = pool.acquire();
+                        state = State::Data;
+                        return false;
+                    case State::Data:
+                        if (frame != nullptr)
+                        {
+                            frame->data[frame->length++] = byte;
+                        }
+                        if (--expected == 0)
+                        {
+                            bool complete = (frame != nullptr);
+                            frame = nullptr;
+                            state = State::Sync;
+                            return complete;
+                        }
+                        return false;
+                }
+                return false;
+            }
+
+            /**
+             * @brief Drop any partially received frame and wait for the next sync byte.
+             */
+            void reset()
+            {
+                if (frame != nullptr)
+                {
+                    frame->length = 0;
+                    frame = nullptr;
+                }
+                state = State::Sync;
+            }
+
+        private:
+            enum class State : uint8_t
+            {
+                Sync,
+                Length,
+                Data
+            };
+
+            RxFrames & pool;
+            State state;
+            size_t expected;
+            Frame * frame;
+    };
+
+} // namespace Communication
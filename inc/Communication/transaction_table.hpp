@@ -0,0 +1,171 @@
+/***********************************************************************
+ * @file	:	transaction_table.hpp
+ * @brief 	:	Transaction table
+ *              Outstanding requests tagged with a transaction id and
+ *              their UDS style positive or negative responses.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include "message_format.hpp"
+
+namespace Communication {
+
+    constexpr uint8_t TRANSACTION_FLAG = 0x80;         // Message id bit marking a request with a transaction id
+    constexpr uint8_t POSITIVE_RESPONSE_OFFSET = 0x40; // Positive response id is the message id plus this offset
+    constexpr uint8_t NEGATIVE_RESPONSE_ID = 0x7F;
+    constexpr size_t POSITIVE_RESPONSE_SIZE = 2;       // [id + 0x40][transaction id]
+    constexpr size_t NEGATIVE_RESPONSE_SIZE = 4;       // [0x7F][id][transaction id][response code]
+
+    /**
+     * @brief Outcome of a request, negative response codes as defined by UDS.
+     */
+    enum class ResponseCode : uint8_t
+    {
+        Positive = 0x00,
+        GeneralReject = 0x10,
+        ServiceNotSupported = 0x11,
+        IncorrectMessageLength = 0x13,
+        ConditionsNotCorrect = 0x22,
+        RequestSequenceError = 0x24,
+        RequestOutOfRange = 0x31,
+        Pending = 0x78              // Received, the response follows once the request completes
+    };
+
+    /**
+     * @class TransactionTable
+     * @brief Last N requests carrying a transaction id, in completion order.
+     *
+     * @details
+     * A master can send several requests without reading in between, each tagged with its own
+     * transaction id, then read all their responses at once with serialize(). Pending requests
+     * are reported with the Pending code and move behind the others once resolved. Responses
+     * are kept until evicted by newer requests, oldest first, so a lost read can be repeated.
+     * To be used from a single context.
+     *
+     * @tparam N Number of requests remembered.
+     */
+    template <size_t N>
+    class TransactionTable
+    {
+        public:
+            /**
+             * @brief Record a request and its outcome, evicting the oldest one if full.
+             * @param[in] msgId Message id, without TRANSACTION_FLAG.
+             * @param[in] transactionId Transaction id chosen by the master.
+             * @param[in] code Outcome, Pending if the request completes later.
+             */
+            void complete(RxMessageId msgId, uint8_t transactionId, ResponseCode code)
+            {
+                if (count == N)
+                {
+                    remove(0);
+                }
+                entries[count++] = {msgId, transactionId, code};
+            }
+
+            /**
+             * @brief Complete the pending requests with a message id.
+             * @param[in] msgId Message id, without TRANSACTION_FLAG.
+             * @param[in] code Outcome.
+             * @return Number of requests completed.
+             */
+            size_t resolve(RxMessageId msgId, ResponseCode code)
+            {
+                size_t resolved = 0;
+                size_t i = 0;
+                // Resolved entries move to the end, each pending one is visited once
+                for (size_t visited = 0; visited < count; visited++)
+                {
+                    if (entries[i].msgId == msgId && entries[i].code == ResponseCode::Pending)
+                    {
+                        Entry entry = entries[i];
+                        entry.code = code;
+                        remove(i);
+                        entries[count++] = entry;
+                        resolved++;
+                    }
+                    else
+                    {
+                        i++;
+                    }
+                }
+                return resolved;
+            }
+
+            /**
+             * @brief Write the responses, in completion order. The most recent ones are kept
+             *        when they do not all fit.
+             * @param[out] out Response buffer.
+             * @param[in] capacity Size of the response buffer.
+             * @return Length written.
+             */
+            size_t serialize(uint8_t * out, size_t capacity) const
+            {
+                size_t first = count;
+                size_t length = 0;
+                while (first > 0 && length + responseSize(entries[first - 1]) <= capacity)
+                {
+                    first--;
+                    length += responseSize(entries[first]);
+                }
+                uint8_t * cursor = out;
+                for (size_t i = first; i < count; i++)
+                {
+                    const Entry & entry = entries[i];
+                    if (entry.code == ResponseCode::Positive)
+                    {
+                        *cursor++ = static_cast<uint8_t>(entry.msgId + POSITIVE_RESPONSE_OFFSET);
+                        *cursor++ = entry.transactionId;
+                    }
+                    else
+                    {
+                        *cursor++ = NEGATIVE_RESPONSE_ID;
+                        *cursor++ = entry.msgId;
+                        *cursor++ = entry.transactionId;
+                        *cursor++ = static_cast<uint8_t>(entry.code);
+                    }
+                }
+                return length;
+            }
+
+            size_t size() const
+            {
+                return count;
+            }
+
+            void clear()
+            {
+                count = 0;
+            }
+
+        private:
+            struct Entry
+            {
+                RxMessageId msgId;
+                uint8_t transactionId;
+                ResponseCode code;
+            };
+
+            static constexpr size_t responseSize(const Entry & entry)
+            {
+                return (entry.code == ResponseCode::Positive) ? POSITIVE_RESPONSE_SIZE : NEGATIVE_RESPONSE_SIZE;
+            }
+
+            void remove(size_t index)
+            {
+                for (size_t i = index + 1; i < count; i++)
+                {
+                    entries[i - 1] = entries[i];
+                }
+                count--;
+            }
+
+            Entry entries[N];
+            size_t count = 0;
+    };
+
+} // namespace Communication
@@ -0,0 +1,141 @@
+/***********************************************************************
+ * @file	:	transport.hpp
+ * @brief 	:	Transport Interface
+ *              Definition of a frame transport interface so that
+ *              services are independent of the bus they run on.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include "message_format.hpp"
+#include "frame_pool.hpp"
+#include "comm_statistics.hpp"
+
+namespace Communication {
+
+    /**
+     * @class ITransport
+     * @brief Frame transport interface. Delivers received frames to an RxHandler and sends
+     *        the responses published by the services.
+     *
+     * @details
+     * Calls are expected in this order: start(), then setIntegrity() if frames carry a check,
+     * then pump() and publishResponse() periodically from a single context.
+     */
+    class ITransport
+    {
+        public:
+            explicit ITransport() = default;
+            virtual ~ITransport() = default;
+
+            /**
+             * @brief Start receiving frames.
+             * @param[in] rxHandler Called with each received frame.
+             * @param[in] txHandler Called for each byte the master reads past the published
+             *            response, on transports where the master drives reads.
+             * @param[in] mode Context in which rxHandler is called.
+             */
+            virtual void start(RxHandler rxHandler, TxHandler txHandler, DispatchMode mode) = 0;
+
+            /**
+             * @brief Set the integrity check received frames carry, corrupted frames are dropped.
+             */
+            virtual void setIntegrity(Integrity integrity) = 0;
+
+            /**
+             * @brief Call the rxHandler for the frames received so far, in Deferred mode.
+             * @param[in] budget Maximum number of frames to handle in this call.
+             * @return Number of frames handled.
+             */
+            virtual size_t pump(size_t budget = DEFAULT_DISPATCH_BUDGET) = 0;
+
+            /**
+             * @brief Publish the response to the frames handled so far.
+             * @param[in] data Response bytes, copied.
+             * @param[in] length Response length.
+             * @return False if the response cannot be sent.
+             */
+            virtual bool publishResponse(const uint8_t * data, size_t length) = 0;
+
+            /**
+             * @brief Call a handler from the receive interrupt when a frame starts with msgId, on
+             *        transports that see frames byte by byte. The frame is still dispatched.
+             * @param[in] msgId Message id to recognise.
+             * @param[in] handler Handler, nullptr to stop recognising the id.
+             */
+            virtual void setUrgentHandler(RxMessageId /*msgId*/, UrgentHandler /*handler*/) {}
+
+            virtual uint32_t droppedFrames() const = 0;
+            virtual uint32_t corruptedFrames() const = 0;
+    };
+
+    /**
+     * @class PooledTransport
+     * @brief Base of transports receiving into their own frame pool. The derived transport
+     *        fills frames from its receive context and calls frameReceived() when one is complete.
+     */
+    class PooledTransport : public ITransport
+    {
+        public:
+            void start(RxHandler rxHandlerPtr, TxHandler txHandlerPtr, DispatchMode mode) override
+            {
+                rxHandler = rxHandlerPtr;
+                txHandler = txHandlerPtr;
+                dispatchMode = mode;
+                rxFrames.setIntegrity(Integrity::None);
+            }
+
+            void setIntegrity(Integrity integrity) override
+            {
+                rxFrames.setIntegrity(integrity);
+            }
+
+            size_t pump(size_t budget = DEFAULT_DISPATCH_BUDGET) override
+            {
+                if (dispatchMode != DispatchMode::Deferred || rxHandler == nullptr)
+                {
+                    return 0;
+                }
+                return rxFrames.dispatch(rxHandler, budget);
+            }
+
+            uint32_t droppedFrames() const override
+            {
+                return rxFrames.droppedFrames();
+            }
+
+            uint32_t corruptedFrames() const override
+            {
+                return rxFrames.corruptedFrames();
+            }
+
+        protected:
+            /**
+             * @brief Publish the frame being filled and, in Immediate mode, dispatch it.
+             * @return True if a frame was published.
+             */
+            bool frameReceived()
+            {
+                if (!rxFrames.publish())
+                {
+                    return false;
+                }
+                commStatistics.frames.increment();
+                commStatistics.pendingFrames.update(static_cast<uint32_t>(rxFrames.pending()));
+                if (dispatchMode == DispatchMode::Immediate && rxHandler != nullptr)
+                {
+                    rxFrames.dispatch(rxHandler, RX_FRAME_SLOTS);
+                }
+                return true;
+            }
+
+            RxFrames rxFrames;
+            RxHandler rxHandler = nullptr;
+            TxHandler txHandler = nullptr;
+            DispatchMode dispatchMode = DispatchMode::Immediate;
+    };
+
+} // namespace Communication
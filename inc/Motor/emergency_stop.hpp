@@ -0,0 +1,76 @@
+/***********************************************************************
+ * @file	:	emergency_stop.hpp
+ * @brief 	:	Emergency stop latch
+ * 				Latches an emergency stop and disables every registered
+ *              motor right away, from any context.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include "imotor.hpp"
+
+namespace Motor {
+
+    constexpr size_t MAX_STOP_MOTORS = 8;  // Motors disabled by an emergency stop
+
+    /**
+     * @class EmergencyStopLatch
+     * @brief Emergency stop shared by the whole application.
+     *
+     * @details
+     * trigger() does not allocate, lock nor go through the state machine, so it can be called from
+     * the interrupt that recognises an emergency stop message. Motors are registered once at
+     * start-up, before the interrupts that may trigger the latch are enabled. The latch is only
+     * released by a reset.
+     */
+    class EmergencyStopLatch
+    {
+        public:
+            /**
+             * @brief Register a motor to be disabled by an emergency stop.
+             * @param[in] motor Motor, must outlive the latch.
+             * @return False if MAX_STOP_MOTORS are already registered.
+             */
+            static bool registerMotor(IMotor * motor);
+
+            /**
+             * @brief Latch the emergency stop and disable every registered motor.
+             *        Safe to call again, motors are disabled on every call.
+             */
+            static void trigger();
+
+            /**
+             * @brief Check if the emergency stop was triggered.
+             */
+            static bool isLatched()
+            {
+                return latched.load(std::memory_order_acquire);
+            }
+
+            /**
+             * @brief Time at which the emergency stop was first triggered.
+             * @return Microseconds since boot.
+             */
+            static uint32_t latchTimeUs()
+            {
+                return latchedAtUs;
+            }
+
+            /**
+             * @brief Release the latch and unregister every motor, as a reset does.
+             */
+            static void reset();
+
+        private:
+            EmergencyStopLatch() = default; // Private constructor to avoid instance creation
+            static IMotor * motors[MAX_STOP_MOTORS];
+            static std::atomic<size_t> motorCount;
+            static std::atomic<bool> latched;
+            static volatile uint32_t latchedAtUs;
+    };
+
+} // namespace Motor
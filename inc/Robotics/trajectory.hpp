@@ -8,8 +8,10 @@
 
 #pragma once 
 #include <list>
+#include <deque>
 #include <cstdint>
 #include "configuration_space.hpp"
+#include "waypoint_quantization.hpp"
 
 namespace Robotics {
     
@@ -21,6 +23,8 @@ namespace Robotics {
      * It provides methods to save waypoints, get the next waypoint, check if the trajectory is complete,
      * clear the waypoints and get the number of waypoints. In theory no thread safety is required for this 
      * class as the read and write access are performed from different states.
+     * Quantized waypoints are stored as received, without per waypoint links, and decoded with the
+     * program scale when taken with getNextWaypoint(). They are taken after the float ones.
      * 
      */
     class Trajectory {
@@ -32,11 +36,15 @@ namespace Robotics {
             bool isTrajectoryComplete();
             virtual void saveWaypoints(const uint8_t * rawWaypoints, const size_t size);
             void saveWaypoints(const Waypoint_t * waypoints, const size_t size);
+            virtual void setScale(const WaypointScale_t & scale);
+            virtual void saveQuantizedWaypoints(const uint8_t * rawWaypoints, const size_t size);
             void clearWaypoints();
             size_t numOfWaypoints();
             
         private:
             std::list<Waypoint_t> waypoints; // Linked list to store waypoints
+            std::deque<QuantizedWaypoint_t> quantizedWaypoints;
+            WaypointScale_t scale = coordinateScale();
     };
 
 } // namespace Robotics
@@ -0,0 +1,112 @@
+/***********************************************************************
+ * @file	:	waypoint_codec.hpp
+ * @brief 	:	Waypoint stream codec
+ *              Delta and zigzag varint compression of quantized
+ *              waypoints, decodable byte by byte.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include "waypoint_quantization.hpp"
+
+namespace Robotics {
+
+    /**
+     * Stream: for every waypoint, for every joint, the difference with the same joint of the
+     * previous waypoint (0 before the first one), zigzag mapped so that small negative and
+     * positive differences both give small numbers, then written in 7 bit groups, least
+     * significant first, with the high bit set on all groups but the last.
+     */
+    constexpr size_t MAX_VARINT_BYTES = 3;   // Differences of int16 values need 17 bits
+    constexpr size_t MAX_ENCODED_WAYPOINT = NUM_JOINTS * MAX_VARINT_BYTES;
+    constexpr size_t DECODE_BATCH = 8;       // Waypoints handed to the sink at once
+
+    /**
+     * @brief Function pointer signature called with decoded waypoints.
+     */
+    typedef void (*WaypointSink)(const QuantizedWaypoint_t * waypoints, size_t count);
+
+    /**
+     * @class WaypointEncoder
+     * @brief Encodes quantized waypoints into the delta stream. Used by masters and host tools.
+     */
+    class WaypointEncoder
+    {
+        public:
+            WaypointEncoder();
+
+            /**
+             * @brief Encode the next waypoint.
+             * @param[in] waypoint Waypoint.
+             * @param[out] out Buffer of at least MAX_ENCODED_WAYPOINT bytes.
+             * @return Encoded length.
+             */
+            size_t encode(const QuantizedWaypoint_t & waypoint, uint8_t * out);
+
+            /**
+             * @brief Start a new stream.
+             */
+            void reset();
+
+        private:
+            QuantizedWaypoint_t previous;
+    };
+
+    /**
+     * @class WaypointDecoder
+     * @brief Decodes the delta stream incrementally, in pieces of any length.
+     *
+     * @details
+     * Only the previous waypoint, the varint being read and a batch of DECODE_BATCH decoded
+     * waypoints are kept, the batch is handed to the sink when full and at the end of each piece.
+     * A varint longer than MAX_VARINT_BYTES or a value out of the int16 range marks the stream
+     * as malformed, after which the rest is ignored.
+     */
+    class WaypointDecoder
+    {
+        public:
+            /**
+             * @brief Constructor.
+             * @param[in] sink Function called with the decoded waypoints.
+             */
+            explicit WaypointDecoder(WaypointSink sink);
+
+            /**
+             * @brief Decode a piece of the stream.
+             * @param[in] data Stream bytes.
+             * @param[in] length Number of bytes.
+             * @return False if the stream is malformed.
+             */
+            bool decode(const uint8_t * data, size_t length);
+
+            /**
+             * @brief Start a new stream.
+             */
+            void reset();
+
+            /**
+             * @brief Check that the stream so far ends on a whole waypoint.
+             */
+            bool atWaypointBoundary() const noexcept { return joint == 0 && shift == 0; }
+
+            bool isMalformed() const noexcept { return malformed; }
+            uint32_t getDecodedWaypoints() const noexcept { return decoded; }
+
+        private:
+            void flush();
+
+            WaypointSink sink;
+            QuantizedWaypoint_t current;
+            QuantizedWaypoint_t batch[DECODE_BATCH];
+            size_t batchLength;
+            size_t joint;
+            uint32_t value;
+            uint8_t shift;
+            uint32_t decoded;
+            bool malformed;
+    };
+
+} // namespace Robotics
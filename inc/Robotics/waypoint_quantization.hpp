@@ -0,0 +1,133 @@
+/***********************************************************************
+ * @file	:	waypoint_quantization.hpp
+ * @brief 	:	Quantized waypoints
+ *              Compact fixed-point waypoint format, int16 joint values
+ *              scaled over a per-program range.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include "configuration_space.hpp"
+
+namespace Robotics {
+
+    constexpr size_t NUM_JOINTS = sizeof(Waypoint_t) / sizeof(float);
+    constexpr int32_t QUANTIZED_MIN = INT16_MIN;
+    constexpr int32_t QUANTIZED_MAX = INT16_MAX;
+    constexpr float QUANTIZED_STEPS = static_cast<float>(QUANTIZED_MAX - QUANTIZED_MIN);
+
+    /**
+     * @brief Range a joint is quantized over, QUANTIZED_MIN maps to min and QUANTIZED_MAX to max.
+     */
+    struct JointScale_t
+    {
+        float min;
+        float max;
+    };
+
+    /**
+     * @brief Per-program scale header, sent ahead of the quantized waypoints.
+     */
+    struct WaypointScale_t
+    {
+        JointScale_t q[NUM_JOINTS];
+    };
+
+    /**
+     * @brief Waypoint with joint values quantized over a WaypointScale_t, half the size of Waypoint_t.
+     */
+    struct QuantizedWaypoint_t
+    {
+        int16_t q[NUM_JOINTS];
+    };
+
+    static_assert(sizeof(WaypointScale_t) % sizeof(QuantizedWaypoint_t) == 0,
+                  "Scale header must be a whole number of quantized waypoints");
+
+    /**
+     * @brief Scale covering the limits of each generalized coordinate.
+     * @param[in] space Configuration space.
+     * @return Scale header.
+     */
+    inline WaypointScale_t coordinateScale(const ConfigurationSpace_t & space = ConfigurationSpace_t())
+    {
+        return {{{space.q1.min, space.q1.max}, {space.q2.min, space.q2.max}, {space.q3.min, space.q3.max},
+                 {space.q4.min, space.q4.max}, {space.q5.min, space.q5.max}, {space.q6.min, space.q6.max}}};
+    }
+
+    /**
+     * @brief Distance between two consecutive quantized values, the worst case error is half of it.
+     * @param[in] scale Joint range.
+     */
+    inline float quantizationStep(const JointScale_t & scale)
+    {
+        return (scale.max - scale.min) / QUANTIZED_STEPS;
+    }
+
+    /**
+     * @brief Quantize a joint value, clamped to the joint range.
+     */
+    inline int16_t quantize(float value, const JointScale_t & scale)
+    {
+        float range = scale.max - scale.min;
+        if (!(range > 0.0f) || !(value > scale.min))
+        {
+            return static_cast<int16_t>(QUANTIZED_MIN);
+        }
+        if (value >= scale.max)
+        {
+            return static_cast<int16_t>(QUANTIZED_MAX);
+        }
+        int32_t code = static_cast<int32_t>(std::lround((value - scale.min) / range * QUANTIZED_STEPS)) + QUANTIZED_MIN;
+        return static_cast<int16_t>((code > QUANTIZED_MAX) ? QUANTIZED_MAX : code);
+    }
+
+    /**
+     * @brief Joint value of a quantized one.
+     */
+    inline float dequantize(int16_t code, const JointScale_t & scale)
+    {
+        return scale.min + static_cast<float>(static_cast<int32_t>(code) - QUANTIZED_MIN) * quantizationStep(scale);
+    }
+
+    /**
+     * @brief Quantize a waypoint.
+     * @param[in] waypoint Waypoint.
+     * @param[in] scale Program scale.
+     * @return Quantized waypoint.
+     */
+    inline QuantizedWaypoint_t quantize(const Waypoint_t & waypoint, const WaypointScale_t & scale)
+    {
+        float joints[NUM_JOINTS];
+        memcpy(joints, &waypoint, sizeof(joints));
+        QuantizedWaypoint_t quantized;
+        for (size_t i = 0; i < NUM_JOINTS; i++)
+        {
+            quantized.q[i] = quantize(joints[i], scale.q[i]);
+        }
+        return quantized;
+    }
+
+    /**
+     * @brief Decode a quantized waypoint.
+     * @param[in] quantized Quantized waypoint.
+     * @param[in] scale Program scale.
+     * @return Waypoint.
+     */
+    inline Waypoint_t dequantize(const QuantizedWaypoint_t & quantized, const WaypointScale_t & scale)
+    {
+        float joints[NUM_JOINTS];
+        for (size_t i = 0; i < NUM_JOINTS; i++)
+        {
+            joints[i] = dequantize(quantized.q[i], scale.q[i]);
+        }
+        Waypoint_t waypoint;
+        memcpy(&waypoint, joints, sizeof(joints));
+        return waypoint;
+    }
+
+} // namespace Robotics
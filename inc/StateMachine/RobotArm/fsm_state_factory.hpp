@@ -14,6 +14,7 @@ namespace StateMachine{
 
     /**
      * @brief Template specialization of the StateFactory class for the robotic arm finite state machine.
+     *        States live in a StateSlab, so transitions do not allocate.
      */
     template <>
     class StateFactory<RobotArm::StateId, RobotArm::Event, RobotArm::stateTransMatrix>
@@ -21,13 +22,52 @@ namespace StateMachine{
         private:
             using StateManager_ = StateManager<RobotArm::StateId, RobotArm::Event, RobotArm::stateTransMatrix>;
         public:
-            static std::unique_ptr<State<RobotArm::StateId, RobotArm::Event, RobotArm::stateTransMatrix>>
+            static StatePtr<RobotArm::StateId, RobotArm::Event, RobotArm::stateTransMatrix>
                 createState(RobotArm::StateId sId, StateManager_ * sManager);
     };
 
     namespace RobotArm
     {
         using FSMStateFactory = StateMachine::StateFactory<RobotArm::StateId, RobotArm::Event, RobotArm::stateTransMatrix>;
+
+        /**
+         * @brief States FSMStateFactory creates, every other StateId has no behavior yet.
+         */
+        inline constexpr StateId factoryStates[] =
+            {
+                StateId::Init,
+                StateId::Ready,
+                StateId::LoadProgram,
+                StateId::Teach,
+                StateId::ReadyAndLoaded,
+                StateId::StartProgram,
+                StateId::Execute,
+                StateId::Paused,
+                StateId::EmergencyStop,
+                StateId::Operational,
+                StateId::Idle,
+                StateId::Programming,
+                StateId::Running
+            };
+
+        /**
+         * @brief Leaf states FSMStateFactory creates, the ones the arm can be in.
+         */
+        inline constexpr StateId leafStates[] =
+            {
+                StateId::Init,
+                StateId::Ready,
+                StateId::LoadProgram,
+                StateId::Teach,
+                StateId::ReadyAndLoaded,
+                StateId::StartProgram,
+                StateId::Execute,
+                StateId::Paused,
+                StateId::EmergencyStop
+            };
+
+        static_assert(usesOnlyStates(transitions, factoryStates), "A transition involves a state the factory cannot create");
+        static_assert(reachesStates(transitionTable, StateId::Init, leafStates), "A state the factory creates is unreachable");
     } // namespace RobotArm
 
 } // namespace StateMachine
@@ -10,6 +10,8 @@
 #include "state_manager.hpp"
 #include "state_transition_matrix.hpp"
 #include "fsm_state_factory.hpp"
+#include "static_state_manager.hpp"
+#include "states_behavior.hpp"
 
 namespace StateMachine {
 namespace RobotArm {
@@ -43,5 +45,39 @@ namespace RobotArm {
 			}
 	};
 
+	/**
+	 * @class FSMStaticStateManager
+	 * @brief Robotic arm state machine with the states dispatched statically. Drop-in for
+	 *        FSMStateManager where handleEvent and run are called on the concrete type.
+	 */
+	class FSMStaticStateManager
+		: public StaticStateManager<StateId, Event, stateTransMatrix, NUM_STATES,
+		                            States::Init, States::Ready, States::LoadProgram, States::Teach,
+		                            States::ReadyAndLoaded, States::StartProgram, States::Execute,
+		                            States::Paused, States::EmergencyStop, States::Operational, States::Idle,
+		                            States::Programming, States::Running>
+	{
+		public:
+			FSMStaticStateManager() : StaticStateManager(StateId::Init) {}
+
+			/**
+			 * @brief Singleton instance getter.
+			 *
+			 * @return Pointer to the FSMStaticStateManager instance.
+			 */
+			static FSMStaticStateManager * getInstance()
+			{
+				lock_guard<mutex_t> lock(createStateManagerMutex);
+				if (instance == nullptr)
+				{
+					instance = new FSMStaticStateManager();
+				}
+				return instance;
+			}
+
+		private:
+			static inline FSMStaticStateManager * instance = nullptr;
+	};
+
 } // namespace RobotArm
 } // namespace StateMachine
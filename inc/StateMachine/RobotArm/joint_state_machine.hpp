@@ -0,0 +1,169 @@
+/***********************************************************************
+ * @file	:	joint_state_machine.hpp
+ * @brief 	:	Robotic arm joint state machine
+ *              Homing and fault handling of a single joint, one state
+ *              machine instance per joint.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#pragma once
+#include <cstdint>
+#include "transition_table.hpp"
+#include "timer_wheel.hpp"
+#include "state.hpp"
+#include "static_state_manager.hpp"
+#include "state_machine_bank.hpp"
+#include "waypoint_quantization.hpp"
+#include "state_transition_matrix.hpp"
+
+namespace StateMachine {
+namespace RobotArm {
+namespace Joint {
+
+    /**
+     * @brief Enum class representing the events of a joint.
+     */
+    enum class Event : uint8_t
+    {
+        Home,
+        Homed,
+        Fault,
+        Reset,
+        None
+    };
+
+    /**
+     * @brief Enum class representing the possible states of a joint.
+     */
+    enum class StateId : uint8_t
+    {
+        Unhomed,
+        Homing,
+        Homed,
+        Fault
+    };
+
+    constexpr size_t NUM_STATES = static_cast<size_t>(StateId::Fault) + 1;
+    constexpr size_t NUM_EVENTS = static_cast<size_t>(Event::None) + 1;
+
+    using Transition_ = Transition<StateId, Event>;
+
+    /**
+     * @brief Transitions of a joint. A fault is only left by a reset, which requires homing again.
+     */
+    inline constexpr Transition_ transitions[] =
+        {
+            {StateId::Unhomed,  Event::Home,    StateId::Homing},
+            {StateId::Unhomed,  Event::Fault,   StateId::Fault},
+            {StateId::Homing,   Event::Homed,   StateId::Homed},
+            {StateId::Homing,   Event::Fault,   StateId::Fault},
+            {StateId::Homed,    Event::Home,    StateId::Homing},
+            {StateId::Homed,    Event::Fault,   StateId::Fault},
+            {StateId::Fault,    Event::Reset,   StateId::Unhomed}
+        };
+
+    static_assert(hasUniqueTransitions(transitions), "A state has more than one transition on the same event");
+
+    inline constexpr TransitionTable<StateId, Event, NUM_STATES, NUM_EVENTS> transitionTable{transitions};
+
+    /**
+     * @brief Timeouts of a joint, in ticks of the arm timer wheel. A joint not homed in time
+     *        faults.
+     */
+    inline constexpr Timeout<StateId, Event> timeouts[] =
+        {
+            {StateId::Homing,   20000 / TIMER_TICK_MS,  Event::Fault}
+        };
+
+    /**
+     * @brief State transition matrix of a joint.
+     * @param[in] currentState Current state.
+     * @param[in] event Event.
+     * @return Next state.
+     */
+    StateId stateTransMatrix(StateId currentState, Event event);
+
+    inline constexpr StateId jointStates[] = {StateId::Unhomed, StateId::Homing, StateId::Homed, StateId::Fault};
+
+    static_assert(reachesStates(transitionTable, StateId::Unhomed, jointStates), "A joint state is unreachable");
+
+namespace States {
+
+        class Unhomed : public State<StateId, Event, stateTransMatrix>
+        {
+            public:
+                Unhomed(StateManager_ * instance) : State(StateId::Unhomed, instance) {};
+                void run() override;
+                void onEnter() override;
+                void onExit() override;
+        };
+
+        class Homing : public State<StateId, Event, stateTransMatrix>
+        {
+            public:
+                Homing(StateManager_ * instance) : State(StateId::Homing, instance) {};
+                void run() override;
+                void onEnter() override;
+                void onExit() override;
+        };
+
+        class Homed : public State<StateId, Event, stateTransMatrix>
+        {
+            public:
+                Homed(StateManager_ * instance) : State(StateId::Homed, instance) {};
+                void run() override;
+                void onEnter() override;
+                void onExit() override;
+        };
+
+        class Fault : public State<StateId, Event, stateTransMatrix>
+        {
+            public:
+                Fault(StateManager_ * instance) : State(StateId::Fault, instance) {};
+                void run() override;
+                void onEnter() override;
+                void onExit() override;
+        };
+
+} // namespace States
+
+} // namespace Joint
+} // namespace RobotArm
+
+    /**
+     * @brief A joint arms at most its homing timeout.
+     */
+    template <>
+    struct TimerWheelCapacity<RobotArm::Joint::StateId, RobotArm::Joint::Event, RobotArm::Joint::stateTransMatrix>
+    {
+        static constexpr size_t value = 2;
+    };
+
+    /**
+     * @brief State managers of a joint arm the timeouts on entering a state.
+     */
+    template <>
+    struct StateTimeoutsOf<RobotArm::Joint::StateId, RobotArm::Joint::Event, RobotArm::Joint::stateTransMatrix>
+    {
+        static constexpr std::span<const Timeout<RobotArm::Joint::StateId, RobotArm::Joint::Event>> value{
+            RobotArm::Joint::timeouts};
+    };
+
+namespace RobotArm {
+namespace Joint {
+
+    /**
+     * @brief State machine of one joint, owning its states, so joints are independent.
+     */
+    using JointStateManager = StaticStateManager<StateId, Event, stateTransMatrix, NUM_STATES, States::Unhomed,
+                                                 States::Homing, States::Homed, States::Fault>;
+
+    /**
+     * @brief State machines of every joint of the arm, indexed by joint.
+     */
+    using JointBank = StateMachineBank<JointStateManager, Robotics::NUM_JOINTS>;
+
+} // namespace Joint
+} // namespace RobotArm
+} // namespace StateMachine
@@ -8,6 +8,9 @@
 
 #pragma once
 #include <cstdint>
+#include "transition_table.hpp"
+#include "state_hierarchy.hpp"
+#include "timer_wheel.hpp"
 
 namespace StateMachine {
 namespace RobotArm {
@@ -30,7 +33,8 @@ namespace RobotArm {
     };
 
     /**
-     * @brief Enum class representing the possible states of the robotic arm.
+     * @brief Enum class representing the possible states of the robotic arm. Operational, Idle,
+     *        Programming and Running are parent states, the arm is always in one of their leaves.
      */
     enum class StateId : uint8_t
     {
@@ -45,54 +49,134 @@ namespace RobotArm {
         Manual,
         Calibrate,
         GoalBased,
-        EmergencyStop
+        EmergencyStop,
+        Operational,
+        Idle,
+        Programming,
+        Running
     };
 
+    constexpr size_t NUM_STATES = static_cast<size_t>(StateId::Running) + 1;
+    constexpr size_t NUM_EVENTS = static_cast<size_t>(Event::None) + 1;
+
     /**
-     * State diagram
+     * State diagram, transitions of a parent state apply to all of its children
      * @dot
      * digraph state_machine {
+     *     compound=true;
      *     node [shape=ellipse, style=filled, color=lightblue];
      *     edge [color=gray, fontcolor=black, fontsize=10];
      *     
+     *     subgraph cluster_operational {
+     *         label="Operational";
+     *         Init;
+     *         subgraph cluster_idle {
+     *             label="Idle";
+     *             Ready; ReadyAndLoaded;
+     *         }
+     *         subgraph cluster_programming {
+     *             label="Programming";
+     *             LoadProgram; Teach;
+     *         }
+     *         subgraph cluster_running {
+     *             label="Running";
+     *             StartProgram; Execute; Paused;
+     *         }
+     *     }
+     *     
      *     Init -> Ready [label="Done"];
-     *     Ready -> LoadProgram [label="Load"];
-     *     Ready -> Teach [label="Teach"];
-     *     LoadProgram -> Ready [label="Cancel"];
-     *     LoadProgram -> ReadyAndLoaded [label="ProgramLoaded"];
-     *     Teach -> Ready [label="Cancel"];
-     *     Teach -> ReadyAndLoaded [label="ProgramLoaded"];
+     *     Ready -> LoadProgram [label="Load", ltail=cluster_idle];
+     *     Ready -> Teach [label="Teach", ltail=cluster_idle];
+     *     LoadProgram -> Ready [label="Cancel", ltail=cluster_programming];
+     *     LoadProgram -> ReadyAndLoaded [label="ProgramLoaded", ltail=cluster_programming];
      *     ReadyAndLoaded -> StartProgram [label="Start"];
-     *     ReadyAndLoaded -> LoadProgram [label="Load"];
-     *     ReadyAndLoaded -> Teach [label="Teach"];
-     *     StartProgram -> ReadyAndLoaded [label="Cancel"];
+     *     StartProgram -> ReadyAndLoaded [label="Cancel", ltail=cluster_running];
      *     StartProgram -> Execute [label="Done"];
      *     Execute -> StartProgram [label="Start"];
      *     Execute -> Paused [label="Pause"];
      *     Execute -> ReadyAndLoaded [label="Done"];
-     *     Execute -> ReadyAndLoaded [label="Cancel"];
      *     Paused -> StartProgram [label="Start"];
      *     Paused -> Execute [label="Resume"];
-     *     Paused -> ReadyAndLoaded [label="Cancel"];
-     * }
-     * @enddot
-     * @dot
-     * digraph emergency_stop {
-     *     node [shape=ellipse, style=filled, color=lightcoral];
-     *     edge [color=red, fontcolor=black, fontsize=10];
-     *     
-     *     Init -> EmergencyStop [label="EmergencyStop"];
-     *     Ready -> EmergencyStop [label="EmergencyStop"];
-     *     LoadProgram -> EmergencyStop [label="EmergencyStop"];
-     *     Teach -> EmergencyStop [label="EmergencyStop"];
-     *     ReadyAndLoaded -> EmergencyStop [label="EmergencyStop"];
-     *     StartProgram -> EmergencyStop [label="EmergencyStop"];
-     *     Execute -> EmergencyStop [label="EmergencyStop"];
-     *     Paused -> EmergencyStop [label="EmergencyStop"];
+     *     Init -> EmergencyStop [label="EmergencyStop", ltail=cluster_operational, color=red];
      * }
      * @enddot
      */
 
+    using Transition_ = Transition<StateId, Event>;
+
+    /**
+     * @brief Parent states of the robotic arm. EmergencyStop is outside Operational, it is only
+     *        left by a reset.
+     */
+    inline constexpr Parent<StateId> parents[] =
+        {
+            {StateId::Init,             StateId::Operational},
+            {StateId::Idle,             StateId::Operational},
+            {StateId::Programming,      StateId::Operational},
+            {StateId::Running,          StateId::Operational},
+
+            {StateId::Ready,            StateId::Idle},
+            {StateId::ReadyAndLoaded,   StateId::Idle},
+
+            {StateId::LoadProgram,      StateId::Programming},
+            {StateId::Teach,            StateId::Programming},
+
+            {StateId::StartProgram,     StateId::Running},
+            {StateId::Execute,          StateId::Running},
+            {StateId::Paused,           StateId::Running}
+        };
+
+    inline constexpr StateHierarchy<StateId, NUM_STATES> hierarchy{parents};
+
+    static_assert(hierarchy.isWellFormed(), "Parent states form a cycle or are nested too deep");
+
+    /**
+     * @brief Transitions of the robotic arm, as in the state diagram. Events a state has no
+     *        transition for bubble up to its parents, events no ancestor handles leave it unchanged.
+     */
+    inline constexpr Transition_ transitions[] =
+        {
+            {StateId::Operational,      Event::EmergencyStop,   StateId::EmergencyStop},
+
+            {StateId::Init,             Event::Done,            StateId::Ready},
+
+            {StateId::Idle,             Event::Load,            StateId::LoadProgram},
+            {StateId::Idle,             Event::Teach,           StateId::Teach},
+            {StateId::ReadyAndLoaded,   Event::Start,           StateId::StartProgram},
+
+            {StateId::Programming,      Event::Cancel,          StateId::Ready},
+            {StateId::Programming,      Event::ProgramLoaded,   StateId::ReadyAndLoaded},
+
+            {StateId::Running,          Event::Cancel,          StateId::ReadyAndLoaded},
+            {StateId::StartProgram,     Event::Done,            StateId::Execute},
+            {StateId::Execute,          Event::Start,           StateId::StartProgram},
+            {StateId::Execute,          Event::Pause,           StateId::Paused},
+            {StateId::Execute,          Event::Done,            StateId::ReadyAndLoaded},
+            {StateId::Paused,           Event::Start,           StateId::StartProgram},
+            {StateId::Paused,           Event::Resume,          StateId::Execute}
+        };
+
+    static_assert(hasUniqueTransitions(transitions), "A state has more than one transition on the same event");
+    static_assert(targetsLeaves(transitions, hierarchy), "A transition enters a parent state");
+
+    /**
+     * @brief Dense lookup table generated at compile time from the transitions, with the
+     *        transitions of parent states copied down to their children.
+     */
+    inline constexpr TransitionTable<StateId, Event, NUM_STATES, NUM_EVENTS> transitionTable{transitions, hierarchy};
+
+    constexpr uint32_t TIMER_TICK_MS = 1;  // Period of the timer wheel tick
+
+    /**
+     * @brief Timeouts of the robotic arm, in ticks from the entry of the state. A program not
+     *        started after homing, or left paused, is cancelled.
+     */
+    inline constexpr Timeout<StateId, Event> timeouts[] =
+        {
+            {StateId::StartProgram,     10000 / TIMER_TICK_MS,  Event::Cancel},
+            {StateId::Paused,           60000 / TIMER_TICK_MS,  Event::Cancel}
+        };
+
     /**
      * @brief State transition matrix of the robotic arm finite state machine.
      * @param[in] currentState Current state.
@@ -102,4 +186,23 @@ namespace RobotArm {
     StateId stateTransMatrix(StateId currentState, Event event);
 
 } // namespace RobotArm
+
+    /**
+     * @brief State managers of the robotic arm exit and enter parent states on transitions.
+     */
+    template <>
+    struct StateHierarchyOf<RobotArm::StateId, RobotArm::Event, RobotArm::stateTransMatrix>
+    {
+        static constexpr const auto & value = RobotArm::hierarchy;
+    };
+
+    /**
+     * @brief State managers of the robotic arm arm the timeouts on entering a state.
+     */
+    template <>
+    struct StateTimeoutsOf<RobotArm::StateId, RobotArm::Event, RobotArm::stateTransMatrix>
+    {
+        static constexpr std::span<const Timeout<RobotArm::StateId, RobotArm::Event>> value{RobotArm::timeouts};
+    };
+
 } // namespace StateMachine
@@ -94,6 +94,44 @@ namespace States {
                 void onEnter() override;
                 void onExit() override;
         };
+
+        // Parent states, only entered and exited around their children
+
+        class Operational : public State<StateId, Event, stateTransMatrix>
+        {
+            public:
+                Operational(StateManager_ * instance) : State(StateId::Operational, instance) {};
+                void run() override;
+                void onEnter() override;
+                void onExit() override;
+        };
+
+        class Idle : public State<StateId, Event, stateTransMatrix>
+        {
+            public:
+                Idle(StateManager_ * instance) : State(StateId::Idle, instance) {};
+                void run() override;
+                void onEnter() override;
+                void onExit() override;
+        };
+
+        class Programming : public State<StateId, Event, stateTransMatrix>
+        {
+            public:
+                Programming(StateManager_ * instance) : State(StateId::Programming, instance) {};
+                void run() override;
+                void onEnter() override;
+                void onExit() override;
+        };
+
+        class Running : public State<StateId, Event, stateTransMatrix>
+        {
+            public:
+                Running(StateManager_ * instance) : State(StateId::Running, instance) {};
+                void run() override;
+                void onEnter() override;
+                void onExit() override;
+        };
 } // namespace States
 } // namespace RobotArm
 } // namespace StateMachine
@@ -9,6 +9,7 @@
 
 #pragma once
 #include "state_manager.hpp"
+#include "state_ptr.hpp"
 
 namespace StateMachine {
 
@@ -44,6 +45,7 @@ namespace StateMachine {
             virtual void onExit() = 0;  // Behavior to be run when exiting the state
             virtual ~State() {};
             StateId getStateId() const noexcept {return currentState;} 
+            void setManager(StateManager_ * sManager) noexcept {manager = sManager;} // For reused states
 
         protected:
             const StateId currentState;
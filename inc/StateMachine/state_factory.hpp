@@ -8,6 +8,7 @@
 
 #pragma once
 #include "state.hpp"
+#include "state_ptr.hpp"
 #include <memory>
 
 namespace StateMachine {
@@ -41,7 +42,7 @@ namespace StateMachine {
              * @param[in] sManager State manager.
              * @return Unique pointer to the state object.
              */
-            static std::unique_ptr<State<StateId, Event, stateTransMatrix>> createState(StateId sId, StateManager<StateId, Event, stateTransMatrix> *sManager)
+            static StatePtr<StateId, Event, stateTransMatrix> createState(StateId sId, StateManager<StateId, Event, stateTransMatrix> *sManager)
             {
                 return nullptr;
             };
@@ -0,0 +1,217 @@
+/***********************************************************************
+ * @file	:	state_hierarchy.hpp
+ * @brief 	:	StateHierarchy class
+ *              Parent relation between states of a hierarchical state
+ *              machine, with the entry and exit chains of every
+ *              transition resolved at compile time.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace StateMachine {
+
+    // Type alias for the state transition matrix function
+    template <typename StateId, typename Event>
+    using StateTransMatrix = StateId (*)(StateId, Event);
+
+    /**
+     * @brief Parent of a state.
+     */
+    template <typename StateId>
+    struct Parent
+    {
+        StateId state;
+        StateId parent;
+    };
+
+    /**
+     * @class StateHierarchy
+     * @brief Tree of states, states without a parent are roots. Levels count from 1 at the roots,
+     *        so a transition exits the source and its ancestors below the levels shared with the
+     *        target, then enters the ancestors of the target below them, top down, and the target.
+     *
+     * @tparam StateId Enum class representing the possible states.
+     * @tparam NumStates Number of states, StateId values must be below it.
+     * @tparam MaxLevels Maximum number of levels.
+     */
+    template <typename StateId, size_t NumStates, size_t MaxLevels = 4>
+    class StateHierarchy
+    {
+        public:
+            /**
+             * @brief Build the tree and the shared levels of every pair of states.
+             * @param[in] parents Parent of every state that has one.
+             */
+            template <size_t N>
+            consteval explicit StateHierarchy(const Parent<StateId> (&parents)[N])
+                : parentOf{}, levels{}, path{}, shared{}, leaf{}, wellFormed(true)
+            {
+                for (size_t s = 0; s < NumStates; s++)
+                {
+                    parentOf[s] = static_cast<StateId>(s);
+                    leaf[s] = true;
+                }
+                for (const Parent<StateId> & parent : parents)
+                {
+                    parentOf[index(parent.state)] = parent.parent;
+                    leaf[index(parent.parent)] = false;
+                }
+                for (size_t s = 0; s < NumStates; s++)
+                {
+                    // Walk up to the root, a cycle or a deep tree exceeds MaxLevels
+                    StateId chain[MaxLevels] = {};
+                    size_t length = 0;
+                    StateId state = static_cast<StateId>(s);
+                    while (length < MaxLevels)
+                    {
+                        chain[length++] = state;
+                        if (parentOf[index(state)] == state)
+                        {
+                            break;
+                        }
+                        state = parentOf[index(state)];
+                    }
+                    wellFormed = wellFormed && (parentOf[index(state)] == state);
+                    levels[s] = static_cast<uint8_t>(length);
+                    for (size_t l = 0; l < length; l++)
+                    {
+                        path[s][l] = chain[length - 1 - l];
+                    }
+                }
+                for (size_t a = 0; a < NumStates; a++)
+                {
+                    for (size_t b = 0; b < NumStates; b++)
+                    {
+                        size_t l = 0;
+                        while (l < levels[a] && l < levels[b] && path[a][l] == path[b][l])
+                        {
+                            l++;
+                        }
+                        shared[a][b] = static_cast<uint8_t>(l);
+                    }
+                }
+            }
+
+            /**
+             * @brief Level of a state, 1 for roots.
+             * @param[in] sId State id.
+             * @return Level.
+             */
+            constexpr size_t level(StateId sId) const
+            {
+                return inRange(sId) ? levels[index(sId)] : 1;
+            }
+
+            /**
+             * @brief Ancestor of a state at a level, the state itself at its own level.
+             * @param[in] sId State id.
+             * @param[in] atLevel Level, from 1 to level(sId).
+             * @return Ancestor state id.
+             */
+            constexpr StateId ancestor(StateId sId, size_t atLevel) const
+            {
+                return inRange(sId) ? path[index(sId)][atLevel - 1] : sId;
+            }
+
+            /**
+             * @brief Parent of a state.
+             * @param[in] sId State id.
+             * @return Parent state id, sId for roots.
+             */
+            constexpr StateId parent(StateId sId) const
+            {
+                return inRange(sId) ? parentOf[index(sId)] : sId;
+            }
+
+            /**
+             * @brief Number of levels two states have in common, the level of their least common
+             *        ancestor or 0 if they are in different trees.
+             * @param[in] a State id.
+             * @param[in] b State id.
+             * @return Shared levels.
+             */
+            constexpr size_t sharedLevels(StateId a, StateId b) const
+            {
+                if (!inRange(a) || !inRange(b))
+                {
+                    return (a == b) ? 1 : 0;
+                }
+                return shared[index(a)][index(b)];
+            }
+
+            /**
+             * @brief Check if a state has no children.
+             * @param[in] sId State id.
+             * @return True for leaf states.
+             */
+            constexpr bool isLeaf(StateId sId) const
+            {
+                return !inRange(sId) || leaf[index(sId)];
+            }
+
+            /**
+             * @brief Check that the parents form trees no deeper than MaxLevels.
+             * @return False if a state is in a cycle or too deep.
+             */
+            constexpr bool isWellFormed() const
+            {
+                return wellFormed;
+            }
+
+        private:
+            static constexpr size_t index(StateId sId)
+            {
+                return static_cast<size_t>(sId);
+            }
+
+            static constexpr bool inRange(StateId sId)
+            {
+                return index(sId) < NumStates;
+            }
+
+            std::array<StateId, NumStates> parentOf;
+            std::array<uint8_t, NumStates> levels;
+            std::array<std::array<StateId, MaxLevels>, NumStates> path;
+            std::array<std::array<uint8_t, NumStates>, NumStates> shared;
+            std::array<bool, NumStates> leaf;
+            bool wellFormed;
+    };
+
+    /**
+     * @brief Hierarchy of a state machine without parent states.
+     */
+    template <typename StateId>
+    struct FlatHierarchy
+    {
+        static constexpr size_t level(StateId)
+        {
+            return 1;
+        }
+
+        static constexpr StateId ancestor(StateId sId, size_t)
+        {
+            return sId;
+        }
+
+        static constexpr size_t sharedLevels(StateId a, StateId b)
+        {
+            return (a == b) ? 1 : 0;
+        }
+    };
+
+    /**
+     * @brief Hierarchy the state managers of a state machine follow on transitions. Flat unless
+     *        specialized for the state machine with a StateHierarchy.
+     */
+    template <typename StateId, typename Event, StateTransMatrix<StateId, Event> stateTransMatrix>
+    struct StateHierarchyOf
+    {
+        static constexpr FlatHierarchy<StateId> value{};
+    };
+
+} // namespace StateMachine
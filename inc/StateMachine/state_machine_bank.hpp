@@ -0,0 +1,127 @@
+/***********************************************************************
+ * @file	:	state_machine_bank.hpp
+ * @brief 	:	StateMachineBank class
+ *              Array of independent state machines of the same type,
+ *              stepped together in one loop.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace StateMachine {
+
+    /**
+     * @class StateMachineBank
+     * @brief Count state machines stored side by side, for instance one per joint.
+     *
+     * @details
+     * The managers are members of the bank, which has no heap use and can live in static storage
+     * or an arena. runAll() steps them in index order in one loop over contiguous memory. Meant
+     * for StaticStateManager, which owns its states: StateManager instances of the same state
+     * machine share the states of their StateFactory.
+     * handleEvent is lock-free as for a single manager, runAll and advanceTimers are to be called
+     * from a single thread.
+     *
+     * @tparam Manager State manager type, constructible from its initial state id.
+     * @tparam Count Number of state machines.
+     */
+    template <typename Manager, size_t Count>
+    class StateMachineBank
+    {
+        static_assert(Count > 0, "A bank needs at least one state machine");
+
+        public:
+            /**
+             * @brief Constructor.
+             * @param[in] sId Initial state id of every state machine.
+             */
+            template <typename StateId>
+            explicit StateMachineBank(StateId sId) : StateMachineBank(sId, std::make_index_sequence<Count>{}) {}
+
+            StateMachineBank(const StateMachineBank & obj) = delete;
+            StateMachineBank & operator=(const StateMachineBank & obj) = delete;
+
+            /**
+             * @brief Run every state machine once.
+             */
+            void runAll()
+            {
+                for (Manager & manager : managers)
+                {
+                    manager.run();
+                }
+            }
+
+            /**
+             * @brief Post the events of the timers due in every state machine.
+             * @param[in] now Current tick of the TimerClock.
+             */
+            void advanceTimers(uint32_t now)
+            {
+                for (Manager & manager : managers)
+                {
+                    manager.advanceTimers(now);
+                }
+            }
+
+            /**
+             * @brief Handle an event in every state machine.
+             * @param[in] event Event to handle.
+             * @return Number of state machines whose state changed.
+             */
+            template <typename Event>
+            size_t broadcast(Event event)
+            {
+                size_t changed = 0;
+                for (Manager & manager : managers)
+                {
+                    Event copy = event;
+                    changed += manager.handleEvent(std::move(copy)) ? 1 : 0;
+                }
+                return changed;
+            }
+
+            /**
+             * @brief Get a state machine.
+             * @param[in] index Index, below Count.
+             * @return Reference to the state manager.
+             */
+            Manager & operator[](size_t index) noexcept
+            {
+                return managers[index];
+            }
+
+            const Manager & operator[](size_t index) const noexcept
+            {
+                return managers[index];
+            }
+
+            /**
+             * @brief Get the number of state machines.
+             * @return Count.
+             */
+            static constexpr size_t size() noexcept
+            {
+                return Count;
+            }
+
+        private:
+            // Managers are not movable, each element is built in place
+            template <typename StateId, size_t... I>
+            StateMachineBank(StateId sId, std::index_sequence<I...>) : managers{{Manager(repeat<I>(sId))...}} {}
+
+            template <size_t I, typename StateId>
+            static constexpr StateId repeat(StateId sId)
+            {
+                return sId;
+            }
+
+            std::array<Manager, Count> managers;
+    };
+
+} // namespace StateMachine
@@ -10,8 +10,11 @@
 #include <memory>
 #include <atomic>
 #include "state.hpp"
+#include "state_ptr.hpp"
 #include "state_factory.hpp"
-#include "pico/critical_section.h"
+#include "transition_ring.hpp"
+#include "state_hierarchy.hpp"
+#include "timer_wheel.hpp"
 #include "pico/mutex.h"
 #include "lock_guard.hpp"
 
@@ -29,6 +32,16 @@ namespace StateMachine {
     template <typename StateId, typename Event, StateTransMatrix<StateId, Event> stateTransMatrix>
     class StateFactory;
 
+    /**
+     * @brief Number of transitions a state machine queues between run() calls. Specialize it for
+     *        a state machine to change it, must be a power of 2.
+     */
+    template <typename StateId, typename Event, StateTransMatrix<StateId, Event> stateTransMatrix>
+    struct TransitionQueueCapacity
+    {
+        static constexpr size_t value = 8;
+    };
+
     // equivalent to static mutex declaration + mutex_init()
     auto_init_mutex(createStateManagerMutex);
 
@@ -37,8 +50,20 @@ namespace StateMachine {
      * @brief Manages a finite state machine as a thread/ISR-safe leaky singleton.
      * 
      * The StateManager handles state transitions based on events, manages the current state, 
-     * and executes the state's behavior. The class is thread/ISR-safe and uses a critical 
-     * section for concurrent access to non-reentrant methods.
+     * and executes the state's behavior. Events are handled without locks from any thread, ISR
+     * or core: the state changes with a compare-and-swap in a TransitionRing.
+     * 
+     * Transitions are logged in order in the ring and replayed by run(), so every state passed
+     * through between two run() calls is entered and exited. If the ring is full the transition
+     * is still taken but counted as dropped, and run() skips to the latest state.
+     * 
+     * If StateHierarchyOf is specialized for the state machine, transitions also exit and enter
+     * the parent states below the least common ancestor of the source and target states, with
+     * the levels shared resolved at compile time. Only the current leaf state is run.
+     * 
+     * Timers in a TimerWheel post events when advanceTimers() moves them to their deadline. States
+     * entered arm their StateTimeoutsOf timeouts, and timers owned by a state are cancelled when
+     * it is exited.
      * 
      * Template parameters allow defining the sets of states, events, and state transitions.
      * It runs state-behavior folowing the state-machine design pattern.
@@ -59,9 +84,8 @@ namespace StateMachine {
              * @brief Private constructor to prevent multiple instances.
              * @param[in] sId Initial state id.
              */
-            StateManager(StateId sId) : currentStateId(sId)
+            StateManager(StateId sId) : transitions(sId)
             {
-                critical_section_init(&stateManagerLock);
                 // Create initial state object
                 state = StateFactory<StateId, Event, stateTransMatrix>::createState(sId, this);
             }
@@ -70,16 +94,96 @@ namespace StateMachine {
              * @brief Transitions to a new state.
              * @param[in] newState Unique pointer to the new state.
              */
-            void stateTransition(std::unique_ptr<State_> && newState)
+            void stateTransition(StatePtr<StateId, Event, stateTransMatrix> && newState)
             {
                 state = std::move(newState);
             }
 
+            /**
+             * @brief Exit the current state and enter a new one.
+             * @param[in] sId New state id.
+             */
+            void transitionTo(StateId sId)
+            {
+                StateId lastStateId = state->getStateId();
+                size_t shared = hierarchy.sharedLevels(lastStateId, sId);
+                // Exit current state, then its parents up to the least common ancestor
+                state->onExit();
+                timers.cancelOwned(lastStateId);
+                for (size_t level = hierarchy.level(lastStateId) - 1; level > shared; level--)
+                {
+                    StateId parentId = hierarchy.ancestor(lastStateId, level);
+                    callParent(parentId, &State_::onExit);
+                    timers.cancelOwned(parentId);
+                }
+                // Enter the parents of the new state below the least common ancestor
+                enterParents(sId, shared);
+                // Create new state
+                auto newState = StateFactory<StateId, Event, stateTransMatrix>::createState(sId, this);
+                // Transition to new state
+                stateTransition(std::move(newState));
+                // Enter new state
+                state->onEnter();
+                armTimeouts(sId);
+            }
+
+            /**
+             * @brief Enter the parents of a state, top down, below a level.
+             * @param[in] sId State id.
+             * @param[in] shared Levels already entered.
+             */
+            void enterParents(StateId sId, size_t shared)
+            {
+                for (size_t level = shared + 1; level < hierarchy.level(sId); level++)
+                {
+                    StateId parentId = hierarchy.ancestor(sId, level);
+                    callParent(parentId, &State_::onEnter);
+                    armTimeouts(parentId);
+                }
+            }
+
+            /**
+             * @brief Arm the timeouts of a state just entered, owned by it.
+             * @param[in] sId State id.
+             */
+            void armTimeouts(StateId sId)
+            {
+                for (const Timeout<StateId, Event> & timeout : timeouts)
+                {
+                    if (timeout.state == sId)
+                    {
+                        timers.armOwned(sId, timeout.event, timeout.ticks);
+                    }
+                }
+            }
+
+            void callParent(StateId sId, void (State_::*behavior)())
+            {
+                auto parent = StateFactory<StateId, Event, stateTransMatrix>::createState(sId, this);
+                if (parent != nullptr)
+                {
+                    ((*parent).*behavior)();
+                }
+            }
+
+            /**
+             * @brief Discard the queued transitions after an overflow and go to the current state.
+             */
+            void skipToCurrentState()
+            {
+                StateId sId = transitions.resynchronize();
+                if (sId != state->getStateId())
+                {
+                    transitionTo(sId);
+                }
+            }
+
+            static constexpr const auto & hierarchy = StateHierarchyOf<StateId, Event, stateTransMatrix>::value;
+            static constexpr auto timeouts = StateTimeoutsOf<StateId, Event, stateTransMatrix>::value;
             static StateManager * instance;
-            critical_section_t stateManagerLock;
-            StateId currentStateId;
-            std::unique_ptr<State_> state;
-            std::atomic_bool stateChanged = false;
+            StatePtr<StateId, Event, stateTransMatrix> state;
+            TransitionRing<StateId, TransitionQueueCapacity<StateId, Event, stateTransMatrix>::value> transitions;
+            TimerWheel<StateId, Event, TimerWheelCapacity<StateId, Event, stateTransMatrix>::value> timers;
             std::atomic_bool initialized = false;
 
         public:
@@ -106,16 +210,12 @@ namespace StateMachine {
             /**
              * @brief Handle an event and triggers a state transition if necessary.
              * @param[in] event Rvalue of event to handle.
+             * @return True if the state changed.
              */
-            virtual void handleEvent(Event && event)
+            virtual bool handleEvent(Event && event)
             {
-                auto lastStateId = currentStateId;
-                critical_section_enter_blocking(&stateManagerLock);
                 // Update the current state based on the event using the state transition matrix
-                currentStateId = stateTransMatrix(currentStateId, event);
-                critical_section_exit(&stateManagerLock);
-                // If state has changed
-                stateChanged = (lastStateId != currentStateId);
+                return transitions.take([&event](StateId sId) { return stateTransMatrix(sId, event); });
             }
 
             /**
@@ -124,38 +224,71 @@ namespace StateMachine {
              */
             void run()
             {
-                // If state has changed
-                if (stateChanged)
-                {
-                    // Exit current state
-                    state->onExit();
-                    // Create new state
-                    auto newState = StateFactory<StateId, Event, stateTransMatrix>::createState(currentStateId, this);
-                    // Transition to new state
-                    stateTransition(std::move(newState));
-                    // Enter new state
-                    state->onEnter();
-                    stateChanged = false;
-                }
-
                 // Enter initial state if not done yet
                 if(initialized == false)
                 {   
+                    enterParents(state->getStateId(), 0);
                     state->onEnter();
+                    armTimeouts(state->getStateId());
                     initialized = true;
                 }
 
+                // Replay the transitions since the last call, in order
+                StateId nextStateId;
+                while (transitions.pop(nextStateId))
+                {
+                    transitionTo(nextStateId);
+                }
+                if (transitions.isOverflowed())
+                {
+                    skipToCurrentState();
+                }
+
                 // Run current state
                 state->run();
             }
 
+            /**
+             * @brief Go back to a state, entered again by the next run(), dropping the queued
+             *        transitions and the timers. The current state is not exited. Not to be called
+             *        while events are handled or run() is called, e.g. to bring the singleton back
+             *        to a known state in tests.
+             * @param[in] sId State id to restart from.
+             */
+            void restart(StateId sId)
+            {
+                transitions.reset(sId);
+                timers.clear();
+                state = StateFactory<StateId, Event, stateTransMatrix>::createState(sId, this);
+                initialized = false;
+            }
+
+            /**
+             * @brief Post the events of the timers due, taken by the next run().
+             *        To be called from the run() context.
+             * @param[in] now Current tick of the TimerClock.
+             */
+            void advanceTimers(uint32_t now)
+            {
+                timers.advance(now, [this](Event event) { handleEvent(std::move(event)); });
+            }
+
+            /**
+             * @brief Get the timers, to arm and cancel them from the run() context.
+             * @return Reference to the timer wheel.
+             */
+            TimerWheel<StateId, Event, TimerWheelCapacity<StateId, Event, stateTransMatrix>::value> & getTimers() noexcept
+            {
+                return timers;
+            }
+
             /**
              * @brief Get the current state id.
              * @return Current state id.
              */
             StateId getCurrentStateId() const noexcept
             {
-                return currentStateId;
+                return transitions.current();
             }
 
             /**
@@ -167,14 +300,21 @@ namespace StateMachine {
                 return state->getStateId();
             }
 
+            /**
+             * @brief Get the number of transitions that did not fit in the queue, whose states
+             *        were skipped by run().
+             * @return Dropped transitions.
+             */
+            uint32_t getDroppedTransitions() const noexcept
+            {
+                return transitions.dropped();
+            }
+
             // Singleton shouldn't be cloneable nor assignable
             StateManager(const StateManager & obj) = delete;
             StateManager & operator=(const StateManager & obj) = delete;
 
-            virtual ~StateManager()
-            {
-                critical_section_deinit(&stateManagerLock);
-            }
+            virtual ~StateManager() {}
     };
 
     // Initialize static member
@@ -0,0 +1,52 @@
+/***********************************************************************
+ * @file	:	state_ptr.hpp
+ * @brief 	:	StatePtr type
+ *              Pointer to the state run by a state manager, owning or
+ *              not the state depending on where it is stored.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#pragma once
+#include <memory>
+
+namespace StateMachine {
+
+    // State transition matrix data type
+    template <typename StateId, typename Event>
+    using StateTransMatrix = StateId (*)(StateId, Event);
+
+    // State forward declaration
+    template <typename StateId, typename Event, StateTransMatrix<StateId, Event> stateTransMatrix>
+    class State;
+
+    /**
+     * @brief Deleter of state pointers, deleting heap allocated states only. States kept in static
+     *        storage, see StateSlab, are handed out with a non owning deleter.
+     */
+    struct StateDeleter
+    {
+        bool owned = true;
+
+        constexpr StateDeleter() noexcept = default;
+        constexpr explicit StateDeleter(bool owning) noexcept : owned(owning) {}
+
+        // States created with new, e.g. std::make_unique, are owned
+        template <typename T>
+        constexpr StateDeleter(const std::default_delete<T> &) noexcept : owned(true) {}
+
+        template <typename T>
+        void operator()(T * state) const
+        {
+            if (owned)
+            {
+                delete state;
+            }
+        }
+    };
+
+    // Pointer to the state run by a state manager
+    template <typename StateId, typename Event, StateTransMatrix<StateId, Event> stateTransMatrix>
+    using StatePtr = std::unique_ptr<State<StateId, Event, stateTransMatrix>, StateDeleter>;
+
+} // namespace StateMachine
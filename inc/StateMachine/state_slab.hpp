@@ -0,0 +1,84 @@
+/***********************************************************************
+ * @file	:	state_slab.hpp
+ * @brief 	:	StateSlab class
+ *              Static storage holding one instance of every state of a
+ *              state machine, built once and reused on transitions.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#pragma once
+#include <cstddef>
+#include <new>
+#include <tuple>
+#include "state.hpp"
+#include "state_ptr.hpp"
+
+namespace StateMachine {
+
+    /**
+     * @class StateSlab
+     * @brief Aligned slot per state type, where each state is constructed on first use. Factories
+     *        hand out the states with a non owning StatePtr, so transitions never touch the heap.
+     *
+     * @details
+     * States are built together on the first get() and never destroyed, so a state keeps its
+     * members from one activation to the next and should reset them in onEnter(). To be used from
+     * the context running the state machine.
+     *
+     * @tparam StateId Enum class representing the possible states.
+     * @tparam Event Enum class representing the events that trigger state transitions.
+     * @tparam stateTransMatrix State transition matrix function pointer.
+     * @tparam NumStates Number of state ids, StateId values must be below it.
+     * @tparam States State classes, constructible from a state manager pointer.
+     */
+    template <typename StateId, typename Event, StateTransMatrix<StateId, Event> stateTransMatrix, size_t NumStates,
+              typename... States>
+    class StateSlab
+    {
+        using State_ = State<StateId, Event, stateTransMatrix>;
+        using StateManager_ = StateManager<StateId, Event, stateTransMatrix>;
+
+        public:
+            /**
+             * @brief Get the state of an id, attached to a state manager.
+             * @param[in] sId State id.
+             * @param[in] sManager State manager.
+             * @return Non owning pointer to the state, nullptr if no state class has this id.
+             */
+            StatePtr<StateId, Event, stateTransMatrix> get(StateId sId, StateManager_ * sManager)
+            {
+                if (!built)
+                {
+                    std::apply([this, sManager](auto &... slot) { (place(slot, sManager), ...); }, slots);
+                    built = true;
+                }
+                size_t index = static_cast<size_t>(sId);
+                State_ * state = (index < NumStates) ? byId[index] : nullptr;
+                if (state != nullptr)
+                {
+                    state->setManager(sManager);
+                }
+                return StatePtr<StateId, Event, stateTransMatrix>(state, StateDeleter(false));
+            }
+
+        private:
+            template <typename S>
+            struct alignas(S) Slot
+            {
+                unsigned char bytes[sizeof(S)];
+            };
+
+            template <typename S>
+            void place(Slot<S> & slot, StateManager_ * sManager)
+            {
+                S * state = new (slot.bytes) S(sManager);
+                byId[static_cast<size_t>(state->getStateId())] = state;
+            }
+
+            std::tuple<Slot<States>...> slots;
+            State_ * byId[NumStates] = {};
+            bool built = false;
+    };
+
+} // namespace StateMachine
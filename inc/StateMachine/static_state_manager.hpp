@@ -0,0 +1,284 @@
+/***********************************************************************
+ * @file	:	static_state_manager.hpp
+ * @brief 	:	StaticStateManager class
+ *              Finite state machine over a fixed list of state types,
+ *              dispatching to them without virtual calls.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "state.hpp"
+#include "state_manager.hpp"
+#include "transition_ring.hpp"
+#include "timer_wheel.hpp"
+
+namespace StateMachine {
+
+    /**
+     * @class StaticStateManager
+     * @brief Manages a finite state machine whose states are known at compile time.
+     *
+     * Same handleEvent/run API as StateManager, but every state is a member and run(), onEnter()
+     * and onExit() are called on the concrete state type through a switch generated from the
+     * type list, so the compiler can inline state behavior into the control loop. States are
+     * built once with the manager and keep their members between activations, they should reset
+     * them in onEnter(). States are not attached to a StateManager, their manager is nullptr.
+     * Transitions are queued and replayed by run(), parent states exited and entered, and timers
+     * armed and cancelled, as in StateManager.
+     * handleEvent is lock-free and thread/ISR-safe, run is to be called in a loop from a single
+     * thread.
+     *
+     * @tparam StateId Enum class representing the possible states.
+     * @tparam Event Enum class representing the events that trigger state transitions.
+     * @tparam stateTransMatrix State transition matrix function pointer.
+     * @tparam NumStates Number of state ids, StateId values must be below it.
+     * @tparam States State classes, constructible from a state manager pointer.
+     */
+    template <typename StateId, typename Event, StateTransMatrix<StateId, Event> stateTransMatrix, size_t NumStates,
+              typename... States>
+    class StaticStateManager
+    {
+        using StateManager_ = StateManager<StateId, Event, stateTransMatrix>;
+
+        static_assert(sizeof...(States) > 0, "A state machine needs at least one state");
+        static_assert((std::is_base_of_v<State<StateId, Event, stateTransMatrix>, States> && ...),
+                      "States must derive from State");
+
+        public:
+            /**
+             * @brief Constructor.
+             * @param[in] sId Initial state id.
+             */
+            explicit StaticStateManager(StateId sId) : states(detached<States>()...), transitions(sId)
+            {
+                slotOf.fill(NO_STATE);
+                indexStates(std::index_sequence_for<States...>{});
+                performingStateId = sId;
+                performing = slot(sId);
+            }
+
+            /**
+             * @brief Handle an event and triggers a state transition if necessary.
+             * @param[in] event Rvalue of event to handle.
+             * @return True if the state changed.
+             */
+            bool handleEvent(Event && event)
+            {
+                // Update the current state based on the event using the state transition matrix
+                return transitions.take([&event](StateId sId) { return stateTransMatrix(sId, event); });
+            }
+
+            /**
+             * @brief Monitor state changes, enter, run and exit states.
+             *        To be called in a loop, from a single thread.
+             */
+            void run()
+            {
+                // Enter initial state if not done yet
+                if (initialized == false)
+                {
+                    enterParents(performingStateId, 0);
+                    dispatch(performing, Enter{});
+                    armTimeouts(performingStateId);
+                    initialized = true;
+                }
+
+                // Replay the transitions since the last call, in order
+                StateId nextStateId;
+                while (transitions.pop(nextStateId))
+                {
+                    transitionTo(nextStateId);
+                }
+                if (transitions.isOverflowed())
+                {
+                    skipToCurrentState();
+                }
+
+                // Run current state
+                dispatch(performing, Run{});
+            }
+
+            /**
+             * @brief Post the events of the timers due, taken by the next run().
+             *        To be called from the run() context.
+             * @param[in] now Current tick of the TimerClock.
+             */
+            void advanceTimers(uint32_t now)
+            {
+                timers.advance(now, [this](Event event) { handleEvent(std::move(event)); });
+            }
+
+            /**
+             * @brief Get the timers, to arm and cancel them from the run() context.
+             * @return Reference to the timer wheel.
+             */
+            TimerWheel<StateId, Event, TimerWheelCapacity<StateId, Event, stateTransMatrix>::value> & getTimers() noexcept
+            {
+                return timers;
+            }
+
+            /**
+             * @brief Get the current state id.
+             * @return Current state id.
+             */
+            StateId getCurrentStateId() const noexcept
+            {
+                return transitions.current();
+            }
+
+            /**
+             * @brief Get the performing state id.
+             * @return Performing state id.
+             */
+            StateId getPerformingStateId() const noexcept
+            {
+                return performingStateId;
+            }
+
+            /**
+             * @brief Get the number of transitions that did not fit in the queue, whose states
+             *        were skipped by run().
+             * @return Dropped transitions.
+             */
+            uint32_t getDroppedTransitions() const noexcept
+            {
+                return transitions.dropped();
+            }
+
+            /**
+             * @brief Get a state.
+             * @tparam S State class, one of States.
+             * @return Reference to the state.
+             */
+            template <typename S>
+            S & getState() noexcept
+            {
+                return std::get<S>(states);
+            }
+
+            StaticStateManager(const StaticStateManager & obj) = delete;
+            StaticStateManager & operator=(const StaticStateManager & obj) = delete;
+
+        private:
+            static constexpr size_t NO_STATE = sizeof...(States);
+            static constexpr const auto & hierarchy = StateHierarchyOf<StateId, Event, stateTransMatrix>::value;
+            static constexpr auto timeouts = StateTimeoutsOf<StateId, Event, stateTransMatrix>::value;
+
+            template <typename S>
+            static constexpr StateManager_ * detached()
+            {
+                return nullptr;
+            }
+
+            // Qualified calls on the concrete state type bypass the vtable
+            struct Enter
+            {
+                template <typename S>
+                void operator()(S & state) const { state.S::onEnter(); }
+            };
+
+            struct Run
+            {
+                template <typename S>
+                void operator()(S & state) const { state.S::run(); }
+            };
+
+            struct Exit
+            {
+                template <typename S>
+                void operator()(S & state) const { state.S::onExit(); }
+            };
+
+            template <size_t... I>
+            void indexStates(std::index_sequence<I...>)
+            {
+                ((slotOf[static_cast<size_t>(std::get<I>(states).getStateId())] = I), ...);
+            }
+
+            void transitionTo(StateId sId)
+            {
+                size_t shared = hierarchy.sharedLevels(performingStateId, sId);
+                dispatch(performing, Exit{});
+                timers.cancelOwned(performingStateId);
+                for (size_t level = hierarchy.level(performingStateId) - 1; level > shared; level--)
+                {
+                    StateId parentId = hierarchy.ancestor(performingStateId, level);
+                    dispatch(slot(parentId), Exit{});
+                    timers.cancelOwned(parentId);
+                }
+                enterParents(sId, shared);
+                performingStateId = sId;
+                performing = slot(sId);
+                dispatch(performing, Enter{});
+                armTimeouts(sId);
+            }
+
+            void enterParents(StateId sId, size_t shared)
+            {
+                for (size_t level = shared + 1; level < hierarchy.level(sId); level++)
+                {
+                    StateId parentId = hierarchy.ancestor(sId, level);
+                    dispatch(slot(parentId), Enter{});
+                    armTimeouts(parentId);
+                }
+            }
+
+            void armTimeouts(StateId sId)
+            {
+                for (const Timeout<StateId, Event> & timeout : timeouts)
+                {
+                    if (timeout.state == sId)
+                    {
+                        timers.armOwned(sId, timeout.event, timeout.ticks);
+                    }
+                }
+            }
+
+            void skipToCurrentState()
+            {
+                StateId sId = transitions.resynchronize();
+                if (sId != performingStateId)
+                {
+                    transitionTo(sId);
+                }
+            }
+
+            size_t slot(StateId sId) const noexcept
+            {
+                size_t index = static_cast<size_t>(sId);
+                return (index < NumStates) ? slotOf[index] : NO_STATE;
+            }
+
+            /**
+             * @brief Call f with the state in a slot, as a switch over the state types. Ids without
+             *        a state do nothing.
+             */
+            template <typename F>
+            void dispatch(size_t index, F f)
+            {
+                dispatch(index, f, std::index_sequence_for<States...>{});
+            }
+
+            template <typename F, size_t... I>
+            void dispatch(size_t index, F & f, std::index_sequence<I...>)
+            {
+                (void)((index == I && (f(std::get<I>(states)), true)) || ...);
+            }
+
+            std::tuple<States...> states;
+            std::array<size_t, NumStates> slotOf;
+            StateId performingStateId;
+            size_t performing;
+            TransitionRing<StateId, TransitionQueueCapacity<StateId, Event, stateTransMatrix>::value> transitions;
+            TimerWheel<StateId, Event, TimerWheelCapacity<StateId, Event, stateTransMatrix>::value> timers;
+            std::atomic_bool initialized = false;
+    };
+
+} // namespace StateMachine
@@ -0,0 +1,445 @@
+/***********************************************************************
+ * @file	:	timer_wheel.hpp
+ * @brief 	:	TimerWheel class
+ *              Hashed timer wheel posting events to a state machine,
+ *              driven by a single tick source.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace StateMachine {
+
+    // Type alias for the state transition matrix function
+    template <typename StateId, typename Event>
+    using StateTransMatrix = StateId (*)(StateId, Event);
+
+    /**
+     * @brief Handle of an armed timer. Handles of expired or cancelled timers are stale, cancelling
+     *        them does nothing.
+     */
+    struct TimerId
+    {
+        uint16_t index = 0xFFFF;
+        uint16_t generation = 0;
+
+        bool isValid() const noexcept
+        {
+            return index != 0xFFFF;
+        }
+    };
+
+    /**
+     * @brief Event posted when a state is not left before a timeout, counted from its entry.
+     */
+    template <typename StateId, typename Event>
+    struct Timeout
+    {
+        StateId state;
+        uint32_t ticks;
+        Event event;
+    };
+
+    /**
+     * @brief Timeouts the state managers of a state machine arm when entering a state. None unless
+     *        specialized for the state machine.
+     */
+    template <typename StateId, typename Event, StateTransMatrix<StateId, Event> stateTransMatrix>
+    struct StateTimeoutsOf
+    {
+        static constexpr std::span<const Timeout<StateId, Event>> value{};
+    };
+
+    /**
+     * @brief Number of timers a state manager can have armed at once. Specialize it for a state
+     *        machine to change it.
+     */
+    template <typename StateId, typename Event, StateTransMatrix<StateId, Event> stateTransMatrix>
+    struct TimerWheelCapacity
+    {
+        static constexpr size_t value = 16;
+    };
+
+    /**
+     * @class TimerClock
+     * @brief Tick count of a timer wheel. Advanced by one hardware alarm on target, tick() is
+     *        ISR-safe, or set by the tests as a virtual clock on the host.
+     */
+    class TimerClock
+    {
+        public:
+            /**
+             * @brief Count one tick, from the alarm interrupt.
+             */
+            void tick() noexcept
+            {
+                ticks.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            /**
+             * @brief Move the clock forward, as a virtual clock.
+             * @param[in] count Ticks elapsed.
+             */
+            void advance(uint32_t count) noexcept
+            {
+                ticks.fetch_add(count, std::memory_order_relaxed);
+            }
+
+            /**
+             * @brief Get the current tick.
+             * @return Ticks since start, wrapping around.
+             */
+            uint32_t now() const noexcept
+            {
+                return ticks.load(std::memory_order_relaxed);
+            }
+
+        private:
+            std::atomic<uint32_t> ticks = 0;
+    };
+
+    /**
+     * @class TimerWheel
+     * @brief One-shot and periodic timers in a fixed pool, hashed by deadline in a wheel of slots.
+     *
+     * @details
+     * Arming links a timer from the free list into the slot of its deadline, cancelling unlinks
+     * it, both in constant time with no heap use. advance() visits the slots of the ticks elapsed,
+     * at most one lap, and posts the event of every timer due, so deadlines further than a lap
+     * away cost one comparison per lap. Timers may have an owner state, the state managers cancel
+     * them when exiting it, with the timers of an owner linked in a bucket so they are found
+     * without scanning the pool.
+     *
+     * Not thread-safe: arm, cancel and advance from the state manager run() context. Events are
+     * posted through handleEvent, which any context may call.
+     *
+     * @tparam StateId Enum class representing the possible states.
+     * @tparam Event Enum class representing the events that trigger state transitions.
+     * @tparam Capacity Maximum number of armed timers.
+     * @tparam Slots Number of wheel slots, must be a power of 2.
+     */
+    template <typename StateId, typename Event, size_t Capacity, size_t Slots = 64>
+    class TimerWheel
+    {
+        static_assert(Capacity > 0 && Capacity < 0xFFFF, "Capacity must fit in a 16-bit index");
+        static_assert(Slots > 0 && (Slots & (Slots - 1)) == 0, "Slots must be a power of 2");
+
+        public:
+            TimerWheel() : current(0), armed(0)
+            {
+                for (uint16_t &head : slotHead)
+                {
+                    head = NIL;
+                }
+                for (uint16_t &head : ownerHead)
+                {
+                    head = NIL;
+                }
+                for (size_t i = 0; i < Capacity; i++)
+                {
+                    timers[i].next = (i + 1 < Capacity) ? static_cast<uint16_t>(i + 1) : NIL;
+                }
+                freeHead = 0;
+            }
+
+            TimerWheel(const TimerWheel & obj) = delete;
+            TimerWheel & operator=(const TimerWheel & obj) = delete;
+
+            /**
+             * @brief Arm a timer without owner.
+             * @param[in] event Event to post.
+             * @param[in] delay Ticks from now, at least 1.
+             * @param[in] period Ticks between repetitions, 0 for a one-shot timer.
+             * @return Handle, invalid if every timer is armed.
+             */
+            TimerId arm(Event event, uint32_t delay, uint32_t period = 0)
+            {
+                return arm(event, delay, period, false, StateId{});
+            }
+
+            /**
+             * @brief Arm a timer cancelled when its owner state is exited.
+             * @param[in] owner Owner state.
+             * @param[in] event Event to post.
+             * @param[in] delay Ticks from now, at least 1.
+             * @param[in] period Ticks between repetitions, 0 for a one-shot timer.
+             * @return Handle, invalid if every timer is armed.
+             */
+            TimerId armOwned(StateId owner, Event event, uint32_t delay, uint32_t period = 0)
+            {
+                return arm(event, delay, period, true, owner);
+            }
+
+            /**
+             * @brief Cancel a timer.
+             * @param[in] id Handle returned when arming it.
+             * @return False if the timer already expired or was cancelled.
+             */
+            bool cancel(TimerId id)
+            {
+                if (id.index >= Capacity || !timers[id.index].armed || timers[id.index].generation != id.generation)
+                {
+                    return false;
+                }
+                release(id.index);
+                return true;
+            }
+
+            /**
+             * @brief Cancel every timer of an owner state.
+             * @param[in] owner Owner state.
+             * @return Number of timers cancelled.
+             */
+            size_t cancelOwned(StateId owner)
+            {
+                size_t cancelled = 0;
+                uint16_t index = ownerHead[bucket(owner)];
+                while (index != NIL)
+                {
+                    uint16_t next = timers[index].ownerNext;
+                    if (timers[index].owner == owner)
+                    {
+                        release(index);
+                        cancelled++;
+                    }
+                    index = next;
+                }
+                return cancelled;
+            }
+
+            /**
+             * @brief Cancel every timer.
+             * @return Number of timers cancelled.
+             */
+            size_t clear()
+            {
+                size_t cancelled = 0;
+                for (uint16_t index = 0; index < Capacity; index++)
+                {
+                    if (timers[index].armed)
+                    {
+                        release(index);
+                        cancelled++;
+                    }
+                }
+                return cancelled;
+            }
+
+            /**
+             * @brief Move the wheel to a tick and post the events of the timers due.
+             * @param[in] now Current tick, less than 2^31 ticks after the previous one.
+             * @param[in] post Function taking the event of an expired timer, must not arm nor
+             *                 cancel timers.
+             * @return Number of events posted.
+             */
+            template <typename Post>
+            size_t advance(uint32_t now, Post && post)
+            {
+                uint32_t elapsed = now - current;
+                uint32_t steps = (elapsed < Slots) ? elapsed : static_cast<uint32_t>(Slots);
+                size_t posted = 0;
+                for (uint32_t step = 1; step <= steps; step++)
+                {
+                    uint16_t index = slotHead[(current + step) & MASK];
+                    while (index != NIL)
+                    {
+                        uint16_t next = timers[index].next;
+                        if (distance(timers[index].deadline, now) <= 0)
+                        {
+                            post(timers[index].event);
+                            posted++;
+                            expire(index, now);
+                        }
+                        index = next;
+                    }
+                }
+                current = now;
+                return posted;
+            }
+
+            /**
+             * @brief Get the tick the wheel was last advanced to.
+             * @return Current tick.
+             */
+            uint32_t now() const noexcept
+            {
+                return current;
+            }
+
+            /**
+             * @brief Get the number of armed timers.
+             * @return Armed timers.
+             */
+            size_t pending() const noexcept
+            {
+                return armed;
+            }
+
+            /**
+             * @brief Get the maximum number of armed timers.
+             * @return Capacity.
+             */
+            static constexpr size_t capacity() noexcept
+            {
+                return Capacity;
+            }
+
+        private:
+            static constexpr uint16_t NIL = 0xFFFF;
+            static constexpr uint32_t MASK = Slots - 1;
+            static constexpr size_t OWNER_BUCKETS = 16;
+
+            struct Timer
+            {
+                uint32_t deadline = 0;
+                uint32_t period = 0;
+                uint16_t generation = 0;
+                uint16_t prev = NIL;
+                uint16_t next = NIL;
+                uint16_t ownerPrev = NIL;
+                uint16_t ownerNext = NIL;
+                Event event{};
+                StateId owner{};
+                bool owned = false;
+                bool armed = false;
+            };
+
+            // Signed difference of two ticks
+            static constexpr int32_t distance(uint32_t a, uint32_t b)
+            {
+                return static_cast<int32_t>(a - b);
+            }
+
+            static constexpr size_t bucket(StateId owner)
+            {
+                return static_cast<size_t>(owner) & (OWNER_BUCKETS - 1);
+            }
+
+            TimerId arm(Event event, uint32_t delay, uint32_t period, bool owned, StateId owner)
+            {
+                if (freeHead == NIL)
+                {
+                    return TimerId{};
+                }
+                uint16_t index = freeHead;
+                Timer & timer = timers[index];
+                freeHead = timer.next;
+                timer.deadline = current + ((delay > 0) ? delay : 1);
+                timer.period = period;
+                timer.event = event;
+                timer.owner = owner;
+                timer.owned = owned;
+                timer.armed = true;
+                linkSlot(index);
+                if (owned)
+                {
+                    uint16_t & head = ownerHead[bucket(owner)];
+                    timer.ownerPrev = NIL;
+                    timer.ownerNext = head;
+                    if (head != NIL)
+                    {
+                        timers[head].ownerPrev = index;
+                    }
+                    head = index;
+                }
+                armed++;
+                return TimerId{index, timer.generation};
+            }
+
+            void linkSlot(uint16_t index)
+            {
+                Timer & timer = timers[index];
+                uint16_t & head = slotHead[timer.deadline & MASK];
+                timer.prev = NIL;
+                timer.next = head;
+                if (head != NIL)
+                {
+                    timers[head].prev = index;
+                }
+                head = index;
+            }
+
+            void unlinkSlot(uint16_t index)
+            {
+                Timer & timer = timers[index];
+                if (timer.prev != NIL)
+                {
+                    timers[timer.prev].next = timer.next;
+                }
+                else
+                {
+                    slotHead[timer.deadline & MASK] = timer.next;
+                }
+                if (timer.next != NIL)
+                {
+                    timers[timer.next].prev = timer.prev;
+                }
+            }
+
+            void unlinkOwner(uint16_t index)
+            {
+                Timer & timer = timers[index];
+                if (timer.ownerPrev != NIL)
+                {
+                    timers[timer.ownerPrev].ownerNext = timer.ownerNext;
+                }
+                else
+                {
+                    ownerHead[bucket(timer.owner)] = timer.ownerNext;
+                }
+                if (timer.ownerNext != NIL)
+                {
+                    timers[timer.ownerNext].ownerPrev = timer.ownerPrev;
+                }
+            }
+
+            /**
+             * @brief Rearm a periodic timer, skipping the periods already elapsed, or release it.
+             */
+            void expire(uint16_t index, uint32_t now)
+            {
+                Timer & timer = timers[index];
+                if (timer.period == 0)
+                {
+                    release(index);
+                    return;
+                }
+                unlinkSlot(index);
+                timer.deadline += timer.period;
+                if (distance(timer.deadline, now) <= 0)
+                {
+                    timer.deadline = now + timer.period;
+                }
+                linkSlot(index);
+            }
+
+            void release(uint16_t index)
+            {
+                Timer & timer = timers[index];
+                unlinkSlot(index);
+                if (timer.owned)
+                {
+                    unlinkOwner(index);
+                }
+                timer.armed = false;
+                // Handles of this activation become stale
+                timer.generation++;
+                timer.next = freeHead;
+                freeHead = index;
+                armed--;
+            }
+
+            Timer timers[Capacity];
+            uint16_t slotHead[Slots];
+            uint16_t ownerHead[OWNER_BUCKETS];
+            uint16_t freeHead;
+            uint32_t current;
+            size_t armed;
+    };
+
+} // namespace StateMachine
@@ -0,0 +1,230 @@
+/***********************************************************************
+ * @file	:	transition_ring.hpp
+ * @brief 	:	TransitionRing class
+ *              Lock-free current state of a state machine, with the
+ *              transitions taken kept in order for the consumer.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace StateMachine {
+
+    /**
+     * @class TransitionRing
+     * @brief Current state and ordered log of transitions, updated without locks.
+     *
+     * @details
+     * The current state and the number of transitions taken are packed in one 32-bit word,
+     * 8 bits of state id and 24 bits of sequence. Producers take a transition with a
+     * compare-and-swap on the word, which also gives the transition a ticket, its sequence. They
+     * then publish the new state in the ring slot of the ticket, so the consumer pops
+     * transitions in the order they were taken whatever the order producers publish in.
+     *
+     * Every slot is one atomic word too, holding a sequence and a state id: sequence t means the
+     * slot is free for ticket t, t + 1 that ticket t is published. A producer never waits: if its
+     * slot was not freed yet, the ring is full, the transition stays taken but is dropped from
+     * the log and the consumer resynchronizes to the current state.
+     *
+     * On the RP2350 Cortex-M33 cores the compare-and-swap compiles to a LDREX/STREX loop, which
+     * never masks interrupts.
+     *
+     * @tparam StateId Enum class representing the possible states, values below 256.
+     * @tparam Capacity Number of transitions kept, must be a power of 2.
+     */
+    template <typename StateId, size_t Capacity>
+    class TransitionRing
+    {
+        static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of 2");
+        static_assert(Capacity < (1u << 22), "Capacity must fit in the sequence");
+
+        public:
+            /**
+             * @brief Constructor.
+             * @param[in] sId Initial state id.
+             */
+            explicit TransitionRing(StateId sId) : word(pack(0, sId)), readNode(0)
+            {
+                for (uint32_t i = 0; i < Capacity; i++)
+                {
+                    slots[i].store(pack(i, sId), std::memory_order_relaxed);
+                }
+            }
+
+            // Shared words shouldn't be copied
+            TransitionRing(const TransitionRing & obj) = delete;
+            TransitionRing & operator=(const TransitionRing & obj) = delete;
+
+            /**
+             * @brief Take a transition from the current state. Wait-free of locks, safe from any
+             *        context, retries only if another producer took a transition meanwhile.
+             * @param[in] next Function giving the next state of a state.
+             * @return True if the state changed.
+             */
+            template <typename Next>
+            bool take(Next && next)
+            {
+                uint32_t current = word.load(std::memory_order_acquire);
+                uint32_t desired;
+                do
+                {
+                    StateId nextStateId = next(stateOf(current));
+                    if (nextStateId == stateOf(current))
+                    {
+                        return false;
+                    }
+                    desired = pack(sequenceOf(current) + 1, nextStateId);
+                }
+                while (!word.compare_exchange_weak(current, desired, std::memory_order_acq_rel, std::memory_order_acquire));
+
+                publish(sequenceOf(current), stateOf(desired));
+                return true;
+            }
+
+            /**
+             * @brief Get the current state, including transitions not popped yet.
+             * @return Current state id.
+             */
+            StateId current() const noexcept
+            {
+                return stateOf(word.load(std::memory_order_acquire));
+            }
+
+            /**
+             * @brief Pop the oldest transition. To be called from the consumer context only.
+             * @param[out] sId State transitioned to.
+             * @return False if there is none, or the oldest one is still being published.
+             */
+            bool pop(StateId & sId)
+            {
+                std::atomic<uint32_t> & slot = slots[readNode & MASK];
+                uint32_t value = slot.load(std::memory_order_acquire);
+                if (sequenceOf(value) != ((readNode + 1) & SEQUENCE_MASK))
+                {
+                    return false;
+                }
+                sId = stateOf(value);
+                // Free the slot for the ticket one lap ahead
+                slot.store(pack(readNode + Capacity, sId), std::memory_order_release);
+                readNode = (readNode + 1) & SEQUENCE_MASK;
+                return true;
+            }
+
+            /**
+             * @brief Check if transitions were dropped since the last resynchronize().
+             * @return True after an overflow.
+             */
+            bool isOverflowed() const noexcept
+            {
+                return overflowed.load(std::memory_order_acquire);
+            }
+
+            /**
+             * @brief Discard the log and free its slots after an overflow. To be called from the
+             *        consumer context only.
+             * @return Current state id, the state to skip to.
+             */
+            StateId resynchronize()
+            {
+                overflowed.store(false, std::memory_order_release);
+                const uint32_t snapshot = word.load(std::memory_order_acquire);
+                const uint32_t next = sequenceOf(snapshot);
+                // Only the last Capacity tickets share slots with the ones to come
+                uint32_t ticket = (distance(next, readNode) > static_cast<int32_t>(Capacity))
+                                      ? ((next - Capacity) & SEQUENCE_MASK) : readNode;
+                for (; ticket != next; ticket = (ticket + 1) & SEQUENCE_MASK)
+                {
+                    std::atomic<uint32_t> & slot = slots[ticket & MASK];
+                    const uint32_t free = (ticket + Capacity) & SEQUENCE_MASK;
+                    uint32_t value = slot.load(std::memory_order_acquire);
+                    // Leave slots already freed for a newer ticket, which may be in use
+                    while (distance(sequenceOf(value), free) < 0 &&
+                           !slot.compare_exchange_weak(value, pack(free, stateOf(value)), std::memory_order_acq_rel,
+                                                       std::memory_order_acquire)) {}
+                }
+                readNode = next;
+                return stateOf(snapshot);
+            }
+
+            /**
+             * @brief Restart from a state with an empty log, as constructed. Not to be called
+             *        while producers or the consumer use the ring.
+             * @param[in] sId State id to restart from.
+             */
+            void reset(StateId sId)
+            {
+                for (uint32_t i = 0; i < Capacity; i++)
+                {
+                    slots[i].store(pack(i, sId), std::memory_order_relaxed);
+                }
+                readNode = 0;
+                overflowed.store(false, std::memory_order_relaxed);
+                droppedTransitions.store(0, std::memory_order_relaxed);
+                word.store(pack(0, sId), std::memory_order_release);
+            }
+
+            /**
+             * @brief Get the number of transitions dropped from the log.
+             * @return Dropped transitions.
+             */
+            uint32_t dropped() const noexcept
+            {
+                return droppedTransitions.load(std::memory_order_relaxed);
+            }
+
+        private:
+            static constexpr uint32_t MASK = Capacity - 1;
+            static constexpr uint32_t SEQUENCE_MASK = 0xFFFFFF;
+
+            static constexpr uint32_t pack(uint32_t sequence, StateId sId)
+            {
+                return ((sequence & SEQUENCE_MASK) << 8) | static_cast<uint8_t>(sId);
+            }
+
+            static constexpr uint32_t sequenceOf(uint32_t value)
+            {
+                return value >> 8;
+            }
+
+            static constexpr StateId stateOf(uint32_t value)
+            {
+                return static_cast<StateId>(value & 0xFF);
+            }
+
+            // Signed difference of two sequences, modulo 2^24
+            static constexpr int32_t distance(uint32_t a, uint32_t b)
+            {
+                return static_cast<int32_t>((a - b) << 8) >> 8;
+            }
+
+            /**
+             * @brief Publish a transition in the slot of its ticket.
+             */
+            void publish(uint32_t ticket, StateId sId)
+            {
+                std::atomic<uint32_t> & slot = slots[ticket & MASK];
+                if (sequenceOf(slot.load(std::memory_order_acquire)) != ticket)
+                {
+                    // Slot not freed by the consumer yet
+                    droppedTransitions.fetch_add(1, std::memory_order_relaxed);
+                    overflowed.store(true, std::memory_order_release);
+                    return;
+                }
+                // The ticket is unique, only a concurrent resynchronize() may also write the slot.
+                // If this store overwrites the slot it freed, the next lap finds it full and the
+                // following resynchronize() frees it again.
+                slot.store(pack(ticket + 1, sId), std::memory_order_release);
+            }
+
+            std::atomic<uint32_t> word;
+            std::atomic<uint32_t> slots[Capacity];
+            uint32_t readNode;
+            std::atomic_bool overflowed = false;
+            std::atomic<uint32_t> droppedTransitions = 0;
+    };
+
+} // namespace StateMachine
@@ -0,0 +1,276 @@
+/***********************************************************************
+ * @file	:	transition_table.hpp
+ * @brief 	:	TransitionTable class
+ *              Dense state transition table built and validated at
+ *              compile time from a list of transitions.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#pragma once
+#include <array>
+#include <cstddef>
+
+namespace StateMachine {
+
+    /**
+     * @brief Transition from a state to another on an event.
+     */
+    template <typename StateId, typename Event>
+    struct Transition
+    {
+        StateId from;
+        Event event;
+        StateId to;
+    };
+
+    /**
+     * @class TransitionTable
+     * @brief Next state for every state and event, events without a transition leave the state
+     *        unchanged. Lookup is a single indexed load.
+     *
+     * @tparam StateId Enum class representing the possible states.
+     * @tparam Event Enum class representing the events that trigger state transitions.
+     * @tparam NumStates Number of states, StateId values must be below it.
+     * @tparam NumEvents Number of events, Event values must be below it.
+     */
+    template <typename StateId, typename Event, size_t NumStates, size_t NumEvents>
+    class TransitionTable
+    {
+        public:
+            /**
+             * @brief Build the table from a transition list.
+             * @param[in] transitions Transitions, with unique from and event pairs.
+             */
+            template <size_t N>
+            consteval explicit TransitionTable(const Transition<StateId, Event> (&transitions)[N]) : next{}
+            {
+                for (size_t s = 0; s < NumStates; s++)
+                {
+                    next[s].fill(static_cast<StateId>(s));
+                }
+                for (const Transition<StateId, Event> & transition : transitions)
+                {
+                    next[index(transition.from)][index(transition.event)] = transition.to;
+                }
+            }
+
+            /**
+             * @brief Build the table of a hierarchical state machine. Events a state has no
+             *        transition for bubble up to its closest ancestor that has one.
+             * @param[in] transitions Transitions, with unique from and event pairs.
+             * @param[in] hierarchy StateHierarchy of the states.
+             */
+            template <size_t N, typename Hierarchy>
+            consteval TransitionTable(const Transition<StateId, Event> (&transitions)[N], const Hierarchy & hierarchy)
+                : next{}
+            {
+                std::array<std::array<bool, NumEvents>, NumStates> handled{};
+                TransitionTable own{transitions};
+                for (const Transition<StateId, Event> & transition : transitions)
+                {
+                    handled[index(transition.from)][index(transition.event)] = true;
+                }
+                for (size_t s = 0; s < NumStates; s++)
+                {
+                    StateId state = static_cast<StateId>(s);
+                    for (size_t e = 0; e < NumEvents; e++)
+                    {
+                        next[s][e] = state;
+                        for (size_t l = hierarchy.level(state); l > 0; l--)
+                        {
+                            StateId handler = hierarchy.ancestor(state, l);
+                            if (handled[index(handler)][e])
+                            {
+                                next[s][e] = own(handler, static_cast<Event>(e));
+                                break;
+                            }
+                        }
+                    }
+                }
+            }
+
+            /**
+             * @brief Next state.
+             * @param[in] currentState Current state.
+             * @param[in] event Event.
+             * @return Next state, currentState if the event has no transition from it.
+             */
+            constexpr StateId operator()(StateId currentState, Event event) const
+            {
+                if (index(currentState) >= NumStates || index(event) >= NumEvents)
+                {
+                    return currentState;
+                }
+                return next[index(currentState)][index(event)];
+            }
+
+        private:
+            template <typename E>
+            static constexpr size_t index(E value)
+            {
+                return static_cast<size_t>(value);
+            }
+
+            std::array<std::array<StateId, NumEvents>, NumStates> next;
+    };
+
+    /**
+     * @brief Check at compile time that no state has two transitions on the same event.
+     * @param[in] transitions Transitions.
+     * @return True if all from and event pairs are unique.
+     */
+    template <typename StateId, typename Event, size_t N>
+    consteval bool hasUniqueTransitions(const Transition<StateId, Event> (&transitions)[N])
+    {
+        for (size_t i = 0; i < N; i++)
+        {
+            for (size_t j = i + 1; j < N; j++)
+            {
+                if (transitions[i].from == transitions[j].from && transitions[i].event == transitions[j].event)
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Check at compile time that transitions only involve the given states, e.g. the
+     *        states a factory can create.
+     * @param[in] transitions Transitions.
+     * @param[in] states States allowed.
+     * @return True if every state transitioned from or to is in states.
+     */
+    template <typename StateId, typename Event, size_t N, size_t M>
+    consteval bool usesOnlyStates(const Transition<StateId, Event> (&transitions)[N], const StateId (&states)[M])
+    {
+        auto contains = [&states](StateId state) {
+            for (StateId s : states)
+            {
+                if (s == state)
+                {
+                    return true;
+                }
+            }
+            return false;
+        };
+        for (const Transition<StateId, Event> & transition : transitions)
+        {
+            if (!contains(transition.from) || !contains(transition.to))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Check at compile time that transitions only target leaf states of a hierarchy.
+     * @param[in] transitions Transitions.
+     * @param[in] hierarchy StateHierarchy of the states.
+     * @return True if no transition enters a parent state.
+     */
+    template <typename StateId, typename Event, size_t N, typename Hierarchy>
+    consteval bool targetsLeaves(const Transition<StateId, Event> (&transitions)[N], const Hierarchy & hierarchy)
+    {
+        for (const Transition<StateId, Event> & transition : transitions)
+        {
+            if (!hierarchy.isLeaf(transition.to))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Check at compile time that every given state can be reached from the initial state.
+     * @param[in] transitions Transitions.
+     * @param[in] initial Initial state.
+     * @param[in] states States that must be reachable.
+     * @return True if no state in states is unreachable.
+     */
+    template <typename StateId, typename Event, size_t N, size_t M>
+    consteval bool reachesStates(const Transition<StateId, Event> (&transitions)[N], StateId initial,
+                                 const StateId (&states)[M])
+    {
+        // Fixed point over the transitions, at most one new state per pass
+        StateId reached[M + 1] = {initial};
+        size_t count = 1;
+        auto isReached = [&](StateId state) {
+            for (size_t i = 0; i < count; i++)
+            {
+                if (reached[i] == state)
+                {
+                    return true;
+                }
+            }
+            return false;
+        };
+        bool grown = true;
+        while (grown && count <= M)
+        {
+            grown = false;
+            for (const Transition<StateId, Event> & transition : transitions)
+            {
+                if (isReached(transition.from) && !isReached(transition.to) && count <= M)
+                {
+                    reached[count++] = transition.to;
+                    grown = true;
+                }
+            }
+        }
+        for (StateId state : states)
+        {
+            if (!isReached(state))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Check at compile time that every given state can be reached from the initial state
+     *        through a built table, e.g. one with transitions inherited from parent states.
+     * @param[in] table Transition table.
+     * @param[in] initial Initial state.
+     * @param[in] states States that must be reachable.
+     * @return True if no state in states is unreachable.
+     */
+    template <typename StateId, typename Event, size_t NumStates, size_t NumEvents, size_t M>
+    consteval bool reachesStates(const TransitionTable<StateId, Event, NumStates, NumEvents> & table, StateId initial,
+                                 const StateId (&states)[M])
+    {
+        bool reached[NumStates] = {};
+        reached[static_cast<size_t>(initial)] = true;
+        bool grown = true;
+        while (grown)
+        {
+            grown = false;
+            for (size_t s = 0; s < NumStates; s++)
+            {
+                for (size_t e = 0; reached[s] && e < NumEvents; e++)
+                {
+                    size_t to = static_cast<size_t>(table(static_cast<StateId>(s), static_cast<Event>(e)));
+                    if (to < NumStates && !reached[to])
+                    {
+                        reached[to] = true;
+                        grown = true;
+                    }
+                }
+            }
+        }
+        for (StateId state : states)
+        {
+            if (!reached[static_cast<size_t>(state)])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+} // namespace StateMachine
@@ -0,0 +1,161 @@
+/***********************************************************************
+ * @file	:	task_scheduler.hpp
+ * @brief 	:	Cooperative task scheduler
+ *              Fixed period tasks run in rate-monotonic order, with
+ *              idle work in between, and timing statistics per task.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+namespace Utilities {
+
+    constexpr size_t MAX_TASKS = 8;  // Periodic and idle tasks of a scheduler
+
+    using TaskFunction = void (*)(void * context);
+
+    /**
+     * @brief Timing statistics of a task, in us of time_us_32().
+     */
+    struct TaskStats
+    {
+        uint32_t runs = 0;
+        uint32_t overruns = 0;      // Releases passed before the task ended, skipped
+        uint32_t minUs = UINT32_MAX;
+        uint32_t maxUs = 0;
+        uint64_t totalUs = 0;
+        uint32_t maxJitterUs = 0;   // Latest start after a release
+        uint64_t totalJitterUs = 0;
+
+        uint32_t avgUs() const
+        {
+            return (runs > 0) ? static_cast<uint32_t>(totalUs / runs) : 0;
+        }
+
+        uint32_t avgJitterUs() const
+        {
+            return (runs > 0) ? static_cast<uint32_t>(totalJitterUs / runs) : 0;
+        }
+    };
+
+    /**
+     * @brief Words of a task statistics snapshot, TASK_STAT_WORDS words per task.
+     */
+    enum class TaskStatWord : uint16_t
+    {
+        Runs = 0,
+        Overruns,
+        MinUs,          // 0 before the first run
+        AvgUs,
+        MaxUs,
+        AvgJitterUs,
+        MaxJitterUs,
+        Count
+    };
+
+    constexpr size_t TASK_STAT_WORDS = static_cast<size_t>(TaskStatWord::Count);
+
+    /**
+     * @class TaskScheduler
+     * @brief Cooperative scheduler of the main loop.
+     *
+     * @details
+     * Periodic tasks are released every period from the time they are added and ordered by period,
+     * shortest first, as rate-monotonic priorities. Each step runs the highest priority task
+     * released, or the idle tasks if none is, so a long task delays the others but never
+     * preempts them. A task ending after its next release counts an overrun per release missed
+     * and skips them, keeping its phase.
+     * Time comes from time_us_32(), the simulated clock of the hardware mocks on the host. To be
+     * used from a single context.
+     */
+    class TaskScheduler
+    {
+        public:
+            /**
+             * @brief Add a periodic task.
+             * @param[in] function Task body.
+             * @param[in] context Argument of the task body.
+             * @param[in] periodUs Period, above 0.
+             * @return Task index, MAX_TASKS if there is no room.
+             */
+            size_t addTask(TaskFunction function, void * context, uint32_t periodUs);
+
+            /**
+             * @brief Add a task run when no periodic task is released.
+             * @param[in] function Task body.
+             * @param[in] context Argument of the task body.
+             * @return Task index, MAX_TASKS if there is no room.
+             */
+            size_t addIdleTask(TaskFunction function, void * context);
+
+            /**
+             * @brief Run the highest priority task released, or every idle task.
+             * @return True if a periodic task ran.
+             */
+            bool runOnce();
+
+            /**
+             * @brief Run tasks forever.
+             */
+            [[noreturn]] void run()
+            {
+                while (true)
+                {
+                    runOnce();
+                }
+            }
+
+            /**
+             * @brief Get the statistics of a task.
+             * @param[in] task Task index, as returned when adding it.
+             * @return Statistics.
+             */
+            const TaskStats & stats(size_t task) const
+            {
+                return tasks[task].stats;
+            }
+
+            /**
+             * @brief Read a word of the statistics snapshot.
+             * @param[in] index task * TASK_STAT_WORDS + TaskStatWord.
+             * @return Word value, 0 past the tasks added.
+             */
+            uint32_t word(size_t index) const;
+
+            /**
+             * @brief Restart the statistics of every task.
+             */
+            void resetStats();
+
+            /**
+             * @brief Get the number of tasks added.
+             * @return Task count.
+             */
+            size_t taskCount() const
+            {
+                return count;
+            }
+
+        private:
+            struct Task
+            {
+                TaskFunction function = nullptr;
+                void * context = nullptr;
+                uint32_t periodUs = 0;  // 0 for idle tasks
+                uint32_t releaseUs = 0;
+                TaskStats stats;
+            };
+
+            size_t add(TaskFunction function, void * context, uint32_t periodUs);
+            void execute(Task & task, uint32_t startUs);
+
+            Task tasks[MAX_TASKS];
+            uint8_t byPriority[MAX_TASKS] = {};  // Periodic tasks, shortest period first
+            size_t count = 0;
+            size_t periodicCount = 0;
+    };
+
+} // namespace Utilities
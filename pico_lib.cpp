@@ -1,33 +1,132 @@
 #include <stdio.h>
 #include "pico/stdlib.h"
+#include "pico/multicore.h"
 #include "hardware/timer.h"
 #include "fsm_state_manager.hpp"
-#include "i2c_slave.hpp"
+#include "joint_state_machine.hpp"
+#include "i2c_transport.hpp"
 #include "communication_handler.hpp"
+#include "core_link.hpp"
+#include "task_scheduler.hpp"
 
-int64_t alarm_callback(alarm_id_t id, void *user_data) {
-    // Put your timeout handler code in here
-    return 0;
+// Handle the bus interrupt and received messages on core1, leaving core0 to the control loop
+constexpr bool DUAL_CORE = false;
+
+// Stream the received messages to stdio as a binary trace, to be replayed with trace_replay
+constexpr bool RECORD_TRACE = false;
+
+static void writeTrace(const uint8_t * data, size_t length)
+{
+    fwrite(data, 1, length, stdout);
+    fflush(stdout);
 }
 
+// Ticks of the state machine timers, counted by a single repeating hardware alarm
+static StateMachine::TimerClock timerClock;
+
+static bool timerTick(repeating_timer_t * timer)
+{
+    timerClock.tick();
+    return true;
+}
+
+// Homing and fault handling of every joint, beside the arm state machine
+static StateMachine::RobotArm::Joint::JointBank joints(StateMachine::RobotArm::Joint::StateId::Unhomed);
+
+// UartTransport or SpiTransport can serve the same services over a faster bus.
+static Communication::Hardware::I2CTransport transport;
+
+// The state machines run at a fixed rate, messages are serviced in the time left
+constexpr uint32_t CONTROL_PERIOD_US = 1000;
 
+using ArmStateManager = StateMachine::StateManager<StateMachine::RobotArm::StateId, StateMachine::RobotArm::Event,
+                                                   StateMachine::RobotArm::stateTransMatrix>;
+
+static void controlTask(void * context)
+{
+    ArmStateManager * stateManager = static_cast<ArmStateManager *>(context);
+    // Timeouts due post their events, taken by run()
+    uint32_t now = timerClock.now();
+    stateManager->advanceTimers(now);
+    stateManager->run();
+    joints.advanceTimers(now);
+    joints.runAll();
+}
+
+// Program saved by core1 and the one run by the control loop
+struct ProgramDrain
+{
+    Communication::ProgramLink * link;
+    Robotics::Trajectory * program;
+};
+
+static void drainTask(void * context)
+{
+    ProgramDrain * drain = static_cast<ProgramDrain *>(context);
+    drain->link->drain(*drain->program);
+}
+
+static void serviceTask(void * context)
+{
+    // Publish the response to the handled messages ahead of the next master read
+    Communication::RobotArm::serviceTransport(transport);
+}
+
+static void communicationLoop()
+{
+    // The bus interrupt is enabled on the core starting the transport
+    Communication::RobotArm::startServices(transport, Communication::DispatchMode::Deferred);
+    while (true) {
+        Communication::RobotArm::serviceTransport(transport);
+    }
+}
 
 int main()
 {
     auto stateManager = StateMachine::RobotArm::FSMStateManager::getInstance();
     stateManager->handleEvent(StateMachine::RobotArm::Event::Done);
 
-    Communication::Hardware::I2CSlave::init(&Communication::RobotArm::rxCallback, 
-                                            &Communication::RobotArm::txCallback, 55, true);
-
     stdio_init_all();
 
-    // Timer example code - This example fires off the callback after 2000ms
-    add_alarm_in_ms(2000, alarm_callback, NULL, false);
-    // For more examples of timer use see https://github.com/raspberrypi/pico-examples/tree/master/timer
+    static uint8_t traceBuffer[512];
+    static Communication::TraceRecorder traceRecorder(traceBuffer, sizeof(traceBuffer), writeTrace);
+    if (RECORD_TRACE)
+    {
+        Communication::RobotArm::setTraceRecorder(&traceRecorder);
+    }
 
-    while (true) {
-        printf("Hello, world!\n");
-        sleep_ms(1000);
+    // Program run by the control loop. With DUAL_CORE, core1 saves into programLink and core0
+    // drains it into program, events reach the state manager lock-free.
+    auto program = std::make_shared<Robotics::Trajectory>();
+    auto programLink = std::make_shared<Communication::ProgramLink>();
+    if (DUAL_CORE)
+    {
+        Communication::RobotArm::installDataContainer(programLink);
+        multicore_launch_core1(communicationLoop);
+    }
+    else
+    {
+        // Received messages are handled from the main loop, not from the bus interrupt.
+        Communication::RobotArm::installDataContainer(program);
+        Communication::RobotArm::startServices(transport, Communication::DispatchMode::Deferred);
+    }
+
+    // Negative period, ticks are spaced from start to start whatever the callback duration
+    static repeating_timer_t timer;
+    add_repeating_timer_ms(-static_cast<int32_t>(StateMachine::RobotArm::TIMER_TICK_MS), timerTick, nullptr, &timer);
+
+    // Rate-monotonic cooperative loop, task timing is served on the diagnostic pages
+    static Utilities::TaskScheduler scheduler;
+    Communication::RobotArm::setTaskScheduler(&scheduler);
+    static ProgramDrain drain{programLink.get(), program.get()};
+    scheduler.addTask(controlTask, stateManager, CONTROL_PERIOD_US);
+    if (DUAL_CORE)
+    {
+        scheduler.addIdleTask(drainTask, &drain);
+    }
+    else
+    {
+        scheduler.addIdleTask(serviceTask, nullptr);
     }
+    scheduler.run();
 }
@@ -0,0 +1,9 @@
+#!/bin/zsh -x
+
+# if build directory doesn't exist, run build_unit_tests.sh
+if [ ! -d "tests/build" ]; then
+    ./build_unit_tests.sh
+fi
+
+# Run host benchmarks
+./tests/build/benchmarks "$@"
@@ -5,9 +5,22 @@ using namespace Communication;
 // Static member initialization
 RxHandler I2CSlave::rxHandler = nullptr;
 TxHandler I2CSlave::txHandler = nullptr;
-Queue<uint8_t> I2CSlave::rxBuffer;
+RxFrames I2CSlave::rxFrames;
+Frame * I2CSlave::rxFrame = nullptr;
+uint8_t I2CSlave::rxDiscard[BUFFER_SIZE];
 bool I2CSlave::txInProgress = false;
-bool I2CSlave::rxInProgress = false;
 RxDMA I2CSlave::dma;
+TxDMA I2CSlave::txDma;
 bool I2CSlave::dmaEnabled = false;
-uint8_t * I2CSlave::bufferFront = nullptr;
+bool I2CSlave::sniffIntegrity = false;
+DispatchMode I2CSlave::dispatchMode = DispatchMode::Immediate;
+volatile uint32_t I2CSlave::worstIsrUs = 0;
+uint32_t I2CSlave::transactionStartUs = 0;
+bool I2CSlave::transactionStarted = false;
+UrgentHandler I2CSlave::urgentHandler = nullptr;
+RxMessageId I2CSlave::urgentId = 0;
+bool I2CSlave::awaitingFirstByte = false;
+size_t I2CSlave::rxHeadLength = 0;
+
+ResponseBuffer<uint16_t> I2CSlave::responses;
+volatile uint32_t I2CSlave::txAbortCount = 0;
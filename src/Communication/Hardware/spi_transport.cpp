@@ -0,0 +1,94 @@
+#include "spi_transport.hpp"
+using namespace Communication::Hardware;
+using namespace Communication;
+
+// Static member initialization
+SpiTransport * SpiTransport::active = nullptr;
+
+// Clocked out when no response was published
+static const uint8_t idleResponse[BUFFER_SIZE] = {0};
+
+SpiTransport::SpiTransport(spi_inst_t * spi, uint rxPin, uint csPin, uint sckPin, uint txPin, uint baudRate)
+    : spi(spi), rxPin(rxPin), csPin(csPin), sckPin(sckPin), txPin(txPin), baudRate(baudRate),
+      txDma(DMA_SIZE_8), rxFrame(nullptr)
+{
+}
+
+void SpiTransport::start(RxHandler rxHandler, TxHandler txHandler, DispatchMode mode)
+{
+    PooledTransport::start(rxHandler, txHandler, mode);
+    active = this;
+
+    // Also enables the spi DMA requests
+    spi_init(spi, baudRate);
+    // CPHA 1 keeps chip select asserted for the whole frame
+    spi_set_format(spi, 8, SPI_CPOL_0, SPI_CPHA_1, SPI_MSB_FIRST);
+    spi_set_slave(spi, true);
+    gpio_set_function(rxPin, GPIO_FUNC_SPI);
+    gpio_set_function(csPin, GPIO_FUNC_SPI);
+    gpio_set_function(sckPin, GPIO_FUNC_SPI);
+    gpio_set_function(txPin, GPIO_FUNC_SPI);
+
+    channel_config_set_dreq(&rxDma.config, spi_get_dreq(spi, false));
+    dma_channel_configure(rxDma.channel, &rxDma.config, nullptr, &spi_get_hw(spi)->dr, 0, false);
+    channel_config_set_dreq(&txDma.config, spi_get_dreq(spi, true));
+    dma_channel_configure(txDma.channel, &txDma.config, &spi_get_hw(spi)->dr, nullptr, 0, false);
+
+    // Edges are detected whatever the pin function
+    gpio_set_irq_enabled_with_callback(csPin, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true, csIrqHandler);
+}
+
+bool SpiTransport::publishResponse(const uint8_t * data, size_t length)
+{
+    if (length == 0 || length > BUFFER_SIZE)
+    {
+        return false;
+    }
+    // The master clocks whole frames, pad so that no stale bytes are sent
+    uint8_t padded[BUFFER_SIZE] = {0};
+    memcpy(padded, data, length);
+    return responses.publish(padded, BUFFER_SIZE);
+}
+
+void SpiTransport::csIrqHandler(uint gpio, uint32_t events)
+{
+    if (active == nullptr || gpio != active->csPin)
+    {
+        return;
+    }
+    // Both edges may be latched when the interrupt is served late, end the frame first
+    if (events & GPIO_IRQ_EDGE_RISE)
+    {
+        active->transactionEnd();
+    }
+    if (events & GPIO_IRQ_EDGE_FALL)
+    {
+        active->transactionStart();
+    }
+}
+
+void SpiTransport::transactionStart()
+{
+    size_t length;
+    const uint8_t * response = responses.take(length);
+    txDma.send((response != nullptr) ? response : idleResponse, BUFFER_SIZE);
+
+    rxFrame = rxFrames.acquire();
+    if (rxFrame != nullptr)
+    {
+        rxDma.arm(rxFrame->data, BUFFER_SIZE);
+    }
+}
+
+void SpiTransport::transactionEnd()
+{
+    txDma.stop();
+    responses.finish();
+    if (rxFrame == nullptr)
+    {
+        return;
+    }
+    rxFrame->length = rxDma.disarm();
+    rxFrame = nullptr;
+    frameReceived();
+}
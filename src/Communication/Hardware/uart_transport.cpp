@@ -0,0 +1,85 @@
+#include "uart_transport.hpp"
+#include "comm_statistics.hpp"
+using namespace Communication::Hardware;
+using namespace Communication;
+
+// Longest transfer, the channel is re-armed once it is reached
+constexpr uint32_t RX_TRANSFER_COUNT = 0x0FFFFFFF;
+
+UartTransport::UartTransport(uart_inst_t * uart, uint txPin, uint rxPin, uint baudRate)
+    : uart(uart), txPin(txPin), rxPin(rxPin), baudRate(baudRate), txDma(DMA_SIZE_8), decoder(rxFrames), rxConsumed(0)
+{
+}
+
+void UartTransport::start(RxHandler rxHandler, TxHandler txHandler, DispatchMode mode)
+{
+    PooledTransport::start(rxHandler, txHandler, mode);
+
+    gpio_set_function(txPin, GPIO_FUNC_UART);
+    gpio_set_function(rxPin, GPIO_FUNC_UART);
+    // Also enables the uart DMA requests
+    uart_init(uart, baudRate);
+
+    // Receive endlessly into the ring
+    channel_config_set_dreq(&rxDma.config, uart_get_dreq(uart, false));
+    dma_channel_configure(rxDma.channel, &rxDma.config, rxRing, &uart_get_hw(uart)->dr, 0, false);
+    rxDma.enableRing(UART_RX_RING_BITS);
+    rxDma.arm(rxRing, RX_TRANSFER_COUNT);
+    rxConsumed = 0;
+    decoder.reset();
+
+    channel_config_set_dreq(&txDma.config, uart_get_dreq(uart, true));
+    dma_channel_configure(txDma.channel, &txDma.config, &uart_get_hw(uart)->dr, nullptr, 0, false);
+}
+
+size_t UartTransport::pump(size_t budget)
+{
+    drainRing();
+    return PooledTransport::pump(budget);
+}
+
+void UartTransport::drainRing()
+{
+    constexpr size_t mask = UART_RX_RING_SIZE - 1;
+    size_t received = rxDma.received();
+    // The DMA went around the ring over bytes not decoded yet, the frame in progress is lost
+    if (received - rxConsumed > UART_RX_RING_SIZE)
+    {
+        commStatistics.ringOverruns.increment();
+        decoder.reset();
+        rxConsumed = received;
+    }
+    while (rxConsumed != received)
+    {
+        if (decoder.feed(rxRing[rxConsumed & mask]))
+        {
+            frameReceived();
+        }
+        rxConsumed++;
+        if ((rxConsumed & mask) == 0)
+        {
+            commStatistics.ringWraps.increment();
+        }
+    }
+    // Bytes arriving while re-arming stay in the uart FIFO
+    if (!rxDma.isBusy())
+    {
+        rxDma.arm(rxRing, RX_TRANSFER_COUNT);
+        rxConsumed = 0;
+    }
+}
+
+bool UartTransport::publishResponse(const uint8_t * data, size_t length)
+{
+    if (txDma.isBusy())
+    {
+        return false;
+    }
+    size_t streamLength = encodeStreamFrame(data, length, txBuffer);
+    if (streamLength == 0)
+    {
+        return false;
+    }
+    txDma.send(txBuffer, streamLength);
+    return true;
+}
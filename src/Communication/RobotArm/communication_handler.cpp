@@ -1,6 +1,11 @@
 #include "communication_handler.hpp"
 #include "fsm_state_manager.hpp"
 #include "reset.hpp"
+#include "emergency_stop.hpp"
+#include "waypoint_codec.hpp"
+#include "hardware/timer.h"
+#include <algorithm>
+#include <cstring>
 
 namespace Communication{
 namespace RobotArm{
@@ -13,74 +18,431 @@ namespace RobotArm{
     static std::shared_ptr<Robotics::Trajectory> programData{nullptr};
     auto stateManager = FSMStateManager::getInstance();
 
-    void emergencyStopCallback(const uint8_t * msgData, const size_t dataLength)
+    static void saveProgramRecords(const uint8_t * data, size_t length)
     {
+        if (programData != nullptr)
+        {
+            programData->saveWaypoints(data, length);
+        }
+    }
+
+    static SegmentedReceiver programReceiver(saveProgramRecords, sizeof(Robotics::Waypoint_t),
+                                             PROGRAM_BLOCK_SIZE, PROGRAM_SEPARATION_TIME,
+                                             MAX_PROGRAM_WAYPOINTS * sizeof(Robotics::Waypoint_t));
+
+    // Scale header of the quantized or compressed program being received, ahead of its waypoints
+    static Robotics::WaypointScale_t programScale;
+    static size_t programScaleLength = 0;
+
+    /**
+     * @brief Take the part of the program scale header at the beginning of the data, and set the
+     *        scale once the header is complete.
+     * @return Number of bytes taken.
+     */
+    static size_t takeProgramScale(const uint8_t * data, size_t length)
+    {
+        if (programScaleLength == sizeof(Robotics::WaypointScale_t))
+        {
+            return 0;
+        }
+        size_t count = std::min(length, sizeof(Robotics::WaypointScale_t) - programScaleLength);
+        memcpy(reinterpret_cast<uint8_t *>(&programScale) + programScaleLength, data, count);
+        programScaleLength += count;
+        if (programScaleLength == sizeof(Robotics::WaypointScale_t) && programData != nullptr)
+        {
+            programData->setScale(programScale);
+        }
+        return count;
+    }
+
+    static void saveQuantizedRecords(const uint8_t * data, size_t length)
+    {
+        size_t header = takeProgramScale(data, length);
+        if (length > header && programData != nullptr)
+        {
+            programData->saveQuantizedWaypoints(data + header, length - header);
+        }
+    }
+
+    static void saveDecodedWaypoints(const Robotics::QuantizedWaypoint_t * waypoints, size_t count)
+    {
+        if (programData != nullptr)
+        {
+            programData->saveQuantizedWaypoints(reinterpret_cast<const uint8_t *>(waypoints),
+                                                count * sizeof(Robotics::QuantizedWaypoint_t));
+        }
+    }
+
+    static Robotics::WaypointDecoder programDecoder(saveDecodedWaypoints);
+
+    static void saveCompressedRecords(const uint8_t * data, size_t length)
+    {
+        size_t header = takeProgramScale(data, length);
+        programDecoder.decode(data + header, length - header);
+    }
+
+    static SegmentedReceiver quantizedReceiver(saveQuantizedRecords, sizeof(Robotics::QuantizedWaypoint_t),
+                                               PROGRAM_BLOCK_SIZE, PROGRAM_SEPARATION_TIME,
+                                               sizeof(Robotics::WaypointScale_t) +
+                                                   MAX_PROGRAM_WAYPOINTS * sizeof(Robotics::QuantizedWaypoint_t));
+    // Stream bytes are records of one byte, forwarded as they arrive
+    static SegmentedReceiver compressedReceiver(saveCompressedRecords, 1, PROGRAM_BLOCK_SIZE, PROGRAM_SEPARATION_TIME,
+                                                sizeof(Robotics::WaypointScale_t) +
+                                                    MAX_PROGRAM_WAYPOINTS * Robotics::MAX_ENCODED_WAYPOINT);
+
+    // Receiver of the last program frame, whose flow control is served
+    static SegmentedReceiver * activeReceiver = &programReceiver;
+    static size_t txIndex = 0;
+
+    // Statistics page to respond with, until the next message
+    constexpr int NO_PAGE = -1;
+    static int diagnosticPage = NO_PAGE;
+    static ITransport * servedTransport = nullptr;
+
+    // Requests with a transaction id, reported while the last message was one of them
+    static TransactionTable<TRANSACTION_SLOTS> transactions;
+    static bool transactionResponse = false;
+
+    static TraceRecorder * traceRecorder = nullptr;
+
+    static const Utilities::TaskScheduler * taskScheduler = nullptr;
+
+    /**
+     * @brief Hand an event to the state machine.
+     * @return ConditionsNotCorrect if the state the machine is heading to ignores the event.
+     */
+    static ResponseCode requestEvent(Event event)
+    {
+        // The transition is taken and checked at once, another context may post events meanwhile
+        return stateManager->handleEvent(std::move(event)) ? ResponseCode::Positive : ResponseCode::ConditionsNotCorrect;
+    }
+
+    /**
+     * @brief Check if a program can be loaded, also right after a LOAD request handled in the
+     *        same batch, before the state machine has entered LoadProgram.
+     */
+    static bool loadingProgram()
+    {
+        return stateManager->getPerformingStateId() == StateId::LoadProgram ||
+               stateManager->getCurrentStateId() == StateId::LoadProgram;
+    }
+
+    ResponseCode emergencyStopCallback(const uint8_t * msgData, const size_t dataLength)
+    {
+        // Already triggered from the receive interrupt on transports that recognise it
+        Motor::EmergencyStopLatch::trigger();
         stateManager->handleEvent(Event::EmergencyStop);
+        // Motors are stopped whatever the state
+        return ResponseCode::Positive;
     }
 
-    void cancelOperationCallback(const uint8_t * msgData, const size_t dataLength)
+    ResponseCode cancelOperationCallback(const uint8_t * msgData, const size_t dataLength)
     {
-        stateManager->handleEvent(Event::Cancel);
+        return requestEvent(Event::Cancel);
     }
 
-    void loadProgramCallback(const uint8_t * msgData, const size_t dataLength)
+    ResponseCode loadProgramCallback(const uint8_t * msgData, const size_t dataLength)
     {
-        stateManager->handleEvent(Event::Load);
+        return requestEvent(Event::Load);
     }
 
-    void programDataCallback(const uint8_t * msgData, const size_t dataLength)
+    ResponseCode programDataCallback(const uint8_t * msgData, const size_t dataLength)
     {
-        if (stateManager->getPerformingStateId() == StateId::LoadProgram)
+        if (!loadingProgram() || programData == nullptr)
         {
-            if (programData != nullptr && msgData != nullptr && dataLength > 0)
-            {
-                    programData->saveWaypoints(msgData, dataLength);
-            }
+            return ResponseCode::ConditionsNotCorrect;
+        }
+        if (msgData == nullptr || dataLength == 0)
+        {
+            return ResponseCode::IncorrectMessageLength;
         }
+        programData->saveWaypoints(msgData, dataLength);
+        return ResponseCode::Positive;
     }
 
-    void teachProgramCallback(const uint8_t * msgData, const size_t dataLength)
+    ResponseCode teachProgramCallback(const uint8_t * msgData, const size_t dataLength)
     {
-        stateManager->handleEvent(Event::Teach);
+        return requestEvent(Event::Teach);
     }
 
-    void startProgramCallback(const uint8_t * msgData, const size_t dataLength)
+    ResponseCode startProgramCallback(const uint8_t * msgData, const size_t dataLength)
     {
-        stateManager->handleEvent(Event::Start);
+        return requestEvent(Event::Start);
     }
 
-    void pauseProgramCallback(const uint8_t * msgData, const size_t dataLength)
+    ResponseCode pauseProgramCallback(const uint8_t * msgData, const size_t dataLength)
     {
-        stateManager->handleEvent(Event::Pause);
+        return requestEvent(Event::Pause);
     }
 
-    void resumeProgramCallback(const uint8_t * msgData, const size_t dataLength)
+    ResponseCode resumeProgramCallback(const uint8_t * msgData, const size_t dataLength)
     {
-        stateManager->handleEvent(Event::Resume);
+        return requestEvent(Event::Resume);
     }
 
-    void resetCallback(const uint8_t * msgData, const size_t dataLength)
+    ResponseCode resetCallback(const uint8_t * msgData, const size_t dataLength)
     {
         Utilities::reset();
+        return ResponseCode::Positive;
+    }
+
+    /**
+     * @brief Feed a frame of a segmented program to its receiver.
+     * @param[in] intact Check of the data forwarded so far, nullptr if any data is valid. A
+     *            failed check aborts the transfer.
+     * @return Pending until the transfer completes, the requests carrying the earlier frames
+     *         are resolved with the outcome of the transfer.
+     */
+    static ResponseCode receiveProgram(SegmentedReceiver & receiver, RxIds id, const uint8_t * msgData, const size_t dataLength,
+                                       bool (*intact)() = nullptr)
+    {
+        activeReceiver = &receiver;
+        if (!loadingProgram())
+        {
+            receiver.reset();
+            transactions.resolve(RAW(id), ResponseCode::ConditionsNotCorrect);
+            return ResponseCode::ConditionsNotCorrect;
+        }
+        TransferStatus lastStatus = receiver.getStatus();
+        TransferStatus status = receiver.receive(msgData, dataLength);
+        if ((status == TransferStatus::InProgress || status == TransferStatus::Complete) && intact != nullptr && !intact())
+        {
+            receiver.reset();
+            status = TransferStatus::Malformed;
+        }
+        switch (status)
+        {
+            case TransferStatus::Complete:
+                // Whole program received
+                if (lastStatus != TransferStatus::Complete)
+                {
+                    stateManager->handleEvent(Event::ProgramLoaded);
+                }
+                // The requests carrying the earlier frames complete with the transfer
+                transactions.resolve(RAW(id), ResponseCode::Positive);
+                return ResponseCode::Positive;
+            case TransferStatus::InProgress:
+                return ResponseCode::Pending;
+            case TransferStatus::WrongSequence:
+                transactions.resolve(RAW(id), ResponseCode::RequestSequenceError);
+                return ResponseCode::RequestSequenceError;
+            case TransferStatus::Overflow:
+                transactions.resolve(RAW(id), ResponseCode::RequestOutOfRange);
+                return ResponseCode::RequestOutOfRange;
+            default:
+                transactions.resolve(RAW(id), ResponseCode::IncorrectMessageLength);
+                return ResponseCode::IncorrectMessageLength;
+        }
+    }
+
+    ResponseCode programSegmentCallback(const uint8_t * msgData, const size_t dataLength)
+    {
+        return receiveProgram(programReceiver, RxIds::PROGRAM_SEGMENT, msgData, dataLength);
     }
 
-    void rxCallback(RxMessageId msgId, size_t dataLength, uint8_t * msgData)
+    ResponseCode quantizedProgramCallback(const uint8_t * msgData, const size_t dataLength)
     {
-        // If message ID exist in messageDictionary
-        if (messageDictionary.count(msgId) == 1)
+        // A first frame starts a new program, with its own scale header
+        if (msgData != nullptr && dataLength > 0 && (msgData[0] >> 4) == static_cast<uint8_t>(SegmentType::First))
         {
-            // If message handler exists
-            if (messageDictionary.at(msgId) != nullptr)
+            programScaleLength = 0;
+        }
+        return receiveProgram(quantizedReceiver, RxIds::PROGRAM_QUANTIZED, msgData, dataLength);
+    }
+
+    ResponseCode compressedProgramCallback(const uint8_t * msgData, const size_t dataLength)
+    {
+        if (msgData != nullptr && dataLength > 0 && (msgData[0] >> 4) == static_cast<uint8_t>(SegmentType::First))
+        {
+            programScaleLength = 0;
+            programDecoder.reset();
+        }
+        // The stream must decode, and end on a whole waypoint
+        return receiveProgram(compressedReceiver, RxIds::PROGRAM_COMPRESSED, msgData, dataLength, []() {
+            return !programDecoder.isMalformed() &&
+                   (compressedReceiver.getStatus() != TransferStatus::Complete || programDecoder.atWaypointBoundary());
+        });
+    }
+
+    ResponseCode diagnosticsCallback(const uint8_t * msgData, const size_t dataLength)
+    {
+        uint8_t page = (msgData != nullptr && dataLength > 0) ? msgData[0] : 0;
+        if (page == DIAGNOSTIC_RESET_PAGE)
+        {
+            commStatistics.reset();
+            page = 0;
+        }
+        diagnosticPage = page;
+        return ResponseCode::Positive;
+    }
+
+    /**
+     * @brief Read a word of the diagnostic pages, 0 between the communication and task statistics.
+     */
+    static uint32_t getDiagnosticWord(size_t index, uint32_t dropped, uint32_t corrupted)
+    {
+        constexpr size_t firstTaskWord = DIAGNOSTIC_TASK_PAGE * DIAGNOSTIC_PAGE_WORDS;
+        if (index < static_cast<size_t>(StatWord::Count))
+        {
+            return commStatistics.word(index, dropped, corrupted);
+        }
+        if (index >= firstTaskWord && taskScheduler != nullptr)
+        {
+            return taskScheduler->word(index - firstTaskWord);
+        }
+        return 0;
+    }
+
+    /**
+     * @brief Serialize a page of the statistics snapshot.
+     * @return Response length.
+     */
+    static size_t getDiagnosticPage(uint8_t * msgData, uint8_t page)
+    {
+        uint32_t dropped = (servedTransport != nullptr) ? servedTransport->droppedFrames() : 0;
+        uint32_t corrupted = (servedTransport != nullptr) ? servedTransport->corruptedFrames() : 0;
+        size_t first = static_cast<size_t>(page) * DIAGNOSTIC_PAGE_WORDS;
+        size_t count = 0;
+        if (first < DIAGNOSTIC_WORDS)
+        {
+            count = std::min(DIAGNOSTIC_PAGE_WORDS, DIAGNOSTIC_WORDS - first);
+        }
+        msgData[0] = RAW(RxIds::DIAGNOSTICS);
+        msgData[1] = page;
+        uint8_t * out = msgData + DIAGNOSTIC_HEADER_SIZE;
+        for (size_t i = 0; i < count; i++)
+        {
+            uint32_t value = getDiagnosticWord(first + i, dropped, corrupted);
+            for (size_t j = 0; j < sizeof(uint32_t); j++)
             {
-                // Call message handler
-                messageDictionary.at(msgId)(msgData, dataLength);
+                *out++ = static_cast<uint8_t>(value >> (8 * j));
             }
         }
+        return DIAGNOSTIC_HEADER_SIZE + count * sizeof(uint32_t);
+    }
+
+    void rxCallback(RxMessageId msgId, size_t dataLength, const uint8_t * msgData)
+    {
+        if (traceRecorder != nullptr)
+        {
+            traceRecorder->record(time_us_32(), msgId, msgData, dataLength);
+        }
+
+        // Next read starts a new response
+        txIndex = 0;
+        diagnosticPage = NO_PAGE;
+        transactionResponse = (msgId & TRANSACTION_FLAG) != 0;
+        msgId &= ~TRANSACTION_FLAG;
+        commStatistics.messages[msgId].increment();
+
+        // The transaction id comes first
+        uint8_t transactionId = 0;
+        if (transactionResponse)
+        {
+            if (dataLength == 0)
+            {
+                transactions.complete(msgId, transactionId, ResponseCode::IncorrectMessageLength);
+                return;
+            }
+            transactionId = msgData[0];
+            msgData++;
+            dataLength--;
+        }
+
+        // Unregistered message ids have no handler
+        ResponseCode code = ResponseCode::ServiceNotSupported;
+        Callback callback = messageDictionary[msgId];
+        if (callback != nullptr)
+        {
+            // Call message handler
+            code = callback(msgData, dataLength);
+        }
+        else
+        {
+            commStatistics.unknownIds.increment();
+        }
+
+        if (transactionResponse)
+        {
+            transactions.complete(msgId, transactionId, code);
+        }
     }
 
     void txCallback(uint8_t *msgData)
     {
-        *msgData = 0x07;
+        uint8_t response[BUFFER_SIZE];
+        size_t length = getResponse(response);
+        *msgData = response[txIndex % length];
+        txIndex++;
+    }
+
+    size_t getResponse(uint8_t * msgData)
+    {
+        if (diagnosticPage != NO_PAGE)
+        {
+            return getDiagnosticPage(msgData, static_cast<uint8_t>(diagnosticPage));
+        }
+        if (transactionResponse)
+        {
+            return transactions.serialize(msgData, BUFFER_SIZE - integritySize(FRAME_INTEGRITY));
+        }
+        if (activeReceiver->getStatus() == TransferStatus::Idle)
+        {
+            msgData[0] = 0x07;
+            return 1;
+        }
+        return activeReceiver->flowControl(msgData);
+    }
+
+    void startServices(ITransport & transport, DispatchMode mode)
+    {
+        servedTransport = &transport;
+        transport.start(rxCallback, txCallback, mode);
+        transport.setIntegrity(FRAME_INTEGRITY);
+        transport.setUrgentHandler(RAW(RxIds::EMERGENCY_STOP), Motor::EmergencyStopLatch::trigger);
+    }
+
+    void stopServices()
+    {
+        if (servedTransport != nullptr)
+        {
+            servedTransport->setUrgentHandler(RAW(RxIds::EMERGENCY_STOP), nullptr);
+            servedTransport = nullptr;
+        }
+        // Transfers in progress are dropped, the next response is the regular one
+        programReceiver.reset();
+        quantizedReceiver.reset();
+        compressedReceiver.reset();
+        programDecoder.reset();
+        programScaleLength = 0;
+        activeReceiver = &programReceiver;
+        txIndex = 0;
+        diagnosticPage = NO_PAGE;
+        transactions.clear();
+        transactionResponse = false;
+    }
+
+    size_t serviceTransport(ITransport & transport, size_t budget)
+    {
+        size_t handled = transport.pump(budget);
+        if (handled > 0)
+        {
+            uint8_t response[BUFFER_SIZE];
+            size_t length = getResponse(response);
+            length = appendIntegrity(FRAME_INTEGRITY, response, length);
+            transport.publishResponse(response, length);
+        }
+        return handled;
+    }
+
+    void setTraceRecorder(TraceRecorder * recorder)
+    {
+        traceRecorder = recorder;
+    }
+
+    void setTaskScheduler(const Utilities::TaskScheduler * scheduler)
+    {
+        taskScheduler = scheduler;
     }
 
     void installDataContainer(std::shared_ptr<Robotics::Trajectory> via_points)
@@ -0,0 +1,55 @@
+#include "comm_statistics.hpp"
+using namespace Communication;
+
+CommStatistics Communication::commStatistics;
+
+constexpr size_t TRANSACTION_LATENCY = static_cast<size_t>(StatWord::TransactionLatency);
+constexpr size_t ISR_DURATION = static_cast<size_t>(StatWord::IsrDuration);
+constexpr size_t MESSAGE_COUNTS = static_cast<size_t>(StatWord::MessageCounts);
+constexpr size_t WORD_COUNT = static_cast<size_t>(StatWord::Count);
+
+uint32_t CommStatistics::word(size_t index, uint32_t dropped, uint32_t corrupted) const
+{
+    if (index >= WORD_COUNT)
+    {
+        return 0;
+    }
+    if (index >= MESSAGE_COUNTS)
+    {
+        return messages[index - MESSAGE_COUNTS].get();
+    }
+    if (index >= ISR_DURATION)
+    {
+        return isrDuration.count(index - ISR_DURATION);
+    }
+    if (index >= TRANSACTION_LATENCY)
+    {
+        return transactionLatency.count(index - TRANSACTION_LATENCY);
+    }
+    switch (static_cast<StatWord>(index))
+    {
+        case StatWord::Frames: return frames.get();
+        case StatWord::UnknownIds: return unknownIds.get();
+        case StatWord::DroppedFrames: return dropped;
+        case StatWord::CorruptedFrames: return corrupted;
+        case StatWord::PendingHighWatermark: return pendingFrames.get();
+        case StatWord::RingWraps: return ringWraps.get();
+        case StatWord::RingOverruns: return ringOverruns.get();
+        default: return 0;
+    }
+}
+
+void CommStatistics::reset()
+{
+    frames.reset();
+    unknownIds.reset();
+    ringWraps.reset();
+    ringOverruns.reset();
+    pendingFrames.reset();
+    transactionLatency.reset();
+    isrDuration.reset();
+    for (StatCounter & counter : messages)
+    {
+        counter.reset();
+    }
+}
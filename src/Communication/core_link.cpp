@@ -0,0 +1,74 @@
+#include "core_link.hpp"
+#include "pico/platform.h"
+#include <cstring>
+using namespace Communication;
+
+void ProgramLink::saveWaypoints(const uint8_t * rawWaypoints, const size_t size)
+{
+    forward(ChunkKind::Waypoints, rawWaypoints, size, sizeof(Robotics::Waypoint_t));
+}
+
+void ProgramLink::setScale(const Robotics::WaypointScale_t & scale)
+{
+    forward(ChunkKind::Scale, reinterpret_cast<const uint8_t *>(&scale), sizeof(scale), sizeof(scale));
+}
+
+void ProgramLink::saveQuantizedWaypoints(const uint8_t * rawWaypoints, const size_t size)
+{
+    forward(ChunkKind::QuantizedWaypoints, rawWaypoints, size, sizeof(Robotics::QuantizedWaypoint_t));
+}
+
+void ProgramLink::forward(ChunkKind kind, const uint8_t * data, size_t size, size_t recordSize)
+{
+    // Chunks hold whole records only
+    const size_t chunkSize = CORE_LINK_CHUNK_SIZE - (CORE_LINK_CHUNK_SIZE % recordSize);
+    size_t offset = 0;
+    while (offset + recordSize <= size)
+    {
+        ProgramChunk chunk;
+        chunk.kind = kind;
+        size_t length = size - offset;
+        length = (length < chunkSize) ? length - (length % recordSize) : chunkSize;
+        chunk.length = static_cast<uint8_t>(length);
+        memcpy(chunk.data, data + offset, length);
+        offset += length;
+        if (!chunks.push(chunk))
+        {
+            stallCount.fetch_add(1, std::memory_order_relaxed);
+            while (!chunks.push(chunk))
+            {
+                tight_loop_contents();
+            }
+        }
+    }
+}
+
+size_t ProgramLink::drain(Robotics::Trajectory & trajectory, size_t budget)
+{
+    size_t applied = 0;
+    ProgramChunk * chunk;
+    while (applied < budget && (chunk = chunks.front()) != nullptr)
+    {
+        switch (chunk->kind)
+        {
+            case ChunkKind::Waypoints:
+                trajectory.saveWaypoints(chunk->data, chunk->length);
+                break;
+            case ChunkKind::QuantizedWaypoints:
+                trajectory.saveQuantizedWaypoints(chunk->data, chunk->length);
+                break;
+            case ChunkKind::Scale:
+            {
+                Robotics::WaypointScale_t scale;
+                memcpy(&scale, chunk->data, sizeof(scale));
+                trajectory.setScale(scale);
+                break;
+            }
+        }
+        // The slot is only given back once applied
+        ProgramChunk done;
+        chunks.pop(done);
+        applied++;
+    }
+    return applied;
+}
@@ -0,0 +1,182 @@
+#include "segmented_transfer.hpp"
+#include <cstring>
+using namespace Communication;
+
+constexpr uint8_t SEQUENCE_MASK = 0x0F;
+
+static inline uint8_t pci(SegmentType type, uint8_t low)
+{
+    return static_cast<uint8_t>((static_cast<uint8_t>(type) << 4) | (low & 0x0F));
+}
+
+SegmentedReceiver::SegmentedReceiver(SegmentSink sink, size_t recordSize, uint8_t blockSize, uint8_t separationTime, uint32_t maxLength)
+    : sink(sink), recordSize(recordSize), blockSize(blockSize), separationTime(separationTime), maxLength(maxLength)
+{
+    if (this->recordSize == 0 || this->recordSize > MAX_RECORD_SIZE)
+    {
+        this->recordSize = 1;
+    }
+    reset();
+}
+
+void SegmentedReceiver::reset()
+{
+    status = TransferStatus::Idle;
+    total = 0;
+    received = 0;
+    duplicates = 0;
+    expectedSequence = 1;
+    carryLength = 0;
+}
+
+TransferStatus SegmentedReceiver::receive(const uint8_t * payload, size_t length)
+{
+    if (payload == nullptr || length == 0)
+    {
+        return status;
+    }
+
+    switch (static_cast<SegmentType>(payload[0] >> 4))
+    {
+        case SegmentType::First:
+        {
+            if (length < FIRST_FRAME_HEADER)
+            {
+                status = TransferStatus::Malformed;
+                return status;
+            }
+            // A first frame always starts a new transfer
+            reset();
+            total = (static_cast<uint32_t>(payload[1]) << 24) | (static_cast<uint32_t>(payload[2]) << 16) |
+                    (static_cast<uint32_t>(payload[3]) << 8) | static_cast<uint32_t>(payload[4]);
+            if (total == 0 || total > maxLength || total % recordSize != 0)
+            {
+                status = TransferStatus::Overflow;
+                return status;
+            }
+            status = TransferStatus::InProgress;
+            consume(payload + FIRST_FRAME_HEADER, length - FIRST_FRAME_HEADER);
+            break;
+        }
+        case SegmentType::Consecutive:
+        {
+            // Only accepted while a transfer is in progress
+            if (status != TransferStatus::InProgress)
+            {
+                return status;
+            }
+            uint8_t sequence = payload[0] & SEQUENCE_MASK;
+            if (sequence == ((expectedSequence - 1) & SEQUENCE_MASK))
+            {
+                // Repeated frame, already consumed
+                duplicates++;
+                return status;
+            }
+            if (sequence != expectedSequence)
+            {
+                status = TransferStatus::WrongSequence;
+                return status;
+            }
+            expectedSequence = (expectedSequence + 1) & SEQUENCE_MASK;
+            consume(payload + CONSECUTIVE_FRAME_HEADER, length - CONSECUTIVE_FRAME_HEADER);
+            break;
+        }
+        default:
+            status = TransferStatus::Malformed;
+            return status;
+    }
+
+    if (status == TransferStatus::InProgress && received == total)
+    {
+        status = TransferStatus::Complete;
+    }
+    return status;
+}
+
+void SegmentedReceiver::consume(const uint8_t * data, size_t length)
+{
+    if (length > total - received)
+    {
+        status = TransferStatus::Overflow;
+        return;
+    }
+    received += length;
+
+    // Complete the record split across the previous frame
+    if (carryLength > 0)
+    {
+        size_t missing = recordSize - carryLength;
+        size_t count = (length < missing) ? length : missing;
+        memcpy(carry + carryLength, data, count);
+        carryLength += count;
+        data += count;
+        length -= count;
+        if (carryLength == recordSize)
+        {
+            sink(carry, recordSize);
+            carryLength = 0;
+        }
+    }
+
+    // Forward whole records straight from the frame
+    size_t whole = length - (length % recordSize);
+    if (whole > 0)
+    {
+        sink(data, whole);
+    }
+
+    // Keep the beginning of the next record
+    memcpy(carry + carryLength, data + whole, length - whole);
+    carryLength += length - whole;
+}
+
+size_t SegmentedReceiver::flowControl(uint8_t * frame) const
+{
+    bool aborted = (status == TransferStatus::WrongSequence || status == TransferStatus::Overflow ||
+                    status == TransferStatus::Malformed);
+    FlowStatus flowStatus = aborted ? FlowStatus::Overflow : FlowStatus::ContinueToSend;
+    frame[0] = pci(SegmentType::FlowControl, static_cast<uint8_t>(flowStatus));
+    frame[1] = blockSize;
+    frame[2] = separationTime;
+    return FLOW_CONTROL_SIZE;
+}
+
+SegmentedSender::SegmentedSender(RxMessageId msgId, const uint8_t * data, uint32_t length)
+    : msgId(msgId), data(data), length(length), sent(0), sequence(1), started(false)
+{
+}
+
+size_t SegmentedSender::nextFrame(uint8_t * frame)
+{
+    size_t header;
+    frame[0] = msgId;
+    if (!started)
+    {
+        frame[1] = pci(SegmentType::First, 0);
+        frame[2] = static_cast<uint8_t>(length >> 24);
+        frame[3] = static_cast<uint8_t>(length >> 16);
+        frame[4] = static_cast<uint8_t>(length >> 8);
+        frame[5] = static_cast<uint8_t>(length);
+        header = 1 + FIRST_FRAME_HEADER;
+        started = true;
+    }
+    else if (sent < length)
+    {
+        frame[1] = pci(SegmentType::Consecutive, sequence);
+        sequence = (sequence + 1) & SEQUENCE_MASK;
+        header = 1 + CONSECUTIVE_FRAME_HEADER;
+    }
+    else
+    {
+        return 0;
+    }
+
+    size_t count = BUFFER_SIZE - header;
+    if (count > length - sent)
+    {
+        count = length - sent;
+    }
+    memcpy(frame + header, data + sent, count);
+    sent += count;
+    return header + count;
+}
@@ -0,0 +1,42 @@
+#include "emergency_stop.hpp"
+#include "hardware/timer.h"
+using namespace Motor;
+
+// Static member initialization
+IMotor * EmergencyStopLatch::motors[MAX_STOP_MOTORS] = {nullptr};
+std::atomic<size_t> EmergencyStopLatch::motorCount{0};
+std::atomic<bool> EmergencyStopLatch::latched{false};
+volatile uint32_t EmergencyStopLatch::latchedAtUs = 0;
+
+bool EmergencyStopLatch::registerMotor(IMotor * motor)
+{
+    size_t count = motorCount.load(std::memory_order_relaxed);
+    if (motor == nullptr || count >= MAX_STOP_MOTORS)
+    {
+        return false;
+    }
+    motors[count] = motor;
+    // The motor is visible to trigger() once the count is
+    motorCount.store(count + 1, std::memory_order_release);
+    return true;
+}
+
+void EmergencyStopLatch::trigger()
+{
+    if (!latched.exchange(true, std::memory_order_acq_rel))
+    {
+        latchedAtUs = time_us_32();
+    }
+    size_t count = motorCount.load(std::memory_order_acquire);
+    for (size_t i = 0; i < count; i++)
+    {
+        motors[i]->disable();
+    }
+}
+
+void EmergencyStopLatch::reset()
+{
+    motorCount.store(0, std::memory_order_relaxed);
+    latched.store(false, std::memory_order_release);
+    latchedAtUs = 0;
+}
@@ -6,6 +6,12 @@ Waypoint_t Trajectory::getNextWaypoint()
 {
     if (waypoints.empty())
     {
+        if (!quantizedWaypoints.empty())
+        {
+            QuantizedWaypoint_t qwp = quantizedWaypoints.front();
+            quantizedWaypoints.pop_front();
+            return dequantize(qwp, scale);
+        }
         return Waypoint_t();
     }
     Waypoint_t wp = waypoints.front();
@@ -15,7 +21,7 @@ Waypoint_t Trajectory::getNextWaypoint()
 
 bool Trajectory::isTrajectoryComplete()
 {
-    return waypoints.empty();
+    return waypoints.empty() && quantizedWaypoints.empty();
 }
 
 void Trajectory::saveWaypoints(const uint8_t * rawWaypoints, const size_t size)
@@ -39,12 +45,31 @@ void Trajectory::saveWaypoints(const Waypoint_t * waypoints, const size_t size)
     }
 }
 
+void Trajectory::setScale(const WaypointScale_t & scale)
+{
+    this->scale = scale;
+}
+
+void Trajectory::saveQuantizedWaypoints(const uint8_t * rawWaypoints, const size_t size)
+{
+    size_t wpSize = sizeof(QuantizedWaypoint_t);
+
+    for (size_t i = 0; i + wpSize <= size; i += wpSize)
+    {
+        QuantizedWaypoint_t qwp;
+        memcpy(&qwp, rawWaypoints + i, wpSize);
+        quantizedWaypoints.push_back(qwp);
+    }
+}
+
 void Trajectory::clearWaypoints()
 {
     waypoints.clear();
+    quantizedWaypoints.clear();
+    scale = coordinateScale();
 }
 
 size_t Trajectory::numOfWaypoints()
 {
-    return waypoints.size();
+    return waypoints.size() + quantizedWaypoints.size();
 }
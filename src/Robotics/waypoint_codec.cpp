@@ -0,0 +1,104 @@
+#include "waypoint_codec.hpp"
+using namespace Robotics;
+
+constexpr uint8_t VARINT_CONTINUE = 0x80;
+constexpr uint8_t VARINT_MASK = 0x7F;
+
+static inline uint32_t zigzag(int32_t value)
+{
+    return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+static inline int32_t unzigzag(uint32_t value)
+{
+    return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+}
+
+WaypointEncoder::WaypointEncoder()
+{
+    reset();
+}
+
+void WaypointEncoder::reset()
+{
+    previous = {};
+}
+
+size_t WaypointEncoder::encode(const QuantizedWaypoint_t & waypoint, uint8_t * out)
+{
+    uint8_t * cursor = out;
+    for (size_t i = 0; i < NUM_JOINTS; i++)
+    {
+        uint32_t value = zigzag(static_cast<int32_t>(waypoint.q[i]) - previous.q[i]);
+        while (value > VARINT_MASK)
+        {
+            *cursor++ = static_cast<uint8_t>(value) | VARINT_CONTINUE;
+            value >>= 7;
+        }
+        *cursor++ = static_cast<uint8_t>(value);
+    }
+    previous = waypoint;
+    return static_cast<size_t>(cursor - out);
+}
+
+WaypointDecoder::WaypointDecoder(WaypointSink sink) : sink(sink)
+{
+    reset();
+}
+
+void WaypointDecoder::reset()
+{
+    current = {};
+    batchLength = 0;
+    joint = 0;
+    value = 0;
+    shift = 0;
+    decoded = 0;
+    malformed = false;
+}
+
+bool WaypointDecoder::decode(const uint8_t * data, size_t length)
+{
+    for (size_t i = 0; i < length && !malformed; i++)
+    {
+        uint8_t group = data[i];
+        value |= static_cast<uint32_t>(group & VARINT_MASK) << shift;
+        shift += 7;
+        if ((group & VARINT_CONTINUE) != 0)
+        {
+            malformed = shift >= 7 * MAX_VARINT_BYTES;
+            continue;
+        }
+
+        int32_t jointValue = current.q[joint] + unzigzag(value);
+        if (jointValue < QUANTIZED_MIN || jointValue > QUANTIZED_MAX)
+        {
+            malformed = true;
+            break;
+        }
+        current.q[joint] = static_cast<int16_t>(jointValue);
+        value = 0;
+        shift = 0;
+        if (++joint == NUM_JOINTS)
+        {
+            joint = 0;
+            decoded++;
+            batch[batchLength++] = current;
+            if (batchLength == DECODE_BATCH)
+            {
+                flush();
+            }
+        }
+    }
+    flush();
+    return !malformed;
+}
+
+void WaypointDecoder::flush()
+{
+    if (batchLength > 0)
+    {
+        sink(batch, batchLength);
+        batchLength = 0;
+    }
+}
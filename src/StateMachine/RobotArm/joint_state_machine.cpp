@@ -0,0 +1,68 @@
+#include "joint_state_machine.hpp"
+using namespace StateMachine::RobotArm::Joint::States;
+using namespace StateMachine::RobotArm::Joint;
+
+StateId StateMachine::RobotArm::Joint::stateTransMatrix(StateId currentState, Event event)
+{
+    return transitionTable(currentState, event);
+}
+
+void Unhomed::run()
+{
+    // Do something
+}
+
+void Unhomed::onEnter()
+{
+    // Do something
+}
+
+void Unhomed::onExit()
+{
+    // Do something
+}
+
+void Homing::run()
+{
+    // Do something
+}
+
+void Homing::onEnter()
+{
+    // Do something
+}
+
+void Homing::onExit()
+{
+    // Do something
+}
+
+void Homed::run()
+{
+    // Do something
+}
+
+void Homed::onEnter()
+{
+    // Do something
+}
+
+void Homed::onExit()
+{
+    // Do something
+}
+
+void Fault::run()
+{
+    // Do something
+}
+
+void Fault::onEnter()
+{
+    // Do something
+}
+
+void Fault::onExit()
+{
+    // Do something
+}
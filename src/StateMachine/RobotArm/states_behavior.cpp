@@ -1,4 +1,5 @@
 #include "states_behavior.hpp"
+#include "emergency_stop.hpp"
 using namespace StateMachine::RobotArm::States;
 
 void Init::run()
@@ -128,10 +129,71 @@ void EmergencyStop::run()
 
 void EmergencyStop::onEnter()
 {
-    // Do something
+    // Motors may already be disabled by the emergency stop message
+    Motor::EmergencyStopLatch::trigger();
 }
 
 void EmergencyStop::onExit()
 {
     // Do something
-}
\ No newline at end of file
+}
+
+void Operational::run()
+{
+    // Parent states are not run
+}
+
+void Operational::onEnter()
+{
+    // Do something
+}
+
+void Operational::onExit()
+{
+    // Do something
+}
+
+void Idle::run()
+{
+    // Parent states are not run
+}
+
+void Idle::onEnter()
+{
+    // Do something
+}
+
+void Idle::onExit()
+{
+    // Do something
+}
+
+void Programming::run()
+{
+    // Parent states are not run
+}
+
+void Programming::onEnter()
+{
+    // Do something
+}
+
+void Programming::onExit()
+{
+    // Do something
+}
+
+void Running::run()
+{
+    // Parent states are not run
+}
+
+void Running::onEnter()
+{
+    // Do something
+}
+
+void Running::onExit()
+{
+    // Do something
+}
@@ -0,0 +1,137 @@
+#include "task_scheduler.hpp"
+#include "hardware/timer.h"
+using namespace Utilities;
+
+// Signed difference of two times
+static inline int32_t distance(uint32_t a, uint32_t b)
+{
+    return static_cast<int32_t>(a - b);
+}
+
+size_t TaskScheduler::addTask(TaskFunction function, void * context, uint32_t periodUs)
+{
+    if (periodUs == 0)
+    {
+        return MAX_TASKS;
+    }
+    return add(function, context, periodUs);
+}
+
+size_t TaskScheduler::addIdleTask(TaskFunction function, void * context)
+{
+    return add(function, context, 0);
+}
+
+size_t TaskScheduler::add(TaskFunction function, void * context, uint32_t periodUs)
+{
+    if (function == nullptr || count >= MAX_TASKS)
+    {
+        return MAX_TASKS;
+    }
+    size_t index = count++;
+    Task & task = tasks[index];
+    task.function = function;
+    task.context = context;
+    task.periodUs = periodUs;
+    task.releaseUs = time_us_32();
+    task.stats = TaskStats{};
+    if (periodUs > 0)
+    {
+        // Insert by period, after the tasks of the same period
+        size_t position = periodicCount++;
+        while (position > 0 && tasks[byPriority[position - 1]].periodUs > periodUs)
+        {
+            byPriority[position] = byPriority[position - 1];
+            position--;
+        }
+        byPriority[position] = static_cast<uint8_t>(index);
+    }
+    return index;
+}
+
+bool TaskScheduler::runOnce()
+{
+    uint32_t now = time_us_32();
+    for (size_t i = 0; i < periodicCount; i++)
+    {
+        Task & task = tasks[byPriority[i]];
+        if (distance(now, task.releaseUs) < 0)
+        {
+            continue;
+        }
+        TaskStats & stats = task.stats;
+        uint32_t jitter = now - task.releaseUs;
+        stats.totalJitterUs += jitter;
+        if (jitter > stats.maxJitterUs)
+        {
+            stats.maxJitterUs = jitter;
+        }
+        execute(task, now);
+
+        // Next release, skipping the ones already missed
+        task.releaseUs += task.periodUs;
+        uint32_t end = time_us_32();
+        if (distance(end, task.releaseUs) > 0)
+        {
+            // Releases before the end, the one at the end is still due
+            uint32_t missed = (end - task.releaseUs - 1) / task.periodUs + 1;
+            stats.overruns += missed;
+            task.releaseUs += missed * task.periodUs;
+        }
+        return true;
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        if (tasks[i].periodUs == 0)
+        {
+            execute(tasks[i], time_us_32());
+        }
+    }
+    return false;
+}
+
+void TaskScheduler::execute(Task & task, uint32_t startUs)
+{
+    task.function(task.context);
+    uint32_t duration = time_us_32() - startUs;
+    TaskStats & stats = task.stats;
+    stats.runs++;
+    stats.totalUs += duration;
+    if (duration < stats.minUs)
+    {
+        stats.minUs = duration;
+    }
+    if (duration > stats.maxUs)
+    {
+        stats.maxUs = duration;
+    }
+}
+
+uint32_t TaskScheduler::word(size_t index) const
+{
+    size_t task = index / TASK_STAT_WORDS;
+    if (task >= count)
+    {
+        return 0;
+    }
+    const TaskStats & stats = tasks[task].stats;
+    switch (static_cast<TaskStatWord>(index % TASK_STAT_WORDS))
+    {
+        case TaskStatWord::Runs: return stats.runs;
+        case TaskStatWord::Overruns: return stats.overruns;
+        case TaskStatWord::MinUs: return (stats.runs > 0) ? stats.minUs : 0;
+        case TaskStatWord::AvgUs: return stats.avgUs();
+        case TaskStatWord::MaxUs: return stats.maxUs;
+        case TaskStatWord::AvgJitterUs: return stats.avgJitterUs();
+        case TaskStatWord::MaxJitterUs: return stats.maxJitterUs;
+        default: return 0;
+    }
+}
+
+void TaskScheduler::resetStats()
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        tasks[i].stats = TaskStats{};
+    }
+}
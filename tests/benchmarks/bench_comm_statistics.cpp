@@ -0,0 +1,82 @@
+/***********************************************************************
+ * @file	:	bench_comm_statistics.cpp
+ * @brief 	:	Benchmarks for the communication statistics block.
+ *              Cost of the updates done per interrupt and per frame,
+ *              against the atomic read-modify-write they replace.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#include "comm_statistics.hpp"
+#include "communication_handler.hpp"
+#include <benchmark/benchmark.h>
+
+using namespace Communication;
+
+namespace Benchmarks {
+
+    static CommStatistics stats;
+
+    /**
+     * @brief Single writer counter increment.
+     */
+    static void BM_CounterIncrement(benchmark::State & state)
+    {
+        for (auto _ : state)
+        {
+            stats.frames.increment();
+            benchmark::ClobberMemory();
+        }
+    }
+    BENCHMARK(BM_CounterIncrement);
+
+    /**
+     * @brief Atomic read-modify-write increment, for comparison.
+     */
+    static void BM_AtomicFetchAdd(benchmark::State & state)
+    {
+        std::atomic<uint32_t> counter{0};
+        for (auto _ : state)
+        {
+            counter.fetch_add(1, std::memory_order_relaxed);
+            benchmark::ClobberMemory();
+        }
+    }
+    BENCHMARK(BM_AtomicFetchAdd);
+
+    /**
+     * @brief Updates done on the I2C interrupt path for a frame: two latency samples, the frame
+     *        count and the pending frames watermark.
+     */
+    static void BM_FrameUpdates(benchmark::State & state)
+    {
+        uint32_t sample = 0;
+        for (auto _ : state)
+        {
+            stats.isrDuration.record(sample & 0x7);
+            stats.transactionLatency.record(sample);
+            stats.frames.increment();
+            stats.pendingFrames.update(sample & 0x3);
+            sample += 13;
+            benchmark::ClobberMemory();
+        }
+    }
+    BENCHMARK(BM_FrameUpdates);
+
+    /**
+     * @brief Serialization of a diagnostic page, as served after a DIAGNOSTICS message.
+     */
+    static void BM_DiagnosticPage(benchmark::State & state)
+    {
+        uint8_t page = 0;
+        RobotArm::rxCallback(RAW(RobotArm::RxIds::DIAGNOSTICS), 1, &page);
+        uint8_t response[BUFFER_SIZE];
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(RobotArm::getResponse(response));
+            benchmark::ClobberMemory();
+        }
+    }
+    BENCHMARK(BM_DiagnosticPage);
+
+} // namespace Benchmarks
@@ -0,0 +1,103 @@
+/***********************************************************************
+ * @file	:	bench_communication_handler.cpp
+ * @brief 	:	Benchmarks for received message dispatch.
+ *              Compares the compile-time dispatch table against the
+ *              former unordered_map of std::function lookup.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#include "communication_handler.hpp"
+#include <benchmark/benchmark.h>
+#include <unordered_map>
+#include <functional>
+
+using namespace Communication;
+using namespace Communication::RobotArm;
+
+namespace Benchmarks {
+
+    static volatile size_t handledBytes = 0;
+
+    static ResponseCode countCallback(const uint8_t * msgData, const size_t dataLength)
+    {
+        handledBytes = handledBytes + dataLength;
+        return ResponseCode::Positive;
+    }
+
+    constexpr MessageEntry benchEntries[] =
+        {
+            {RxIds::EMERGENCY_STOP, countCallback},
+            {RxIds::CANCEL, countCallback},
+            {RxIds::LOAD, countCallback},
+            {RxIds::TEACH, countCallback},
+            {RxIds::START, countCallback},
+            {RxIds::PAUSE, countCallback},
+            {RxIds::RESUME, countCallback},
+            {RxIds::PROGRAM_DATA, countCallback},
+            {RxIds::MCU_RESET, countCallback}
+        };
+
+    constexpr MessageTable benchTable = makeMessageTable(benchEntries);
+
+    static const std::unordered_map<RxMessageId, std::function<void(const uint8_t *, const size_t)>> benchMap =
+        {
+            {RAW(RxIds::EMERGENCY_STOP), countCallback},
+            {RAW(RxIds::CANCEL), countCallback},
+            {RAW(RxIds::LOAD), countCallback},
+            {RAW(RxIds::TEACH), countCallback},
+            {RAW(RxIds::START), countCallback},
+            {RAW(RxIds::PAUSE), countCallback},
+            {RAW(RxIds::RESUME), countCallback},
+            {RAW(RxIds::PROGRAM_DATA), countCallback},
+            {RAW(RxIds::MCU_RESET), countCallback}
+        };
+
+    // Mostly PROGRAM_DATA frames with some commands and unknown ids, as seen during a program load
+    constexpr RxMessageId traffic[] = {0x07, 0x07, 0x07, 0x02, 0x07, 0x07, 0x0F, 0x07, 0x04, 0x07, 0x07, 0xFF, 0x07, 0x05, 0x07, 0x06};
+    constexpr size_t trafficLength = sizeof(traffic) / sizeof(traffic[0]);
+    static uint8_t payload[BUFFER_SIZE - 1] = {0};
+
+    /**
+     * @brief Former dispatch: count() then two at() lookups and a std::function call.
+     */
+    static void BM_DispatchUnorderedMap(benchmark::State & state)
+    {
+        size_t i = 0;
+        for (auto _ : state)
+        {
+            RxMessageId msgId = traffic[i++ % trafficLength];
+            benchmark::DoNotOptimize(msgId);
+            if (benchMap.count(msgId) == 1)
+            {
+                if (benchMap.at(msgId) != nullptr)
+                {
+                    benchMap.at(msgId)(payload, sizeof(payload));
+                }
+            }
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_DispatchUnorderedMap);
+
+    /**
+     * @brief Compile-time table: one indexed load and a plain function pointer call.
+     */
+    static void BM_DispatchTable(benchmark::State & state)
+    {
+        size_t i = 0;
+        for (auto _ : state)
+        {
+            RxMessageId msgId = traffic[i++ % trafficLength];
+            benchmark::DoNotOptimize(msgId);
+            Callback callback = benchTable[msgId];
+            if (callback != nullptr)
+            {
+                callback(payload, sizeof(payload));
+            }
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_DispatchTable);
+
+} // namespace Benchmarks
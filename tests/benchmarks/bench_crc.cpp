@@ -0,0 +1,73 @@
+/***********************************************************************
+ * @file	:	bench_crc.cpp
+ * @brief 	:	Benchmarks for the table driven CRC kernel.
+ *              Reports bytes per cycle and table size for each number
+ *              of slices, to pick CRC_SLICES against the flash budget.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#include "crc.hpp"
+#include "message_format.hpp"
+#include <benchmark/benchmark.h>
+#include <vector>
+#include <chrono>
+
+using namespace Communication;
+
+namespace Benchmarks {
+
+    /**
+     * @brief CRC of a buffer of state.range(0) bytes.
+     */
+    template <typename C>
+    static void BM_Crc(benchmark::State & state)
+    {
+        std::vector<uint8_t> data(static_cast<size_t>(state.range(0)));
+        for (size_t i = 0; i < data.size(); i++)
+        {
+            data[i] = static_cast<uint8_t>(i * 37 + 11);
+        }
+        auto start = std::chrono::steady_clock::now();
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(data.data());
+            auto crc = C::compute(data.data(), data.size());
+            benchmark::DoNotOptimize(crc);
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        double bytes = static_cast<double>(state.iterations() * data.size());
+        double cycles = elapsed.count() * benchmark::CPUInfo::Get().cycles_per_second;
+        state.SetBytesProcessed(static_cast<int64_t>(bytes));
+        state.counters["bytes_per_cycle"] = bytes / cycles;
+        state.counters["table_bytes"] = static_cast<double>(C::tableBytes());
+    }
+    BENCHMARK(BM_Crc<Crc16<1>>)->Arg(BUFFER_SIZE)->Arg(4096);
+    BENCHMARK(BM_Crc<Crc16<2>>)->Arg(BUFFER_SIZE)->Arg(4096);
+    BENCHMARK(BM_Crc<Crc16<4>>)->Arg(BUFFER_SIZE)->Arg(4096);
+    BENCHMARK(BM_Crc<Crc16<8>>)->Arg(BUFFER_SIZE)->Arg(4096);
+    BENCHMARK(BM_Crc<Crc32<1>>)->Arg(BUFFER_SIZE)->Arg(4096);
+    BENCHMARK(BM_Crc<Crc32<2>>)->Arg(BUFFER_SIZE)->Arg(4096);
+    BENCHMARK(BM_Crc<Crc32<4>>)->Arg(BUFFER_SIZE)->Arg(4096);
+    BENCHMARK(BM_Crc<Crc32<8>>)->Arg(BUFFER_SIZE)->Arg(4096);
+    BENCHMARK(BM_Crc<Crc32<16>>)->Arg(BUFFER_SIZE)->Arg(4096);
+
+    /**
+     * @brief Verification of a full frame as done before dispatch.
+     */
+    static void BM_VerifyFrame(benchmark::State & state)
+    {
+        Integrity integrity = static_cast<Integrity>(state.range(0));
+        uint8_t frame[BUFFER_SIZE] = {0x07};
+        size_t length = appendIntegrity(integrity, frame, BUFFER_SIZE - integritySize(integrity));
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(frame);
+            size_t verified = verifyIntegrity(integrity, frame, length);
+            benchmark::DoNotOptimize(verified);
+        }
+        state.SetBytesProcessed(state.iterations() * length);
+    }
+    BENCHMARK(BM_VerifyFrame)->Arg(static_cast<int>(Integrity::Crc16))->Arg(static_cast<int>(Integrity::Crc32));
+
+} // namespace Benchmarks
@@ -0,0 +1,120 @@
+/***********************************************************************
+ * @file	:	bench_emergency_stop.cpp
+ * @brief 	:	Benchmarks for the emergency stop path.
+ *              Host cost of the motor fan-out, and stop latency on the
+ *              virtual clock from the end of the id byte on the bus to
+ *              the motors being disabled, with and without the fast path.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#include "emergency_stop.hpp"
+#include "i2c_transport.hpp"
+#include "i2c_bus_simulator.hpp"
+#include "communication_handler.hpp"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+
+using namespace Motor;
+using namespace Communication;
+using namespace Communication::Hardware;
+
+namespace Benchmarks {
+
+    /**
+     * @brief Motor recording when it was first disabled.
+     */
+    class StubMotor : public IMotor
+    {
+        public:
+            void enable() override { enabledFlag = true; }
+            void disable() override
+            {
+                if (enabledFlag)
+                {
+                    disabledAtUs = mockTimeUs;
+                }
+                enabledFlag = false;
+            }
+            void setZero() override {}
+            void setControlMode(ControlMode mode) override {}
+            int_fast32_t getAbsPosition() const override { return position; }
+            void setAbsPosition(int_fast32_t position) override {}
+            void setSpeed(uint_fast32_t speed) override {}
+            uint_fast32_t getSpeed() const override { return 0; }
+            void setDirection(Direction direction) override {}
+
+            uint64_t disabledAtUs = 0;
+    };
+
+    /**
+     * @brief Host cost of triggering the latch with state.range(0) registered motors.
+     */
+    static void BM_EmergencyStopFanOut(benchmark::State & state)
+    {
+        StubMotor motors[MAX_STOP_MOTORS];
+        EmergencyStopLatch::reset();
+        for (int64_t i = 0; i < state.range(0); i++)
+        {
+            EmergencyStopLatch::registerMotor(&motors[i]);
+        }
+        for (auto _ : state)
+        {
+            EmergencyStopLatch::trigger();
+            benchmark::ClobberMemory();
+        }
+        EmergencyStopLatch::reset();
+    }
+    BENCHMARK(BM_EmergencyStopFanOut)->Arg(1)->Arg(MAX_STOP_MOTORS);
+
+    /**
+     * @brief Emergency stop frame with a full payload sent at a varying phase of a main loop
+     *        serving the transport every state.range(0) us, through the fast path when
+     *        state.range(1) is set or through the dispatched message otherwise. Reports the
+     *        worst and mean virtual latency from the id byte to the motor being disabled. The
+     *        virtual clock stands still in interrupt handlers, the fast path then adds the
+     *        interrupt entry and the fan-out measured by BM_EmergencyStopFanOut.
+     */
+    static void BM_EmergencyStopLatency(benchmark::State & state)
+    {
+        const uint64_t servicePeriod = static_cast<uint64_t>(state.range(0));
+        const bool fastPath = state.range(1) != 0;
+        const double bitTimeUs = 1e6 / DEFAULT_I2C_BAUD_RATE;
+        std::vector<uint8_t> frame(BUFFER_SIZE, 0x5A);
+        frame[0] = RAW(RobotArm::RxIds::EMERGENCY_STOP);
+
+        StubMotor motor;
+        I2CTransport transport;
+        uint64_t worst = 0;
+        uint64_t total = 0;
+        uint64_t phase = 0;
+        for (auto _ : state)
+        {
+            EmergencyStopLatch::reset();
+            EmergencyStopLatch::registerMotor(&motor);
+            motor.enable();
+            RobotArm::startServices(transport, DispatchMode::Deferred);
+            if (!fastPath)
+            {
+                transport.setUrgentHandler(0, nullptr);
+            }
+            Mocks::I2CBusSimulator bus;
+            bus.every(servicePeriod, [&]() { RobotArm::serviceTransport(transport); });
+            phase = (phase + 37) % servicePeriod;
+            bus.idle(static_cast<double>(phase));
+            uint64_t idByteEnd = mockTimeUs + phase + static_cast<uint64_t>(10 * bitTimeUs);
+            bus.write(frame);
+            bus.runUntil(mockTimeUs + phase + BUFFER_SIZE * 9 * bitTimeUs + 2 * servicePeriod);
+
+            uint64_t latency = motor.disabledAtUs - idByteEnd;
+            worst = std::max(worst, latency);
+            total += latency;
+        }
+        EmergencyStopLatch::reset();
+        state.counters["worst_latency_us"] = static_cast<double>(worst);
+        state.counters["mean_latency_us"] = static_cast<double>(total) / static_cast<double>(state.iterations());
+        state.SetLabel(fastPath ? "fast path" : "dispatched");
+    }
+    BENCHMARK(BM_EmergencyStopLatency)->ArgsProduct({{500, 2000}, {1, 0}});
+
+} // namespace Benchmarks
@@ -0,0 +1,79 @@
+/***********************************************************************
+ * @file	:	bench_i2c_slave.cpp
+ * @brief 	:	Benchmarks for the I2CSlave interrupt state machine.
+ *              Drives I2CSlave through the register level bus simulator,
+ *              reporting host frames per second, and frames per second
+ *              and loss on the virtual clock for burst patterns.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#include "i2c_slave.hpp"
+#include "i2c_bus_simulator.hpp"
+#include <benchmark/benchmark.h>
+
+using namespace Communication;
+using namespace Communication::Hardware;
+
+namespace Benchmarks {
+
+    static volatile size_t handledFrames = 0;
+
+    static void countFrame(RxMessageId msgId, size_t dataLength, const uint8_t * data)
+    {
+        handledFrames = handledFrames + 1;
+    }
+
+    /**
+     * @brief Host cost of receiving a frame of state.range(0) bytes and dispatching it from the ISR.
+     */
+    static void BM_SimulatedReceive(benchmark::State & state)
+    {
+        I2CSlave::init(countFrame, nullptr, DEFAULT_I2C_SLAVE_ADDRESS, DEFAULT_I2C_BAUD_RATE, state.range(1) != 0);
+        Mocks::I2CBusSimulator bus;
+        std::vector<uint8_t> frame(static_cast<size_t>(state.range(0)), 0x5A);
+        for (auto _ : state)
+        {
+            bus.write(frame).run();
+        }
+        state.SetItemsProcessed(state.iterations());
+        state.SetLabel(state.range(1) ? "dma" : "irq");
+    }
+    BENCHMARK(BM_SimulatedReceive)->Args({4, 1})->Args({BUFFER_SIZE, 1})->Args({4, 0})->Args({BUFFER_SIZE, 0});
+
+    /**
+     * @brief Bursts of state.range(0) back to back frames at 400kHz with the main loop pumping
+     *        every state.range(1) us. Reports virtual frames/s and the fraction of frames lost.
+     */
+    static void BM_BurstPattern(benchmark::State & state)
+    {
+        const size_t burst = static_cast<size_t>(state.range(0));
+        const uint64_t pumpPeriod = static_cast<uint64_t>(state.range(1));
+        uint64_t virtualUs = 0;
+        size_t sent = 0;
+        size_t lost = 0;
+        for (auto _ : state)
+        {
+            I2CSlave::init(countFrame, nullptr, DEFAULT_I2C_SLAVE_ADDRESS, DEFAULT_I2C_BAUD_RATE, true,
+                           DispatchMode::Deferred);
+            Mocks::I2CBusSimulator bus;
+            bus.every(pumpPeriod, []() { I2CSlave::pump(); });
+            uint32_t dropped = I2CSlave::droppedFrames();
+            uint64_t start = mockTimeUs;
+            for (size_t i = 0; i < burst; i++)
+            {
+                bus.write({0x07, 1, 2, 3, 4, 5, 6, 7});
+            }
+            bus.run();
+            virtualUs += mockTimeUs - start;
+            bus.runUntil(mockTimeUs + 2 * pumpPeriod);
+            sent += burst;
+            lost += I2CSlave::droppedFrames() - dropped;
+        }
+        state.counters["virtual_frames_per_s"] = (virtualUs > 0) ? 1e6 * (sent - lost) / virtualUs : 0.0;
+        state.counters["loss"] = static_cast<double>(lost) / static_cast<double>(sent);
+    }
+    BENCHMARK(BM_BurstPattern)
+        ->ArgsProduct({{4, 16, 64}, {100, 500, 2000}});
+
+} // namespace Benchmarks
@@ -0,0 +1,167 @@
+/***********************************************************************
+ * @file	:	bench_message_format.cpp
+ * @brief 	:	Benchmarks for message format data structures.
+ *              Compares the ISR receive Queue against the lock-free
+ *              SpscQueue, both single threaded and across threads.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#include "message_format.hpp"
+#include "pico/critical_section.h"
+#include <benchmark/benchmark.h>
+#include <thread>
+#include <atomic>
+
+using namespace Communication;
+
+namespace Benchmarks {
+
+    /**
+     * @brief Queue guarded by a critical section, as required today to share it between contexts.
+     */
+    struct GuardedQueue
+    {
+        Queue<uint8_t> queue;
+        critical_section_t lock;
+
+        bool push(uint8_t data)
+        {
+            critical_section_enter_blocking(&lock);
+            bool ok = queue.push(data);
+            critical_section_exit(&lock);
+            return ok;
+        }
+
+        bool pop(uint8_t & data)
+        {
+            critical_section_enter_blocking(&lock);
+            bool ok = queue.pop(data);
+            critical_section_exit(&lock);
+            return ok;
+        }
+    };
+
+    /**
+     * @brief Push and pop one byte from the same context.
+     */
+    template <typename Q>
+    static void BM_PushPop(benchmark::State & state)
+    {
+        Q queue;
+        uint8_t value = 0;
+        for (auto _ : state)
+        {
+            queue.push(value);
+            queue.pop(value);
+            benchmark::DoNotOptimize(value);
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_PushPop<Queue<uint8_t>>);
+    BENCHMARK(BM_PushPop<SpscQueue<uint8_t, BUFFER_SIZE>>);
+
+    /**
+     * @brief Fill and drain the whole buffer, a burst of one frame.
+     */
+    template <typename Q>
+    static void BM_Burst(benchmark::State & state)
+    {
+        Q queue;
+        uint8_t value = 0;
+        for (auto _ : state)
+        {
+            for (size_t i = 0; i < BUFFER_SIZE; ++i)
+            {
+                queue.push(static_cast<uint8_t>(i));
+            }
+            while (queue.pop(value))
+            {
+                benchmark::DoNotOptimize(value);
+            }
+        }
+        state.SetBytesProcessed(state.iterations() * BUFFER_SIZE);
+    }
+    BENCHMARK(BM_Burst<Queue<uint8_t>>);
+    BENCHMARK(BM_Burst<SpscQueue<uint8_t, BUFFER_SIZE>>);
+
+    /**
+     * @brief Throughput with the producer and the consumer running on different threads.
+     */
+    template <typename Q>
+    static void BM_CrossThreadThroughput(benchmark::State & state)
+    {
+        constexpr size_t count = 1 << 16;
+        Q queue;
+        for (auto _ : state)
+        {
+            std::thread producer([&queue]() {
+                for (size_t i = 0; i < count; ++i)
+                {
+                    while (!queue.push(static_cast<uint8_t>(i)))
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+            uint8_t value;
+            size_t received = 0;
+            while (received < count)
+            {
+                if (queue.pop(value))
+                {
+                    ++received;
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+            producer.join();
+        }
+        state.SetItemsProcessed(state.iterations() * count);
+    }
+    BENCHMARK(BM_CrossThreadThroughput<GuardedQueue>)->UseRealTime();
+    BENCHMARK(BM_CrossThreadThroughput<SpscQueue<uint8_t, BUFFER_SIZE>>)->UseRealTime();
+
+    /**
+     * @brief Round trip latency of one element bounced between two threads through two queues.
+     *        Reported time per iteration is the round trip, i.e. two handoffs.
+     */
+    template <typename Q>
+    static void BM_CrossThreadLatency(benchmark::State & state)
+    {
+        Q ping;
+        Q pong;
+        std::atomic_bool running = true;
+        std::thread echo([&]() {
+            uint8_t value;
+            while (running.load(std::memory_order_relaxed))
+            {
+                if (ping.pop(value))
+                {
+                    while (!pong.push(value)) {}
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+        uint8_t value = 0;
+        for (auto _ : state)
+        {
+            while (!ping.push(value)) {}
+            while (!pong.pop(value))
+            {
+                std::this_thread::yield();
+            }
+        }
+        running = false;
+        echo.join();
+    }
+    BENCHMARK(BM_CrossThreadLatency<GuardedQueue>)->UseRealTime();
+    BENCHMARK(BM_CrossThreadLatency<SpscQueue<uint8_t, BUFFER_SIZE>>)->UseRealTime();
+
+} // namespace Benchmarks
@@ -0,0 +1,547 @@
+/***********************************************************************
+ * @file	:	bench_state_manager.cpp
+ * @brief 	:	Benchmarks for state transitions and dispatch.
+ *              Compares states kept in a StateSlab against states
+ *              allocated with make_unique on every transition, in
+ *              transitions per second and heap allocations, and
+ *              virtual against static dispatch of the states, and
+ *              event handling of the hierarchical robotic arm table
+ *              against the flat switch it replaced, and the lock-free
+ *              transition ring against a critical section, and the
+ *              timer wheel against scanning every pending timer, and
+ *              a bank of joint state machines against separately
+ *              allocated ones.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#include "state_manager.hpp"
+#include "state_slab.hpp"
+#include "static_state_manager.hpp"
+#include "transition_ring.hpp"
+#include "timer_wheel.hpp"
+#include "pico/critical_section.h"
+#include "fsm_state_manager.hpp"
+#include "joint_state_machine.hpp"
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <random>
+#include <vector>
+
+// Heap allocations made by the process, to report the ones made by transitions
+static std::atomic<size_t> heapAllocations{0};
+
+void * operator new(size_t size)
+{
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void * memory = std::malloc(size == 0 ? 1 : size))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void * memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void * memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+namespace Benchmarks {
+
+    enum class BenchState : uint8_t { A, B, C, Count };
+    enum class BenchEvent : uint8_t { Next };
+
+    // Same machine for both storages, distinct matrices select distinct factories
+    static BenchState heapMatrix(BenchState state, BenchEvent event)
+    {
+        return static_cast<BenchState>((static_cast<uint8_t>(state) + 1) % static_cast<uint8_t>(BenchState::Count));
+    }
+
+    static BenchState slabMatrix(BenchState state, BenchEvent event)
+    {
+        return heapMatrix(state, event);
+    }
+
+    static BenchState staticMatrix(BenchState state, BenchEvent event)
+    {
+        return heapMatrix(state, event);
+    }
+
+    static volatile uint32_t stateCalls = 0;
+
+    template <StateMachine::StateTransMatrix<BenchState, BenchEvent> matrix, BenchState id>
+    class BenchStep : public StateMachine::State<BenchState, BenchEvent, matrix>
+    {
+        public:
+            BenchStep(StateMachine::StateManager<BenchState, BenchEvent, matrix> * instance)
+                : StateMachine::State<BenchState, BenchEvent, matrix>(id, instance) {}
+            void run() override { stateCalls = stateCalls + 1; }
+            void onEnter() override { stateCalls = stateCalls + 1; }
+            void onExit() override { stateCalls = stateCalls + 1; }
+    };
+
+    template <StateMachine::StateTransMatrix<BenchState, BenchEvent> matrix>
+    class BenchManager : public StateMachine::StateManager<BenchState, BenchEvent, matrix>
+    {
+        public:
+            BenchManager() : StateMachine::StateManager<BenchState, BenchEvent, matrix>(BenchState::A) {}
+    };
+
+    class BenchStaticManager
+        : public StateMachine::StaticStateManager<BenchState, BenchEvent, staticMatrix, 3,
+                                                  BenchStep<staticMatrix, BenchState::A>,
+                                                  BenchStep<staticMatrix, BenchState::B>,
+                                                  BenchStep<staticMatrix, BenchState::C>>
+    {
+        public:
+            BenchStaticManager() : StaticStateManager(BenchState::A) {}
+    };
+
+} // namespace Benchmarks
+
+namespace StateMachine {
+
+    using Benchmarks::BenchState;
+    using Benchmarks::BenchEvent;
+    using Benchmarks::BenchStep;
+
+    /**
+     * @brief States allocated on every transition, as the factories did before StateSlab.
+     */
+    template <>
+    class StateFactory<BenchState, BenchEvent, Benchmarks::heapMatrix>
+    {
+        public:
+            static StatePtr<BenchState, BenchEvent, Benchmarks::heapMatrix>
+                createState(BenchState sId, StateManager<BenchState, BenchEvent, Benchmarks::heapMatrix> * sManager)
+            {
+                switch (sId)
+                {
+                    case BenchState::A:
+                        return std::make_unique<BenchStep<Benchmarks::heapMatrix, BenchState::A>>(sManager);
+                    case BenchState::B:
+                        return std::make_unique<BenchStep<Benchmarks::heapMatrix, BenchState::B>>(sManager);
+                    case BenchState::C:
+                        return std::make_unique<BenchStep<Benchmarks::heapMatrix, BenchState::C>>(sManager);
+                    default:
+                        return nullptr;
+                }
+            }
+    };
+
+    template <>
+    class StateFactory<BenchState, BenchEvent, Benchmarks::slabMatrix>
+    {
+        public:
+            static StatePtr<BenchState, BenchEvent, Benchmarks::slabMatrix>
+                createState(BenchState sId, StateManager<BenchState, BenchEvent, Benchmarks::slabMatrix> * sManager)
+            {
+                static StateSlab<BenchState, BenchEvent, Benchmarks::slabMatrix, 3,
+                                 BenchStep<Benchmarks::slabMatrix, BenchState::A>,
+                                 BenchStep<Benchmarks::slabMatrix, BenchState::B>,
+                                 BenchStep<Benchmarks::slabMatrix, BenchState::C>> states;
+                return states.get(sId, sManager);
+            }
+    };
+
+} // namespace StateMachine
+
+namespace Benchmarks {
+
+    /**
+     * @brief Event, transition and run of the new state, as the control loop does on a change.
+     */
+    template <typename Manager>
+    static void BM_Transition(benchmark::State & state)
+    {
+        Manager manager;
+        manager.run();
+        size_t allocations = heapAllocations.load();
+        for (auto _ : state)
+        {
+            manager.handleEvent(BenchEvent::Next);
+            manager.run();
+        }
+        allocations = heapAllocations.load() - allocations;
+        state.counters["transitions_per_second"] =
+            benchmark::Counter(static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+        state.counters["allocations_per_transition"] =
+            static_cast<double>(allocations) / static_cast<double>(state.iterations());
+    }
+    BENCHMARK(BM_Transition<BenchManager<heapMatrix>>)->Name("BM_Transition/heap");
+    BENCHMARK(BM_Transition<BenchManager<slabMatrix>>)->Name("BM_Transition/slab");
+    BENCHMARK(BM_Transition<BenchStaticManager>)->Name("BM_Transition/static");
+
+    /**
+     * @brief Control loop iteration without a state change.
+     */
+    template <typename Manager>
+    static void BM_Run(benchmark::State & state)
+    {
+        Manager manager;
+        for (auto _ : state)
+        {
+            manager.run();
+        }
+        state.counters["runs_per_second"] =
+            benchmark::Counter(static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+    }
+    BENCHMARK(BM_Run<BenchManager<slabMatrix>>)->Name("BM_Run/virtual");
+    BENCHMARK(BM_Run<BenchStaticManager>)->Name("BM_Run/static");
+
+    /**
+     * @brief Events from several producers, e.g. ISRs and the other core, while the first thread
+     *        runs the state machine.
+     */
+    static void BM_ConcurrentEvents(benchmark::State & state)
+    {
+        static BenchManager<slabMatrix> manager;
+        if (state.thread_index() == 0)
+        {
+            manager.run();
+        }
+        uint32_t dropped = manager.getDroppedTransitions();
+        for (auto _ : state)
+        {
+            manager.handleEvent(BenchEvent::Next);
+            if (state.thread_index() == 0)
+            {
+                manager.run();
+            }
+        }
+        state.counters["events_per_second"] =
+            benchmark::Counter(static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+        if (state.thread_index() == 0)
+        {
+            state.counters["dropped"] = static_cast<double>(manager.getDroppedTransitions() - dropped);
+        }
+    }
+    BENCHMARK(BM_ConcurrentEvents)->ThreadRange(1, 4)->UseRealTime();
+
+    using StateMachine::RobotArm::StateId;
+    using StateMachine::RobotArm::Event;
+
+    /**
+     * @brief Robotic arm transitions as the flat switch used before transition tables.
+     */
+    static StateId flatSwitchMatrix(StateId currentState, Event event)
+    {
+        switch (currentState)
+        {
+            case StateId::Init:
+                switch (event)
+                {
+                    case Event::Done:           return StateId::Ready;
+                    case Event::EmergencyStop:  return StateId::EmergencyStop;
+                    default:                    return currentState;
+                }
+            case StateId::Ready:
+                switch (event)
+                {
+                    case Event::Load:           return StateId::LoadProgram;
+                    case Event::Teach:          return StateId::Teach;
+                    case Event::EmergencyStop:  return StateId::EmergencyStop;
+                    default:                    return currentState;
+                }
+            case StateId::LoadProgram:
+                switch (event)
+                {
+                    case Event::Cancel:         return StateId::Ready;
+                    case Event::ProgramLoaded:  return StateId::ReadyAndLoaded;
+                    case Event::EmergencyStop:  return StateId::EmergencyStop;
+                    default:                    return currentState;
+                }
+            case StateId::Teach:
+                switch (event)
+                {
+                    case Event::Cancel:         return StateId::Ready;
+                    case Event::ProgramLoaded:  return StateId::ReadyAndLoaded;
+                    case Event::EmergencyStop:  return StateId::EmergencyStop;
+                    default:                    return currentState;
+                }
+            case StateId::ReadyAndLoaded:
+                switch (event)
+                {
+                    case Event::Start:          return StateId::StartProgram;
+                    case Event::Load:           return StateId::LoadProgram;
+                    case Event::Teach:          return StateId::Teach;
+                    case Event::EmergencyStop:  return StateId::EmergencyStop;
+                    default:                    return currentState;
+                }
+            case StateId::StartProgram:
+                switch (event)
+                {
+                    case Event::Cancel:         return StateId::ReadyAndLoaded;
+                    case Event::Done:           return StateId::Execute;
+                    case Event::EmergencyStop:  return StateId::EmergencyStop;
+                    default:                    return currentState;
+                }
+            case StateId::Execute:
+                switch (event)
+                {
+                    case Event::Start:          return StateId::StartProgram;
+                    case Event::Pause:          return StateId::Paused;
+                    case Event::Done:           return StateId::ReadyAndLoaded;
+                    case Event::Cancel:         return StateId::ReadyAndLoaded;
+                    case Event::EmergencyStop:  return StateId::EmergencyStop;
+                    default:                    return currentState;
+                }
+            case StateId::Paused:
+                switch (event)
+                {
+                    case Event::Start:          return StateId::StartProgram;
+                    case Event::Resume:         return StateId::Execute;
+                    case Event::Cancel:         return StateId::ReadyAndLoaded;
+                    case Event::EmergencyStop:  return StateId::EmergencyStop;
+                    default:                    return currentState;
+                }
+            case StateId::EmergencyStop:
+                switch (event)
+                {
+                    default:                    return currentState;
+                }
+            default:
+                return currentState;
+        }
+    }
+
+    /**
+     * @brief Robotic arm transitions bubbling up the parent states at run time, without the
+     *        inherited transitions copied into the table.
+     */
+    static StateId runtimeBubblingMatrix(StateId currentState, Event event)
+    {
+        static constexpr StateMachine::TransitionTable<StateId, Event, StateMachine::RobotArm::NUM_STATES,
+                                                       StateMachine::RobotArm::NUM_EVENTS>
+            own{StateMachine::RobotArm::transitions};
+        const auto & hierarchy = StateMachine::RobotArm::hierarchy;
+        for (size_t level = hierarchy.level(currentState); level > 0; level--)
+        {
+            StateId handler = hierarchy.ancestor(currentState, level);
+            StateId next = own(handler, event);
+            if (next != handler)
+            {
+                return next;
+            }
+        }
+        return currentState;
+    }
+
+    /**
+     * @brief Lookups of random leaf states and events.
+     */
+    template <StateId (*matrix)(StateId, Event)>
+    static void BM_EventLookup(benchmark::State & state)
+    {
+        using namespace StateMachine::RobotArm;
+        std::mt19937 random(7);
+        std::array<std::pair<StateId, Event>, 256> inputs;
+        for (auto & input : inputs)
+        {
+            input = {leafStates[random() % std::size(leafStates)], static_cast<Event>(random() % NUM_EVENTS)};
+        }
+        size_t i = 0;
+        for (auto _ : state)
+        {
+            const auto & input = inputs[i++ & 0xFF];
+            benchmark::DoNotOptimize(matrix(input.first, input.second));
+        }
+        state.counters["events_per_second"] =
+            benchmark::Counter(static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+    }
+    BENCHMARK(BM_EventLookup<flatSwitchMatrix>)->Name("BM_EventLookup/flat_switch");
+    BENCHMARK(BM_EventLookup<StateMachine::RobotArm::stateTransMatrix>)->Name("BM_EventLookup/hierarchical_table");
+    BENCHMARK(BM_EventLookup<runtimeBubblingMatrix>)->Name("BM_EventLookup/runtime_bubbling");
+
+    /**
+     * @brief Robotic arm program cycle ReadyAndLoaded, StartProgram, Execute. Entering and leaving
+     *        Running exits and enters the Idle and Running parents.
+     */
+    static void BM_HierarchicalTransition(benchmark::State & state)
+    {
+        StateMachine::RobotArm::FSMStateManager manager;
+        const Event setup[] = {Event::Done, Event::Load, Event::ProgramLoaded};
+        manager.run();
+        for (Event event : setup)
+        {
+            manager.handleEvent(std::move(event));
+            manager.run();
+        }
+        const Event cycle[] = {Event::Start, Event::Done, Event::Done};
+        size_t i = 0;
+        for (auto _ : state)
+        {
+            Event event = cycle[i++ % 3];
+            manager.handleEvent(std::move(event));
+            manager.run();
+        }
+        state.counters["transitions_per_second"] =
+            benchmark::Counter(static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+    }
+    BENCHMARK(BM_HierarchicalTransition);
+
+    /**
+     * @brief Event handling under a critical section, as handleEvent did before the ring.
+     */
+    static void BM_HandleEvent_Locked(benchmark::State & state)
+    {
+        critical_section_t lock;
+        critical_section_init(&lock);
+        BenchState current = BenchState::A;
+        for (auto _ : state)
+        {
+            critical_section_enter_blocking(&lock);
+            current = heapMatrix(current, BenchEvent::Next);
+            critical_section_exit(&lock);
+            benchmark::DoNotOptimize(current);
+        }
+        critical_section_deinit(&lock);
+        state.counters["events_per_second"] =
+            benchmark::Counter(static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+    }
+    BENCHMARK(BM_HandleEvent_Locked);
+
+    /**
+     * @brief Event handling with the compare-and-swap of the transition ring, popped as run() does.
+     */
+    static void BM_HandleEvent_Ring(benchmark::State & state)
+    {
+        StateMachine::TransitionRing<BenchState, 8> ring(BenchState::A);
+        BenchState next;
+        for (auto _ : state)
+        {
+            ring.take([](BenchState s) { return heapMatrix(s, BenchEvent::Next); });
+            ring.pop(next);
+            benchmark::DoNotOptimize(next);
+        }
+        state.counters["events_per_second"] =
+            benchmark::Counter(static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+    }
+    BENCHMARK(BM_HandleEvent_Ring);
+
+    constexpr size_t BENCH_TIMERS = 512;
+    using BenchWheel = StateMachine::TimerWheel<BenchState, BenchEvent, BENCH_TIMERS + 1>;
+
+    /**
+     * @brief Arm and cancel of one timer with range(0) other timers pending.
+     */
+    static void BM_TimerArmCancel(benchmark::State & state)
+    {
+        auto wheel = std::make_unique<BenchWheel>();
+        for (int64_t i = 0; i < state.range(0); i++)
+        {
+            wheel->armOwned(BenchState::A, BenchEvent::Next, 1 + static_cast<uint32_t>(i));
+        }
+        for (auto _ : state)
+        {
+            StateMachine::TimerId id = wheel->armOwned(BenchState::B, BenchEvent::Next, 100);
+            benchmark::DoNotOptimize(wheel->cancel(id));
+        }
+        state.counters["pending"] = static_cast<double>(wheel->pending());
+    }
+    BENCHMARK(BM_TimerArmCancel)->Arg(0)->Arg(BENCH_TIMERS);
+
+    /**
+     * @brief One tick with range(0) periodic timers pending, spread over 1000 ticks.
+     */
+    static void BM_TimerTick_Wheel(benchmark::State & state)
+    {
+        auto wheel = std::make_unique<BenchWheel>();
+        for (int64_t i = 0; i < state.range(0); i++)
+        {
+            wheel->arm(BenchEvent::Next, 1 + static_cast<uint32_t>(i * 7) % 1000, 1000);
+        }
+        uint32_t now = 0;
+        size_t posted = 0;
+        for (auto _ : state)
+        {
+            posted += wheel->advance(++now, [](BenchEvent event) { benchmark::DoNotOptimize(event); });
+        }
+        benchmark::DoNotOptimize(posted);
+        state.counters["ticks_per_second"] =
+            benchmark::Counter(static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+    }
+    BENCHMARK(BM_TimerTick_Wheel)->Arg(16)->Arg(BENCH_TIMERS);
+
+    /**
+     * @brief Same tick checking the deadline of every pending timer, as with one list of timeouts.
+     */
+    static void BM_TimerTick_Scan(benchmark::State & state)
+    {
+        std::vector<uint32_t> deadlines;
+        for (int64_t i = 0; i < state.range(0); i++)
+        {
+            deadlines.push_back(1 + static_cast<uint32_t>(i * 7) % 1000);
+        }
+        uint32_t now = 0;
+        size_t posted = 0;
+        for (auto _ : state)
+        {
+            now++;
+            for (uint32_t & deadline : deadlines)
+            {
+                if (static_cast<int32_t>(deadline - now) <= 0)
+                {
+                    benchmark::DoNotOptimize(BenchEvent::Next);
+                    deadline += 1000;
+                    posted++;
+                }
+            }
+        }
+        benchmark::DoNotOptimize(posted);
+        state.counters["ticks_per_second"] =
+            benchmark::Counter(static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+    }
+    BENCHMARK(BM_TimerTick_Scan)->Arg(16)->Arg(BENCH_TIMERS);
+
+    /**
+     * @brief One step of every joint state machine, stored side by side in a bank.
+     */
+    static void BM_RunAll_Bank(benchmark::State & state)
+    {
+        namespace Joint = StateMachine::RobotArm::Joint;
+        auto joints = std::make_unique<Joint::JointBank>(Joint::StateId::Unhomed);
+        for (auto _ : state)
+        {
+            joints->runAll();
+        }
+        state.counters["machines_per_second"] = benchmark::Counter(
+            static_cast<double>(state.iterations() * Joint::JointBank::size()), benchmark::Counter::kIsRate);
+    }
+    BENCHMARK(BM_RunAll_Bank);
+
+    /**
+     * @brief Same step with every joint state machine allocated on its own, between other
+     *        allocations, and reached through a pointer.
+     */
+    static void BM_RunAll_Scattered(benchmark::State & state)
+    {
+        namespace Joint = StateMachine::RobotArm::Joint;
+        std::vector<std::unique_ptr<Joint::JointStateManager>> joints;
+        std::vector<std::unique_ptr<uint8_t[]>> gaps;
+        for (size_t joint = 0; joint < Joint::JointBank::size(); joint++)
+        {
+            joints.push_back(std::make_unique<Joint::JointStateManager>(Joint::StateId::Unhomed));
+            gaps.push_back(std::make_unique<uint8_t[]>(4096));
+        }
+        for (auto _ : state)
+        {
+            for (auto & joint : joints)
+            {
+                joint->run();
+            }
+        }
+        state.counters["machines_per_second"] = benchmark::Counter(
+            static_cast<double>(state.iterations() * Joint::JointBank::size()), benchmark::Counter::kIsRate);
+    }
+    BENCHMARK(BM_RunAll_Scattered);
+
+} // namespace Benchmarks
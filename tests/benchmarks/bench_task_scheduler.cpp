@@ -0,0 +1,77 @@
+/***********************************************************************
+ * @file	:	bench_task_scheduler.cpp
+ * @brief 	:	Benchmarks for the cooperative task scheduler.
+ *              Host cost of a scheduling step, and cycle time of the
+ *              main loop tasks on the simulated clock: a 1 kHz FSM,
+ *              100 Hz telemetry and idle work, with jitter and
+ *              overruns as counters.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#include "task_scheduler.hpp"
+#include "hardware/timer.h"
+#include <benchmark/benchmark.h>
+
+using namespace Utilities;
+
+namespace Benchmarks {
+
+    // Simulated execution time of a task, in us
+    static void simulate(void * context)
+    {
+        mockTimeUs += *static_cast<uint32_t *>(context);
+    }
+
+    /**
+     * @brief Scheduling step of four periodic tasks and an idle task, with no time passing so
+     *        every step after the first releases runs the idle task.
+     */
+    static void BM_SchedulerStep(benchmark::State & state)
+    {
+        mockTimeUs = 0;
+        uint32_t none = 0;
+        TaskScheduler scheduler;
+        for (uint32_t period : {1000u, 2000u, 5000u, 10000u})
+        {
+            scheduler.addTask(simulate, &none, period);
+        }
+        scheduler.addIdleTask(simulate, &none);
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(scheduler.runOnce());
+        }
+    }
+    BENCHMARK(BM_SchedulerStep);
+
+    /**
+     * @brief One simulated second of the main loop. range(0) is the telemetry execution time,
+     *        range(1) the longest idle step, both delaying the FSM task.
+     */
+    static void BM_MainLoopSecond(benchmark::State & state)
+    {
+        uint32_t fsmUs = 150;
+        uint32_t telemetryUs = static_cast<uint32_t>(state.range(0));
+        uint32_t idleUs = static_cast<uint32_t>(state.range(1));
+        TaskStats fsm;
+        for (auto _ : state)
+        {
+            mockTimeUs = 0;
+            TaskScheduler scheduler;
+            size_t fsmTask = scheduler.addTask(simulate, &fsmUs, 1000);
+            scheduler.addTask(simulate, &telemetryUs, 10000);
+            scheduler.addIdleTask(simulate, &idleUs);
+            while (mockTimeUs < 1000000)
+            {
+                scheduler.runOnce();
+            }
+            fsm = scheduler.stats(fsmTask);
+        }
+        state.counters["fsm_runs"] = fsm.runs;
+        state.counters["fsm_overruns"] = fsm.overruns;
+        state.counters["fsm_avg_jitter_us"] = fsm.avgJitterUs();
+        state.counters["fsm_max_jitter_us"] = fsm.maxJitterUs;
+    }
+    BENCHMARK(BM_MainLoopSecond)->Args({300, 20})->Args({900, 20})->Args({300, 400})->Args({1500, 20});
+
+} // namespace Benchmarks
@@ -0,0 +1,124 @@
+/***********************************************************************
+ * @file	:	bench_transport.cpp
+ * @brief 	:	Benchmarks for end-to-end message throughput.
+ *              Runs the robot arm services over the loopback transport,
+ *              with the master in the same thread or in another one.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#include "loopback_transport.hpp"
+#include "stream_framing.hpp"
+#include "communication_handler.hpp"
+#include <benchmark/benchmark.h>
+#include <thread>
+#include <atomic>
+
+using namespace Communication;
+
+namespace Benchmarks {
+
+    /**
+     * @brief Full frame of program data, ignored by the services outside of LoadProgram.
+     */
+    static void programFrame(uint8_t (&frame)[BUFFER_SIZE])
+    {
+        frame[0] = RAW(RobotArm::RxIds::PROGRAM_DATA);
+        for (size_t i = 1; i < BUFFER_SIZE; i++)
+        {
+            frame[i] = static_cast<uint8_t>(i);
+        }
+    }
+
+    /**
+     * @brief Write a frame, serve it and read the response, all from one thread.
+     */
+    static void BM_LoopbackRoundTrip(benchmark::State & state)
+    {
+        LoopbackTransport transport;
+        RobotArm::startServices(transport, DispatchMode::Deferred);
+        uint8_t frame[BUFFER_SIZE];
+        programFrame(frame);
+        uint8_t response[BUFFER_SIZE];
+        for (auto _ : state)
+        {
+            transport.masterWrite(frame, BUFFER_SIZE);
+            RobotArm::serviceTransport(transport);
+            benchmark::DoNotOptimize(transport.masterRead(response, 1));
+        }
+        state.SetItemsProcessed(state.iterations());
+        state.SetBytesProcessed(state.iterations() * BUFFER_SIZE);
+    }
+    BENCHMARK(BM_LoopbackRoundTrip);
+
+    /**
+     * @brief Frames streamed by a master thread while the services run in the benchmark thread.
+     */
+    static void BM_LoopbackThroughput(benchmark::State & state)
+    {
+        constexpr size_t count = 1 << 14;
+        LoopbackTransport transport;
+        RobotArm::startServices(transport, DispatchMode::Deferred);
+        uint8_t frame[BUFFER_SIZE];
+        programFrame(frame);
+
+        for (auto _ : state)
+        {
+            std::atomic<bool> done = false;
+            std::thread master([&]() {
+                uint8_t response[BUFFER_SIZE];
+                for (size_t i = 0; i < count; i++)
+                {
+                    while (!transport.masterWrite(frame, BUFFER_SIZE))
+                    {
+                        std::this_thread::yield();
+                    }
+                    transport.masterRead(response, 1);
+                }
+                done = true;
+            });
+            while (!done.load())
+            {
+                if (RobotArm::serviceTransport(transport) == 0)
+                {
+                    std::this_thread::yield();
+                }
+            }
+            master.join();
+            while (RobotArm::serviceTransport(transport) > 0) {}
+        }
+        state.SetItemsProcessed(state.iterations() * count);
+        state.SetBytesProcessed(state.iterations() * count * BUFFER_SIZE);
+    }
+    BENCHMARK(BM_LoopbackThroughput)->UseRealTime();
+
+    /**
+     * @brief Decoding of a byte stream into frames, as done by stream transports (UART, pty).
+     */
+    static void BM_StreamDecode(benchmark::State & state)
+    {
+        RxFrames pool;
+        StreamDecoder decoder(pool);
+        uint8_t frame[BUFFER_SIZE];
+        programFrame(frame);
+        uint8_t stream[STREAM_FRAME_SIZE];
+        size_t length = encodeStreamFrame(frame, BUFFER_SIZE, stream);
+        RxFrames::View view;
+        for (auto _ : state)
+        {
+            for (size_t i = 0; i < length; i++)
+            {
+                if (decoder.feed(stream[i]))
+                {
+                    pool.publish();
+                }
+            }
+            pool.receive(view);
+            view.release();
+        }
+        state.SetItemsProcessed(state.iterations());
+        state.SetBytesProcessed(state.iterations() * length);
+    }
+    BENCHMARK(BM_StreamDecode);
+
+} // namespace Benchmarks
@@ -0,0 +1,174 @@
+/***********************************************************************
+ * @file	:	bench_waypoint_codec.cpp
+ * @brief 	:	Benchmarks for the delta varint waypoint codec.
+ *              Reports the compression ratio of taught programs, their
+ *              upload time over 400kHz I2C as float, quantized and
+ *              compressed segmented messages, and decode cycles per
+ *              waypoint.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#include "waypoint_codec.hpp"
+#include "segmented_transfer.hpp"
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace Robotics;
+using namespace Communication;
+
+namespace Benchmarks {
+
+    constexpr size_t PROGRAM_WAYPOINTS = 10000;
+
+    /**
+     * @brief Program as taught: smooth moves sampled every 10ms with pauses in between, and some
+     *        sensor noise on the recorded joint values.
+     */
+    static std::vector<Waypoint_t> taughtProgram(size_t waypoints)
+    {
+        std::mt19937 generator(3);
+        std::normal_distribution<float> noise(0.0f, 2e-4f);
+        std::uniform_real_distribution<float> target(-2.5f, 2.5f);
+        std::vector<Waypoint_t> program;
+        float from[NUM_JOINTS] = {0};
+        while (program.size() < waypoints)
+        {
+            float to[NUM_JOINTS];
+            for (float & joint : to)
+            {
+                joint = target(generator);
+            }
+            // A 2s move with a smooth velocity profile followed by a 0.5s pause
+            for (int step = 0; step < 250 && program.size() < waypoints; step++)
+            {
+                float s = std::min(1.0f, step / 200.0f);
+                float blend = 0.5f - 0.5f * std::cos(PI * s);
+                float joints[NUM_JOINTS];
+                for (size_t i = 0; i < NUM_JOINTS; i++)
+                {
+                    joints[i] = from[i] + (to[i] - from[i]) * blend + noise(generator);
+                }
+                Waypoint_t waypoint;
+                memcpy(&waypoint, joints, sizeof(joints));
+                program.push_back(waypoint);
+            }
+            memcpy(from, to, sizeof(from));
+        }
+        return program;
+    }
+
+    static std::vector<QuantizedWaypoint_t> quantizeProgram(const std::vector<Waypoint_t> & program, const WaypointScale_t & scale)
+    {
+        std::vector<QuantizedWaypoint_t> quantized;
+        for (const Waypoint_t & waypoint : program)
+        {
+            quantized.push_back(quantize(waypoint, scale));
+        }
+        return quantized;
+    }
+
+    static std::vector<uint8_t> compressProgram(const std::vector<QuantizedWaypoint_t> & program, const WaypointScale_t & scale)
+    {
+        std::vector<uint8_t> message(reinterpret_cast<const uint8_t *>(&scale), reinterpret_cast<const uint8_t *>(&scale + 1));
+        WaypointEncoder encoder;
+        uint8_t out[MAX_ENCODED_WAYPOINT];
+        for (const QuantizedWaypoint_t & waypoint : program)
+        {
+            message.insert(message.end(), out, out + encoder.encode(waypoint, out));
+        }
+        return message;
+    }
+
+    /**
+     * @brief Time to send a message as segmented frames at 400kHz: address, frame bytes of 9 bits,
+     *        START and STOP, and a one byte flow control read every frame as the master polls it.
+     */
+    static double uploadMs(const uint8_t * message, size_t length)
+    {
+        SegmentedSender sender(0x09, message, static_cast<uint32_t>(length));
+        uint8_t frame[BUFFER_SIZE];
+        size_t frameLength;
+        double bits = 0;
+        while ((frameLength = sender.nextFrame(frame)) != 0)
+        {
+            bits += 2 + 9 * (1 + frameLength);
+            bits += 2 + 9 * (1 + 1);
+        }
+        return bits / 400.0;
+    }
+
+    static size_t sinkedWaypoints = 0;
+
+    static void countWaypoints(const QuantizedWaypoint_t * waypoints, size_t count)
+    {
+        benchmark::DoNotOptimize(waypoints);
+        sinkedWaypoints += count;
+    }
+
+    /**
+     * @brief Decode of a 10k waypoint taught program fed in frame sized pieces, as received.
+     */
+    static void BM_DecodeProgram(benchmark::State & state)
+    {
+        WaypointScale_t scale = coordinateScale();
+        std::vector<Waypoint_t> program = taughtProgram(PROGRAM_WAYPOINTS);
+        std::vector<QuantizedWaypoint_t> quantized = quantizeProgram(program, scale);
+        std::vector<uint8_t> compressed = compressProgram(quantized, scale);
+        const uint8_t * stream = compressed.data() + sizeof(WaypointScale_t);
+        size_t streamLength = compressed.size() - sizeof(WaypointScale_t);
+
+        WaypointDecoder decoder(countWaypoints);
+        auto start = std::chrono::steady_clock::now();
+        for (auto _ : state)
+        {
+            decoder.reset();
+            for (size_t offset = 0; offset < streamLength; offset += BUFFER_SIZE - 2)
+            {
+                decoder.decode(stream + offset, std::min(BUFFER_SIZE - 2, streamLength - offset));
+            }
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        double waypoints = static_cast<double>(state.iterations() * PROGRAM_WAYPOINTS);
+        double cycles = elapsed.count() * benchmark::CPUInfo::Get().cycles_per_second;
+        size_t floatBytes = program.size() * sizeof(Waypoint_t);
+        size_t quantizedBytes = sizeof(WaypointScale_t) + quantized.size() * sizeof(QuantizedWaypoint_t);
+
+        state.SetItemsProcessed(static_cast<int64_t>(waypoints));
+        state.counters["cycles_per_waypoint"] = cycles / waypoints;
+        state.counters["bytes_per_waypoint"] = static_cast<double>(streamLength) / PROGRAM_WAYPOINTS;
+        state.counters["ratio_vs_float"] = static_cast<double>(floatBytes) / static_cast<double>(compressed.size());
+        state.counters["ratio_vs_quantized"] = static_cast<double>(quantizedBytes) / static_cast<double>(compressed.size());
+        state.counters["upload_ms_float"] = uploadMs(reinterpret_cast<const uint8_t *>(program.data()), floatBytes);
+        state.counters["upload_ms_quantized"] = uploadMs(reinterpret_cast<const uint8_t *>(&scale), 0) +
+                                                uploadMs(reinterpret_cast<const uint8_t *>(quantized.data()), quantizedBytes - sizeof(WaypointScale_t));
+        state.counters["upload_ms_compressed"] = uploadMs(compressed.data(), compressed.size());
+    }
+    BENCHMARK(BM_DecodeProgram)->Unit(benchmark::kMicrosecond);
+
+    /**
+     * @brief Encode of a 10k waypoint taught program, as done by the master.
+     */
+    static void BM_EncodeProgram(benchmark::State & state)
+    {
+        std::vector<QuantizedWaypoint_t> quantized = quantizeProgram(taughtProgram(PROGRAM_WAYPOINTS), coordinateScale());
+        WaypointEncoder encoder;
+        uint8_t out[MAX_ENCODED_WAYPOINT];
+        for (auto _ : state)
+        {
+            encoder.reset();
+            for (const QuantizedWaypoint_t & waypoint : quantized)
+            {
+                size_t length = encoder.encode(waypoint, out);
+                benchmark::DoNotOptimize(out);
+                benchmark::DoNotOptimize(length);
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * PROGRAM_WAYPOINTS);
+    }
+    BENCHMARK(BM_EncodeProgram)->Unit(benchmark::kMicrosecond);
+
+} // namespace Benchmarks
@@ -0,0 +1,15 @@
+#pragma once
+#include <cstdint>
+
+typedef volatile uint32_t io_rw_32;
+
+// Set and clear aliases of the peripheral registers, as read-modify-write on the host
+inline void hw_set_bits(io_rw_32 * addr, uint32_t mask)
+{
+    *addr = *addr | mask;
+}
+
+inline void hw_clear_bits(io_rw_32 * addr, uint32_t mask)
+{
+    *addr = *addr & ~mask;
+}
@@ -0,0 +1,301 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+typedef unsigned int uint;
+
+enum dma_channel_transfer_size
+{
+    DMA_SIZE_8 = 0,
+    DMA_SIZE_16 = 1,
+    DMA_SIZE_32 = 2
+};
+
+typedef struct
+{
+    dma_channel_transfer_size size;
+    bool readIncrement;
+    bool writeIncrement;
+    uint dreq;
+    bool sniff;
+    bool ringWrite;
+    uint ringBits;
+} dma_channel_config;
+
+// Addresses are pointer sized on the host
+typedef struct
+{
+    volatile uintptr_t read_addr;
+    volatile uintptr_t write_addr;
+    volatile uint32_t transfer_count;
+    volatile uint32_t ctrl_trig;
+} dma_channel_hw_t;
+
+#define NUM_DMA_CHANNELS 16
+#define DREQ_FORCE 0x3F
+#define DMA_SNIFF_CTRL_CALC_VALUE_CRC32 0x0
+#define DMA_SNIFF_CTRL_CALC_VALUE_CRC32R 0x1
+
+// Mock state of a DMA channel
+struct MockDmaChannel
+{
+    dma_channel_hw_t hw;
+    dma_channel_config config;
+    bool claimed;
+    bool busy;
+    uint aborts;
+};
+
+inline MockDmaChannel mockDmaChannels[NUM_DMA_CHANNELS];
+
+inline int dma_claim_unused_channel(bool required)
+{
+    for (uint i = 0; i < NUM_DMA_CHANNELS; i++)
+    {
+        if (!mockDmaChannels[i].claimed)
+        {
+            mockDmaChannels[i] = MockDmaChannel{};
+            mockDmaChannels[i].claimed = true;
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+inline void dma_channel_unclaim(uint channel)
+{
+    mockDmaChannels[channel].claimed = false;
+}
+
+inline dma_channel_config dma_channel_get_default_config(uint channel)
+{
+    return dma_channel_config{DMA_SIZE_32, true, false, DREQ_FORCE, false, false, 0};
+}
+
+inline void channel_config_set_transfer_data_size(dma_channel_config * c, dma_channel_transfer_size size)
+{
+    c->size = size;
+}
+
+inline void channel_config_set_read_increment(dma_channel_config * c, bool incr)
+{
+    c->readIncrement = incr;
+}
+
+inline void channel_config_set_write_increment(dma_channel_config * c, bool incr)
+{
+    c->writeIncrement = incr;
+}
+
+inline void channel_config_set_dreq(dma_channel_config * c, uint dreq)
+{
+    c->dreq = dreq;
+}
+
+inline void channel_config_set_sniff_enable(dma_channel_config * c, bool sniff)
+{
+    c->sniff = sniff;
+}
+
+inline void channel_config_set_ring(dma_channel_config * c, bool write, uint size_bits)
+{
+    c->ringWrite = write;
+    c->ringBits = size_bits;
+}
+
+inline dma_channel_hw_t * dma_channel_hw_addr(uint channel)
+{
+    return &mockDmaChannels[channel].hw;
+}
+
+inline void dma_channel_configure(uint channel, const dma_channel_config * config, volatile void * write_addr,
+                                  const volatile void * read_addr, uint transfer_count, bool trigger)
+{
+    MockDmaChannel & ch = mockDmaChannels[channel];
+    ch.config = *config;
+    ch.hw.write_addr = reinterpret_cast<uintptr_t>(write_addr);
+    ch.hw.read_addr = reinterpret_cast<uintptr_t>(read_addr);
+    ch.hw.transfer_count = transfer_count;
+    ch.busy = trigger && transfer_count > 0;
+}
+
+inline void dma_channel_set_config(uint channel, const dma_channel_config * config, bool trigger)
+{
+    mockDmaChannels[channel].config = *config;
+}
+
+// Mock state of the DMA sniffer
+struct MockDmaSniffer
+{
+    bool enabled;
+    uint channel;
+    uint mode;
+    bool outputReverse;
+    bool outputInvert;
+    uint32_t accumulator;
+};
+
+inline MockDmaSniffer mockDmaSniffer;
+
+inline void dma_sniffer_enable(uint channel, uint mode, bool force_channel_enable)
+{
+    mockDmaSniffer.enabled = true;
+    mockDmaSniffer.channel = channel;
+    mockDmaSniffer.mode = mode;
+}
+
+inline void dma_sniffer_disable()
+{
+    mockDmaSniffer = MockDmaSniffer{};
+}
+
+inline void dma_sniffer_set_output_reverse_enabled(bool enable)
+{
+    mockDmaSniffer.outputReverse = enable;
+}
+
+inline void dma_sniffer_set_output_invert_enabled(bool enable)
+{
+    mockDmaSniffer.outputInvert = enable;
+}
+
+inline void dma_sniffer_set_data_accumulator(uint32_t seed)
+{
+    mockDmaSniffer.accumulator = seed;
+}
+
+inline uint32_t mockBitReverse(uint32_t value, uint bits)
+{
+    uint32_t result = 0;
+    for (uint i = 0; i < bits; i++)
+    {
+        result = (result << 1) | ((value >> i) & 1);
+    }
+    return result;
+}
+
+// Read transformations are applied on the way out, as the hardware does
+inline uint32_t dma_sniffer_get_data_accumulator()
+{
+    uint32_t value = mockDmaSniffer.accumulator;
+    if (mockDmaSniffer.outputReverse)
+    {
+        value = mockBitReverse(value, 32);
+    }
+    if (mockDmaSniffer.outputInvert)
+    {
+        value = ~value;
+    }
+    return value;
+}
+
+// Feed a byte to the sniffer: MSB first CRC-32 (0x04C11DB7), data bit reversed in CRC32R mode
+inline void mockDmaSniff(uint channel, uint8_t byte)
+{
+    if (!mockDmaSniffer.enabled || mockDmaSniffer.channel != channel || !mockDmaChannels[channel].config.sniff)
+    {
+        return;
+    }
+    uint32_t data = (mockDmaSniffer.mode == DMA_SNIFF_CTRL_CALC_VALUE_CRC32R) ? mockBitReverse(byte, 8) : byte;
+    uint32_t crc = mockDmaSniffer.accumulator ^ (data << 24);
+    for (int bit = 0; bit < 8; bit++)
+    {
+        crc = (crc & 0x80000000u) ? ((crc << 1) ^ 0x04C11DB7u) : (crc << 1);
+    }
+    mockDmaSniffer.accumulator = crc;
+}
+
+inline void dma_channel_transfer_to_buffer_now(uint channel, volatile void * write_addr, uint32_t transfer_count)
+{
+    MockDmaChannel & ch = mockDmaChannels[channel];
+    ch.hw.write_addr = reinterpret_cast<uintptr_t>(write_addr);
+    ch.hw.transfer_count = transfer_count;
+    ch.busy = transfer_count > 0;
+}
+
+inline void dma_channel_transfer_from_buffer_now(uint channel, const volatile void * read_addr, uint32_t transfer_count)
+{
+    MockDmaChannel & ch = mockDmaChannels[channel];
+    ch.hw.read_addr = reinterpret_cast<uintptr_t>(read_addr);
+    ch.hw.transfer_count = transfer_count;
+    ch.busy = transfer_count > 0;
+}
+
+inline void dma_channel_abort(uint channel)
+{
+    mockDmaChannels[channel].busy = false;
+    mockDmaChannels[channel].aborts++;
+}
+
+inline bool dma_channel_is_busy(uint channel)
+{
+    return mockDmaChannels[channel].busy;
+}
+
+// Find the busy channel paced by a DREQ, -1 if none
+inline int mockDmaChannelFor(uint dreq)
+{
+    for (uint i = 0; i < NUM_DMA_CHANNELS; i++)
+    {
+        if (mockDmaChannels[i].claimed && mockDmaChannels[i].busy && mockDmaChannels[i].config.dreq == dreq)
+        {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+// Move one item from memory to the peripheral, as if the channel's DREQ was asserted
+inline bool mockDmaPull(uint channel, uint32_t & value)
+{
+    MockDmaChannel & ch = mockDmaChannels[channel];
+    if (!ch.busy)
+    {
+        return false;
+    }
+    size_t size = size_t(1) << ch.config.size;
+    const uint8_t * src = reinterpret_cast<const uint8_t *>(ch.hw.read_addr);
+    value = 0;
+    for (size_t i = 0; i < size; i++)
+    {
+        value |= static_cast<uint32_t>(src[i]) << (8 * i);
+    }
+    if (ch.config.readIncrement)
+    {
+        ch.hw.read_addr = ch.hw.read_addr + size;
+    }
+    ch.hw.transfer_count = ch.hw.transfer_count - 1;
+    ch.busy = ch.hw.transfer_count > 0;
+    return true;
+}
+
+// Move one item from the peripheral to memory, as if the channel's DREQ was asserted
+inline bool mockDmaPush(uint channel, uint32_t value)
+{
+    MockDmaChannel & ch = mockDmaChannels[channel];
+    if (!ch.busy)
+    {
+        return false;
+    }
+    size_t size = size_t(1) << ch.config.size;
+    uint8_t * dst = reinterpret_cast<uint8_t *>(ch.hw.write_addr);
+    for (size_t i = 0; i < size; i++)
+    {
+        dst[i] = static_cast<uint8_t>(value >> (8 * i));
+        mockDmaSniff(channel, dst[i]);
+    }
+    if (ch.config.writeIncrement)
+    {
+        uintptr_t next = ch.hw.write_addr + size;
+        if (ch.config.ringWrite && ch.config.ringBits > 0)
+        {
+            // Only the low ringBits of the address change
+            uintptr_t mask = (uintptr_t(1) << ch.config.ringBits) - 1;
+            next = (ch.hw.write_addr & ~mask) | (next & mask);
+        }
+        ch.hw.write_addr = next;
+    }
+    ch.hw.transfer_count = ch.hw.transfer_count - 1;
+    ch.busy = ch.hw.transfer_count > 0;
+    return true;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+
+typedef unsigned int uint;
+
+#define GPIO_IN false
+#define GPIO_OUT true
+#define GPIO_FUNC_SPI 1
+#define GPIO_FUNC_UART 2
+#define GPIO_FUNC_I2C 3
+
+#define GPIO_IRQ_EDGE_FALL 0x4u
+#define GPIO_IRQ_EDGE_RISE 0x8u
+
+typedef void (*gpio_irq_callback_t)(uint gpio, uint32_t event_mask);
+
+inline gpio_irq_callback_t mockGpioIrqCallback = nullptr;
+inline uint32_t mockGpioIrqEvents[48] = {0};
+
+inline void gpio_set_dir(uint gpio, bool out)
+{
+    // do nothing
+}
+
+inline void gpio_set_function(uint gpio, int fn)
+{
+    // do nothing
+}
+
+inline void gpio_pull_up(uint gpio)
+{
+    // do nothing
+}
+
+inline void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t event_mask, bool enabled, gpio_irq_callback_t callback)
+{
+    mockGpioIrqEvents[gpio] = enabled ? event_mask : 0;
+    mockGpioIrqCallback = callback;
+}
+
+// Raise the edge interrupts of a pin, as if its level changed
+inline void mockGpioEdge(uint gpio, uint32_t event)
+{
+    if (mockGpioIrqCallback != nullptr && (mockGpioIrqEvents[gpio] & event))
+    {
+        mockGpioIrqCallback(gpio, event);
+    }
+}
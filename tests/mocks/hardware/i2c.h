@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include "hardware/address_mapped.h"
+
+typedef unsigned int uint;
+
+// Registers of i2c hardware used by the library
+typedef struct
+{
+    volatile uint32_t data_cmd;
+    volatile uint32_t intr_stat;
+    volatile uint32_t intr_mask;
+    volatile uint32_t clr_tx_abrt;
+    volatile uint32_t clr_rd_req;
+    volatile uint32_t clr_start_det;
+    volatile uint32_t clr_stop_det;
+    volatile uint32_t dma_cr;
+} i2c_hw_t;
+
+typedef struct i2c_inst
+{
+    i2c_hw_t * hw;
+    uint baudrate;
+    bool slave;
+    uint8_t address;
+} i2c_inst_t;
+
+inline i2c_hw_t mockI2c0Hw{};
+inline i2c_inst_t mockI2c0Inst{&mockI2c0Hw, 0, false, 0};
+
+#define i2c0_hw (&mockI2c0Hw)
+#define i2c0 (&mockI2c0Inst)
+
+#define PICO_DEFAULT_I2C_SDA_PIN 4
+#define PICO_DEFAULT_I2C_SCL_PIN 5
+
+// Values only used to identify the DMA request lines
+#define DREQ_I2C0_TX 44
+#define DREQ_I2C0_RX 45
+
+inline uint i2c_init(i2c_inst_t * i2c, uint baudrate)
+{
+    // The block is reset, as the SDK does
+    *i2c->hw = i2c_hw_t{};
+    i2c->baudrate = baudrate;
+    return baudrate;
+}
+
+inline void i2c_set_slave_mode(i2c_inst_t * i2c, bool slave, uint8_t addr)
+{
+    i2c->slave = slave;
+    i2c->address = addr;
+}
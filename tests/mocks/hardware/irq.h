@@ -0,0 +1,20 @@
+#pragma once
+
+typedef unsigned int uint;
+typedef void (*irq_handler_t)(void);
+
+#define I2C0_IRQ 36
+#define NUM_IRQS 64
+
+inline irq_handler_t mockIrqHandlers[NUM_IRQS] = {nullptr};
+inline bool mockIrqEnabled[NUM_IRQS] = {false};
+
+inline void irq_set_exclusive_handler(uint num, irq_handler_t handler)
+{
+    mockIrqHandlers[num] = handler;
+}
+
+inline void irq_set_enabled(uint num, bool enabled)
+{
+    mockIrqEnabled[num] = enabled;
+}
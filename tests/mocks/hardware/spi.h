@@ -0,0 +1,76 @@
+#pragma once
+#include <cstdint>
+
+typedef unsigned int uint;
+
+// Registers of spi hardware used by the library
+typedef struct
+{
+    volatile uint32_t dr;
+    volatile uint32_t dmacr;
+} spi_hw_t;
+
+typedef struct spi_inst
+{
+    spi_hw_t * hw;
+    uint index;
+    uint baudrate;
+    bool slave;
+} spi_inst_t;
+
+typedef enum
+{
+    SPI_CPOL_0 = 0,
+    SPI_CPOL_1 = 1
+} spi_cpol_t;
+
+typedef enum
+{
+    SPI_CPHA_0 = 0,
+    SPI_CPHA_1 = 1
+} spi_cpha_t;
+
+typedef enum
+{
+    SPI_LSB_FIRST = 0,
+    SPI_MSB_FIRST = 1
+} spi_order_t;
+
+inline spi_hw_t mockSpiHw[2]{};
+inline spi_inst_t mockSpiInst[2]{{&mockSpiHw[0], 0, 0, false}, {&mockSpiHw[1], 1, 0, false}};
+
+#define spi0 (&mockSpiInst[0])
+#define spi1 (&mockSpiInst[1])
+
+// Values only used to identify the DMA request lines
+#define DREQ_SPI0_TX 24
+#define DREQ_SPI0_RX 25
+#define DREQ_SPI1_TX 26
+#define DREQ_SPI1_RX 27
+
+inline uint spi_init(spi_inst_t * spi, uint baudrate)
+{
+    spi->baudrate = baudrate;
+    spi->hw->dmacr = 0x3; // TX and RX DMA requests enabled, as the SDK does
+    return baudrate;
+}
+
+inline void spi_set_format(spi_inst_t * spi, uint data_bits, spi_cpol_t cpol, spi_cpha_t cpha, spi_order_t order)
+{
+    // do nothing
+}
+
+inline void spi_set_slave(spi_inst_t * spi, bool slave)
+{
+    spi->slave = slave;
+}
+
+inline spi_hw_t * spi_get_hw(spi_inst_t * spi)
+{
+    return spi->hw;
+}
+
+inline uint spi_get_dreq(spi_inst_t * spi, bool is_tx)
+{
+    return DREQ_SPI0_TX + spi->index * 2 + (is_tx ? 0 : 1);
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include <cstdint>
+
+// Microseconds since boot, advanced by the tests
+inline uint64_t mockTimeUs = 0;
+
+inline uint32_t time_us_32()
+{
+    return static_cast<uint32_t>(mockTimeUs);
+}
+
+inline uint64_t time_us_64()
+{
+    return mockTimeUs;
+}
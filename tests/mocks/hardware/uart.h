@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+
+typedef unsigned int uint;
+
+// Registers of uart hardware used by the library
+typedef struct
+{
+    volatile uint32_t dr;
+    volatile uint32_t dmacr;
+} uart_hw_t;
+
+typedef struct uart_inst
+{
+    uart_hw_t * hw;
+    uint index;
+    uint baudrate;
+} uart_inst_t;
+
+inline uart_hw_t mockUartHw[2]{};
+inline uart_inst_t mockUartInst[2]{{&mockUartHw[0], 0, 0}, {&mockUartHw[1], 1, 0}};
+
+#define uart0 (&mockUartInst[0])
+#define uart1 (&mockUartInst[1])
+
+// Values only used to identify the DMA request lines
+#define DREQ_UART0_TX 28
+#define DREQ_UART0_RX 29
+#define DREQ_UART1_TX 30
+#define DREQ_UART1_RX 31
+
+inline uint uart_init(uart_inst_t * uart, uint baudrate)
+{
+    uart->baudrate = baudrate;
+    uart->hw->dmacr = 0x3; // TX and RX DMA requests enabled, as the SDK does
+    return baudrate;
+}
+
+inline uart_hw_t * uart_get_hw(uart_inst_t * uart)
+{
+    return uart->hw;
+}
+
+inline uint uart_get_dreq(uart_inst_t * uart, bool is_tx)
+{
+    return DREQ_UART0_TX + uart->index * 2 + (is_tx ? 0 : 1);
+}
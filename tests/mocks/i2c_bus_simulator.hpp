@@ -0,0 +1,319 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include <functional>
+#include "hardware/i2c.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/timer.h"
+#include "i2c_slave.hpp"
+
+namespace Mocks {
+
+    /**
+     * @brief Register level model of the i2c0 slave, its RX FIFO and the DMA channels paced by it,
+     *        driven by a scripted master on a virtual clock (mockTimeUs).
+     *
+     * Bus events are scripted back to back at the bus bit rate, a byte taking 9 bit times. While
+     * running, each event sets the raw interrupt status, calls the installed I2C0_IRQ handler if
+     * the bit is unmasked, and moves data between the FIFO and the DMA channels whose DREQ is
+     * asserted. Periodic tasks (e.g. the main loop calling pump()) run in between, at their time.
+     */
+    class I2CBusSimulator
+    {
+        public:
+            static constexpr size_t RX_FIFO_DEPTH = 16;
+
+            explicit I2CBusSimulator(uint baudRate = Communication::Hardware::DEFAULT_I2C_BAUD_RATE)
+                : bitTimeUs(1e6 / baudRate), cursorUs(static_cast<double>(mockTimeUs)) {}
+
+            /**
+             * @brief Script a master write: START, bytes, STOP.
+             */
+            I2CBusSimulator & write(const std::vector<uint8_t> & bytes)
+            {
+                schedule(EventType::Start, 0, bitTimeUs);
+                for (uint8_t byte : bytes)
+                {
+                    schedule(EventType::WriteByte, byte, 9 * bitTimeUs);
+                }
+                schedule(EventType::Stop, 0, bitTimeUs);
+                return *this;
+            }
+
+            /**
+             * @brief Script a master read of count bytes: START, read requests, optional STOP.
+             */
+            I2CBusSimulator & read(size_t count, bool stop = true)
+            {
+                schedule(EventType::Start, 0, bitTimeUs);
+                for (size_t i = 0; i < count; i++)
+                {
+                    schedule(EventType::ReadByte, 0, 9 * bitTimeUs);
+                }
+                if (stop)
+                {
+                    schedule(EventType::Stop, 0, bitTimeUs);
+                }
+                return *this;
+            }
+
+            /**
+             * @brief Script a transmit abort followed by a STOP, as when the master stops a read early.
+             */
+            I2CBusSimulator & abort()
+            {
+                schedule(EventType::Abort, 0, bitTimeUs);
+                return *this;
+            }
+
+            /**
+             * @brief Script a bus idle time.
+             */
+            I2CBusSimulator & idle(double us)
+            {
+                cursorUs += us;
+                return *this;
+            }
+
+            /**
+             * @brief Run a task every periodUs of virtual time, starting one period from now.
+             */
+            void every(uint64_t periodUs, std::function<void()> task)
+            {
+                tasks.push_back({periodUs, mockTimeUs + periodUs, std::move(task)});
+            }
+
+            /**
+             * @brief Play the whole script.
+             */
+            void run()
+            {
+                while (!script.empty())
+                {
+                    Event event = script.front();
+                    script.pop_front();
+                    runTasksUntil(event.timeUs);
+                    mockTimeUs = event.timeUs;
+                    play(event);
+                }
+            }
+
+            /**
+             * @brief Play the script, then let the virtual clock run until timeUs.
+             */
+            void runUntil(uint64_t timeUs)
+            {
+                run();
+                runTasksUntil(timeUs);
+                if (timeUs > mockTimeUs)
+                {
+                    mockTimeUs = timeUs;
+                }
+                if (cursorUs < timeUs)
+                {
+                    cursorUs = static_cast<double>(timeUs);
+                }
+            }
+
+            /**
+             * @brief Bytes read by the master since the last call.
+             */
+            std::vector<uint8_t> takeReadBytes()
+            {
+                std::vector<uint8_t> bytes;
+                bytes.swap(readBytes);
+                return bytes;
+            }
+
+            /**
+             * @brief Number of handler calls that served an interrupt status bit.
+             */
+            uint32_t interrupts(uint32_t status) const
+            {
+                uint32_t count = 0;
+                for (size_t bit = 0; bit < 32; bit++)
+                {
+                    if (status & (1u << bit))
+                    {
+                        count += irqCount[bit];
+                    }
+                }
+                return count;
+            }
+
+            /**
+             * @brief Bytes lost because the RX FIFO was full.
+             */
+            uint32_t rxOverruns() const
+            {
+                return overruns;
+            }
+
+            /**
+             * @brief Data words the slave wrote to data_cmd with CMD, STOP or RESTART bits set.
+             */
+            uint32_t badTxWords() const
+            {
+                return badWords;
+            }
+
+        private:
+            enum class EventType
+            {
+                Start,
+                WriteByte,
+                ReadByte,
+                Stop,
+                Abort
+            };
+
+            struct Event
+            {
+                uint64_t timeUs;
+                EventType type;
+                uint8_t data;
+            };
+
+            struct Task
+            {
+                uint64_t periodUs;
+                uint64_t nextUs;
+                std::function<void()> run;
+            };
+
+            void schedule(EventType type, uint8_t data, double durationUs)
+            {
+                if (script.empty() && cursorUs < mockTimeUs)
+                {
+                    cursorUs = static_cast<double>(mockTimeUs);
+                }
+                cursorUs += durationUs;
+                script.push_back({static_cast<uint64_t>(cursorUs), type, data});
+            }
+
+            void runTasksUntil(uint64_t timeUs)
+            {
+                bool ran = true;
+                while (ran)
+                {
+                    ran = false;
+                    for (Task & task : tasks)
+                    {
+                        if (task.nextUs <= timeUs)
+                        {
+                            mockTimeUs = task.nextUs;
+                            task.nextUs += task.periodUs;
+                            task.run();
+                            ran = true;
+                        }
+                    }
+                }
+            }
+
+            void raise(uint32_t status)
+            {
+                mockI2c0Hw.intr_stat = status;
+                if ((status & mockI2c0Hw.intr_mask) && mockIrqEnabled[I2C0_IRQ] && mockIrqHandlers[I2C0_IRQ] != nullptr)
+                {
+                    for (size_t bit = 0; bit < 32; bit++)
+                    {
+                        if (status & mockI2c0Hw.intr_mask & (1u << bit))
+                        {
+                            irqCount[bit]++;
+                        }
+                    }
+                    mockIrqHandlers[I2C0_IRQ]();
+                }
+                mockI2c0Hw.intr_stat = 0;
+            }
+
+            // The RX DREQ is asserted while the FIFO holds data
+            void drainRxFifo()
+            {
+                if (!(mockI2c0Hw.dma_cr & DMA_RX))
+                {
+                    return;
+                }
+                int channel = mockDmaChannelFor(DREQ_I2C0_RX);
+                while (channel >= 0 && !rxFifo.empty() && mockDmaPush(channel, rxFifo.front()))
+                {
+                    rxFifo.pop_front();
+                }
+            }
+
+            void play(const Event & event)
+            {
+                switch (event.type)
+                {
+                    case EventType::Start:
+                        raise(START_DET);
+                        drainRxFifo();
+                        break;
+                    case EventType::WriteByte:
+                        if (rxFifo.size() == RX_FIFO_DEPTH)
+                        {
+                            overruns++;
+                            break;
+                        }
+                        rxFifo.push_back(event.data);
+                        drainRxFifo();
+                        // Without DMA the handler reads each byte
+                        if (!rxFifo.empty() && (mockI2c0Hw.intr_mask & RX_FULL))
+                        {
+                            mockI2c0Hw.data_cmd = rxFifo.front();
+                            rxFifo.pop_front();
+                            raise(RX_FULL);
+                        }
+                        break;
+                    case EventType::ReadByte:
+                        readBytes.push_back(readByte());
+                        break;
+                    case EventType::Stop:
+                        raise(STOP_DET);
+                        break;
+                    case EventType::Abort:
+                        raise(TX_ABRT | STOP_DET);
+                        break;
+                }
+            }
+
+            // The clock is stretched until the TX FIFO holds a byte, from the DMA or the handler
+            uint8_t readByte()
+            {
+                uint32_t value = 0;
+                int channel = mockDmaChannelFor(DREQ_I2C0_TX);
+                if (channel < 0)
+                {
+                    mockI2c0Hw.data_cmd = 0;
+                    raise(RD_REQ);
+                    channel = mockDmaChannelFor(DREQ_I2C0_TX);
+                    if (channel < 0)
+                    {
+                        value = mockI2c0Hw.data_cmd;
+                    }
+                }
+                if (channel >= 0)
+                {
+                    mockDmaPull(channel, value);
+                }
+                if (value & ~static_cast<uint32_t>(DAT))
+                {
+                    badWords++;
+                }
+                return static_cast<uint8_t>(value & DAT);
+            }
+
+            double bitTimeUs;
+            double cursorUs;
+            std::deque<Event> script;
+            std::vector<Task> tasks;
+            std::deque<uint8_t> rxFifo;
+            std::vector<uint8_t> readBytes;
+            uint32_t irqCount[32] = {0};
+            uint32_t overruns = 0;
+            uint32_t badWords = 0;
+    };
+
+} // namespace Mocks
@@ -0,0 +1,19 @@
+#pragma once
+#include <thread>
+
+// Core1 runs as a host thread
+inline std::thread mockCore1;
+
+inline void multicore_launch_core1(void (*entry)(void))
+{
+    mockCore1 = std::thread(entry);
+}
+
+// Waits for the core1 entry to return, instead of resetting the core
+inline void multicore_reset_core1()
+{
+    if (mockCore1.joinable())
+    {
+        mockCore1.join();
+    }
+}
@@ -0,0 +1,8 @@
+#pragma once
+#include <thread>
+
+// Busy wait body, gives the other "core" thread a chance to run on the host
+inline void tight_loop_contents()
+{
+    std::this_thread::yield();
+}
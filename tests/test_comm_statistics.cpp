@@ -0,0 +1,92 @@
+/***********************************************************************
+ * @file	:	test_comm_statistics.cpp
+ * @brief 	:	Test cases for the communication statistics block.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#include "comm_statistics.hpp"
+#include <gtest/gtest.h>
+
+using namespace Communication;
+
+namespace Tests {
+
+    static_assert(Log2Histogram::bucketOf(0) == 0);
+    static_assert(Log2Histogram::bucketOf(1) == 1);
+    static_assert(Log2Histogram::bucketOf(3) == 2);
+    static_assert(Log2Histogram::bucketOf(4) == 3);
+    static_assert(Log2Histogram::bucketOf(0xFFFFFFFF) == HISTOGRAM_BUCKETS - 1);
+
+    /**
+     * @test Verifies that samples land in their power of 2 bucket, large ones in the last bucket.
+     */
+    TEST(CommStatisticsTest, Log2Histogram)
+    {
+        Log2Histogram histogram;
+        for (uint32_t sample : {0u, 1u, 2u, 3u, 100u, 1u << 20})
+        {
+            histogram.record(sample);
+        }
+        EXPECT_EQ(histogram.count(0), 1u);
+        EXPECT_EQ(histogram.count(1), 1u);
+        EXPECT_EQ(histogram.count(2), 2u);
+        EXPECT_EQ(histogram.count(7), 1u);
+        EXPECT_EQ(histogram.count(HISTOGRAM_BUCKETS - 1), 1u);
+
+        histogram.reset();
+        for (size_t i = 0; i < HISTOGRAM_BUCKETS; i++)
+        {
+            EXPECT_EQ(histogram.count(i), 0u);
+        }
+    }
+
+    /**
+     * @test Verifies that the high watermark keeps the largest sample.
+     */
+    TEST(CommStatisticsTest, HighWatermark)
+    {
+        HighWatermark watermark;
+        watermark.update(3);
+        watermark.update(1);
+        EXPECT_EQ(watermark.get(), 3u);
+        watermark.update(4);
+        EXPECT_EQ(watermark.get(), 4u);
+    }
+
+    /**
+     * @test Verifies the snapshot word layout.
+     */
+    TEST(CommStatisticsTest, SnapshotWords)
+    {
+        CommStatistics stats;
+        stats.frames.increment();
+        stats.frames.increment();
+        stats.unknownIds.increment();
+        stats.pendingFrames.update(3);
+        stats.ringWraps.increment();
+        stats.transactionLatency.record(100);
+        stats.isrDuration.record(1);
+        stats.messages[0x42].increment();
+
+        auto word = [&](size_t index) { return stats.word(index, 5, 6); };
+        EXPECT_EQ(word(static_cast<size_t>(StatWord::Frames)), 2u);
+        EXPECT_EQ(word(static_cast<size_t>(StatWord::UnknownIds)), 1u);
+        EXPECT_EQ(word(static_cast<size_t>(StatWord::DroppedFrames)), 5u);
+        EXPECT_EQ(word(static_cast<size_t>(StatWord::CorruptedFrames)), 6u);
+        EXPECT_EQ(word(static_cast<size_t>(StatWord::PendingHighWatermark)), 3u);
+        EXPECT_EQ(word(static_cast<size_t>(StatWord::RingWraps)), 1u);
+        EXPECT_EQ(word(static_cast<size_t>(StatWord::RingOverruns)), 0u);
+        EXPECT_EQ(word(static_cast<size_t>(StatWord::TransactionLatency) + 7), 1u);
+        EXPECT_EQ(word(static_cast<size_t>(StatWord::IsrDuration) + 1), 1u);
+        EXPECT_EQ(word(static_cast<size_t>(StatWord::MessageCounts) + 0x42), 1u);
+        EXPECT_EQ(word(static_cast<size_t>(StatWord::Count)), 0u);
+
+        stats.reset();
+        for (size_t i = 0; i < static_cast<size_t>(StatWord::Count); i++)
+        {
+            EXPECT_EQ(stats.word(i), 0u);
+        }
+    }
+
+} // namespace Tests
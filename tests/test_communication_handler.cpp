@@ -8,6 +8,8 @@
 #include "communication_handler.hpp"
 #include "reset.hpp"
 #include "fsm_state_manager.hpp"
+#include "waypoint_codec.hpp"
+#include "hardware/timer.h"
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
 #include <iostream>
@@ -17,6 +19,7 @@ using namespace Communication;
 using namespace Utilities;
 using ::testing::_;
 using ::testing::Invoke;
+using ::testing::Return;
 
 namespace Communication{
     namespace RobotArm{
@@ -36,7 +39,7 @@ namespace Tests {
     class MockStateManager : public StateMachine::RobotArm::FSMStateManager 
     {
         public:
-            MOCK_METHOD(void, handleEvent, (StateMachine::RobotArm::Event && event), (override));
+            MOCK_METHOD(bool, handleEvent, (StateMachine::RobotArm::Event && event), (override));
             MOCK_METHOD(StateMachine::RobotArm::StateId, getPerformingStateId, (), (const, override, noexcept));
     };
 
@@ -47,6 +50,8 @@ namespace Tests {
     {
         public:
             MOCK_METHOD(void, saveWaypoints, (const uint8_t* rawWaypoints, size_t size), (override));
+            MOCK_METHOD(void, setScale, (const Robotics::WaypointScale_t & scale), (override));
+            MOCK_METHOD(void, saveQuantizedWaypoints, (const uint8_t* rawWaypoints, size_t size), (override));
     };
 
     /**
@@ -60,6 +65,8 @@ namespace Tests {
              */
             void SetUp() override {
                 Communication::RobotArm::stateManager = &mockStateManager;
+                // Transfers or pages left by a previous test are not served
+                stopServices();
                 programData = std::make_shared<MockTrajectory>();
                 installDataContainer(programData);
             }
@@ -69,6 +76,8 @@ namespace Tests {
              */
             void TearDown() override {
                 uninstallDataContainer();
+                stopServices();
+                Communication::RobotArm::stateManager = StateMachine::RobotArm::FSMStateManager::getInstance();
             }
 
             MockStateManager mockStateManager;
@@ -96,6 +105,31 @@ namespace Tests {
         ASSERT_EQ(getContainer(), nullptr);
     }
 
+    /**
+     * @test Verifies that the dispatch table maps each registered id to its callback.
+     */
+    TEST(MessageTable, generation)
+    {
+        static_assert(messageDictionary[RAW(RxIds::EMERGENCY_STOP)] == emergencyStopCallback);
+        static_assert(messageDictionary[RAW(RxIds::PROGRAM_DATA)] == programDataCallback);
+        for (const auto & entry : messageEntries)
+        {
+            EXPECT_EQ(messageDictionary[RAW(entry.id)], entry.callback);
+        }
+        EXPECT_EQ(messageDictionary[0xFF], nullptr);
+    }
+
+    /**
+     * @test Verifies that duplicated message ids are detected at compile time.
+     */
+    TEST(MessageTable, duplicateIds)
+    {
+        constexpr MessageEntry unique[] = {{RxIds::LOAD, loadProgramCallback}, {RxIds::TEACH, teachProgramCallback}};
+        constexpr MessageEntry duplicated[] = {{RxIds::LOAD, loadProgramCallback}, {RxIds::LOAD, teachProgramCallback}};
+        static_assert(hasUniqueIds(unique));
+        static_assert(!hasUniqueIds(duplicated));
+    }
+
     /**
      * @test Verifies that the emergency stop callback triggers the correct event.
      */
@@ -105,6 +139,18 @@ namespace Tests {
         emergencyStopCallback(nullptr, 0);
     }
 
+    /**
+     * @test Verifies that requests are answered with the outcome of handleEvent(), the transition
+     *       being taken or refused by the state machine.
+     */
+    TEST_F(CommunicationHandlerTest, EventRequests)
+    {
+        EXPECT_CALL(mockStateManager, handleEvent(StateMachine::RobotArm::Event::Start)).WillOnce(Return(true));
+        EXPECT_EQ(startProgramCallback(nullptr, 0), ResponseCode::Positive);
+        EXPECT_CALL(mockStateManager, handleEvent(StateMachine::RobotArm::Event::Pause)).WillOnce(Return(false));
+        EXPECT_EQ(pauseProgramCallback(nullptr, 0), ResponseCode::ConditionsNotCorrect);
+    }
+
     /**
      * @test Verifies that the program data callback saves waypoints when the state is LoadProgram.
      */
@@ -161,6 +207,120 @@ namespace Tests {
         programDataCallback(nullptr, dataLength);
     }
 
+    /**
+     * @test Verifies that a segmented program is saved and reported as loaded once complete.
+     */
+    TEST_F(CommunicationHandlerTest, ProgramSegmentCallback)
+    {
+        Robotics::Waypoint_t waypoints[3] = {{1, 2, 3, 4, 5, 6}, {7, 8, 9, 10, 11, 12}, {13, 14, 15, 16, 17, 18}};
+        SegmentedSender sender(RAW(RxIds::PROGRAM_SEGMENT), reinterpret_cast<uint8_t *>(waypoints), sizeof(waypoints));
+
+        EXPECT_CALL(mockStateManager, getPerformingStateId())
+            .WillRepeatedly(Invoke([]() { return StateMachine::RobotArm::StateId::LoadProgram; }));
+        EXPECT_CALL(*programData, saveWaypoints(_, sizeof(Robotics::Waypoint_t))).Times(3);
+        EXPECT_CALL(mockStateManager, handleEvent(StateMachine::RobotArm::Event::ProgramLoaded)).Times(1);
+
+        uint8_t frame[BUFFER_SIZE];
+        size_t length;
+        while ((length = sender.nextFrame(frame)) != 0)
+        {
+            rxCallback(frame[0], length - 1, frame + 1);
+            // Flow control frame is served while the transfer is active
+            uint8_t txData;
+            txCallback(&txData);
+            EXPECT_EQ(txData, 0x30);
+        }
+    }
+
+    /**
+     * @test Verifies that a quantized program sets the scale from its header before saving the waypoints.
+     */
+    TEST_F(CommunicationHandlerTest, QuantizedProgramCallback)
+    {
+        struct
+        {
+            Robotics::WaypointScale_t scale;
+            Robotics::QuantizedWaypoint_t waypoints[3];
+        } program = {{{{-1, 1}, {-2, 2}, {-3, 3}, {-4, 4}, {-5, 5}, {-6, 6}}},
+                     {{{1, 2, 3, 4, 5, 6}}, {{7, 8, 9, 10, 11, 12}}, {{13, 14, 15, 16, 17, 18}}}};
+        static_assert(sizeof(program) == sizeof(Robotics::WaypointScale_t) + 3 * sizeof(Robotics::QuantizedWaypoint_t));
+
+        EXPECT_CALL(mockStateManager, getPerformingStateId())
+            .WillRepeatedly(Invoke([]() { return StateMachine::RobotArm::StateId::LoadProgram; }));
+        ::testing::Sequence order;
+        EXPECT_CALL(*programData, setScale(_))
+            .InSequence(order)
+            .WillOnce(Invoke([](const Robotics::WaypointScale_t & scale) {
+                EXPECT_EQ(scale.q[5].min, -6);
+                EXPECT_EQ(scale.q[5].max, 6);
+            }));
+        size_t saved = 0;
+        EXPECT_CALL(*programData, saveQuantizedWaypoints(_, _))
+            .InSequence(order)
+            .WillRepeatedly(Invoke([&saved, &program](const uint8_t * raw, size_t size) {
+                EXPECT_EQ(size % sizeof(Robotics::QuantizedWaypoint_t), 0u);
+                EXPECT_EQ(memcmp(raw, reinterpret_cast<uint8_t *>(program.waypoints) + saved, size), 0);
+                saved += size;
+            }));
+        EXPECT_CALL(mockStateManager, handleEvent(StateMachine::RobotArm::Event::ProgramLoaded)).Times(1);
+
+        SegmentedSender sender(RAW(RxIds::PROGRAM_QUANTIZED), reinterpret_cast<uint8_t *>(&program), sizeof(program));
+        uint8_t frame[BUFFER_SIZE];
+        size_t length;
+        while ((length = sender.nextFrame(frame)) != 0)
+        {
+            rxCallback(frame[0], length - 1, frame + 1);
+            uint8_t txData;
+            txCallback(&txData);
+            EXPECT_EQ(txData, 0x30);
+        }
+        EXPECT_EQ(saved, sizeof(program.waypoints));
+    }
+
+    /**
+     * @test Verifies that a compressed program is decoded as it arrives, and that a stream not ending
+     *       on a whole waypoint is rejected instead of reported as loaded.
+     */
+    TEST_F(CommunicationHandlerTest, CompressedProgramCallback)
+    {
+        Robotics::WaypointScale_t scale = Robotics::coordinateScale();
+        std::vector<uint8_t> program(reinterpret_cast<uint8_t *>(&scale), reinterpret_cast<uint8_t *>(&scale + 1));
+        std::vector<Robotics::QuantizedWaypoint_t> waypoints;
+        Robotics::WaypointEncoder encoder;
+        for (int16_t i = 0; i < 20; i++)
+        {
+            waypoints.push_back({{i, static_cast<int16_t>(-i), static_cast<int16_t>(100 * i), 0, 0, 0}});
+            uint8_t out[Robotics::MAX_ENCODED_WAYPOINT];
+            program.insert(program.end(), out, out + encoder.encode(waypoints.back(), out));
+        }
+
+        EXPECT_CALL(mockStateManager, getPerformingStateId())
+            .WillRepeatedly(Invoke([]() { return StateMachine::RobotArm::StateId::LoadProgram; }));
+        EXPECT_CALL(*programData, setScale(_)).Times(2);
+        std::vector<uint8_t> saved;
+        EXPECT_CALL(*programData, saveQuantizedWaypoints(_, _))
+            .WillRepeatedly(Invoke([&saved](const uint8_t * raw, size_t size) { saved.insert(saved.end(), raw, raw + size); }));
+        EXPECT_CALL(mockStateManager, handleEvent(StateMachine::RobotArm::Event::ProgramLoaded)).Times(1);
+
+        auto send = [](const std::vector<uint8_t> & message) {
+            SegmentedSender sender(RAW(RxIds::PROGRAM_COMPRESSED), message.data(), static_cast<uint32_t>(message.size()));
+            uint8_t frame[BUFFER_SIZE];
+            size_t length;
+            ResponseCode code = ResponseCode::Positive;
+            while ((length = sender.nextFrame(frame)) != 0)
+            {
+                code = compressedProgramCallback(frame + 1, length - 1);
+            }
+            return code;
+        };
+        EXPECT_EQ(send(program), ResponseCode::Positive);
+        ASSERT_EQ(saved.size(), waypoints.size() * sizeof(Robotics::QuantizedWaypoint_t));
+        EXPECT_EQ(memcmp(saved.data(), waypoints.data(), saved.size()), 0);
+
+        program.push_back(0x82);
+        EXPECT_EQ(send(program), ResponseCode::IncorrectMessageLength);
+    }
+
     /**
      * @test Verifies that the reset callback triggers the reset function.
      */
@@ -196,4 +356,93 @@ namespace Tests {
         rxCallback(0xFF, dataLength, data);
     }
 
+    /**
+     * @brief Word of a diagnostic response page.
+     */
+    static uint32_t pageWord(const uint8_t * response, size_t index)
+    {
+        const uint8_t * word = response + DIAGNOSTIC_HEADER_SIZE + index * sizeof(uint32_t);
+        return word[0] | (word[1] << 8) | (word[2] << 16) | (static_cast<uint32_t>(word[3]) << 24);
+    }
+
+    /**
+     * @test Verifies that messages are counted per id, unknown ids apart, and that the
+     *       diagnostic service responds with the selected statistics page until the next message.
+     */
+    TEST_F(CommunicationHandlerTest, DiagnosticsService)
+    {
+        uint8_t page = DIAGNOSTIC_RESET_PAGE;
+        rxCallback(RAW(RxIds::DIAGNOSTICS), 1, &page);
+        EXPECT_CALL(mockStateManager, handleEvent(StateMachine::RobotArm::Event::Start)).Times(2).WillRepeatedly(Return(true));
+        rxCallback(RAW(RxIds::START), 0, nullptr);
+        rxCallback(RAW(RxIds::START), 0, nullptr);
+        rxCallback(0x3F, 0, nullptr);
+
+        uint8_t response[BUFFER_SIZE];
+        page = 0;
+        rxCallback(RAW(RxIds::DIAGNOSTICS), 1, &page);
+        ASSERT_EQ(getResponse(response), DIAGNOSTIC_HEADER_SIZE + DIAGNOSTIC_PAGE_WORDS * sizeof(uint32_t));
+        EXPECT_EQ(response[0], RAW(RxIds::DIAGNOSTICS));
+        EXPECT_EQ(response[1], 0);
+        EXPECT_EQ(pageWord(response, static_cast<size_t>(StatWord::UnknownIds)), 1u);
+
+        // Page holding the count of START messages
+        size_t index = static_cast<size_t>(StatWord::MessageCounts) + RAW(RxIds::START);
+        page = static_cast<uint8_t>(index / DIAGNOSTIC_PAGE_WORDS);
+        rxCallback(RAW(RxIds::DIAGNOSTICS), 1, &page);
+        getResponse(response);
+        EXPECT_EQ(response[1], page);
+        EXPECT_EQ(pageWord(response, index % DIAGNOSTIC_PAGE_WORDS), 2u);
+
+        // Past the end of the snapshot
+        page = 0xF0;
+        rxCallback(RAW(RxIds::DIAGNOSTICS), 1, &page);
+        EXPECT_EQ(getResponse(response), DIAGNOSTIC_HEADER_SIZE);
+
+        // Any other message restores the regular response
+        rxCallback(0x3E, 0, nullptr);
+        ASSERT_EQ(getResponse(response), 1u);
+        EXPECT_EQ(response[0], 0x07);
+    }
+
+    static void busyTask(void *)
+    {
+        mockTimeUs += 250;
+    }
+
+    /**
+     * @test Verifies that the task statistics of the scheduler are served after the
+     *       communication statistics, from DIAGNOSTIC_TASK_PAGE on.
+     */
+    TEST_F(CommunicationHandlerTest, DiagnosticsTaskPages)
+    {
+        mockTimeUs = 0;
+        Utilities::TaskScheduler scheduler;
+        scheduler.addTask(busyTask, nullptr, 1000);
+        scheduler.addIdleTask(busyTask, nullptr);
+        scheduler.runOnce();
+        setTaskScheduler(&scheduler);
+
+        uint8_t response[BUFFER_SIZE];
+        uint8_t page = static_cast<uint8_t>(DIAGNOSTIC_TASK_PAGE);
+        rxCallback(RAW(RxIds::DIAGNOSTICS), 1, &page);
+        ASSERT_EQ(getResponse(response), DIAGNOSTIC_HEADER_SIZE + DIAGNOSTIC_PAGE_WORDS * sizeof(uint32_t));
+        EXPECT_EQ(pageWord(response, static_cast<size_t>(Utilities::TaskStatWord::Runs)), 1u);
+        EXPECT_EQ(pageWord(response, static_cast<size_t>(Utilities::TaskStatWord::MaxUs)), 250u);
+
+        // Last page of the snapshot, then past its end
+        page = static_cast<uint8_t>((DIAGNOSTIC_WORDS - 1) / DIAGNOSTIC_PAGE_WORDS);
+        rxCallback(RAW(RxIds::DIAGNOSTICS), 1, &page);
+        EXPECT_GT(getResponse(response), DIAGNOSTIC_HEADER_SIZE);
+        page++;
+        rxCallback(RAW(RxIds::DIAGNOSTICS), 1, &page);
+        EXPECT_EQ(getResponse(response), DIAGNOSTIC_HEADER_SIZE);
+
+        setTaskScheduler(nullptr);
+        page = static_cast<uint8_t>(DIAGNOSTIC_TASK_PAGE);
+        rxCallback(RAW(RxIds::DIAGNOSTICS), 1, &page);
+        getResponse(response);
+        EXPECT_EQ(pageWord(response, static_cast<size_t>(Utilities::TaskStatWord::Runs)), 0u);
+    }
+
 } // namespace Tests
@@ -0,0 +1,136 @@
+/***********************************************************************
+ * @file	:	test_core_link.cpp
+ * @brief 	:	Test cases for the inter-core program link, with the
+ *              cores run as host threads.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#include "core_link.hpp"
+#include "loopback_transport.hpp"
+#include "communication_handler.hpp"
+#include "segmented_transfer.hpp"
+#include "fsm_state_manager.hpp"
+#include "pico/multicore.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <vector>
+
+using namespace Communication;
+
+namespace Tests {
+
+    static float firstJoint(const Robotics::Waypoint_t & waypoint)
+    {
+        return waypoint.q1;
+    }
+
+    /**
+     * @test Verifies that program data is split into chunks of whole records and applied in order.
+     */
+    TEST(ProgramLinkTest, ChunkOrder)
+    {
+        ProgramLink link;
+        Robotics::Waypoint_t waypoints[3] = {{1, 0, 0, 0, 0, 0}, {2, 0, 0, 0, 0, 0}, {3, 0, 0, 0, 0, 0}};
+        Robotics::WaypointScale_t scale = {{{0, 10}, {0, 1}, {0, 1}, {0, 1}, {0, 1}, {0, 1}}};
+        Robotics::QuantizedWaypoint_t quantized[5];
+        for (int16_t i = 0; i < 5; i++)
+        {
+            quantized[i] = Robotics::quantize(Robotics::Waypoint_t{4.0f + i, 0, 0, 0, 0, 0}, scale);
+        }
+
+        link.saveWaypoints(reinterpret_cast<uint8_t *>(waypoints), sizeof(waypoints));
+        link.setScale(scale);
+        link.saveQuantizedWaypoints(reinterpret_cast<uint8_t *>(quantized), sizeof(quantized));
+        // Link only forwards
+        EXPECT_EQ(link.numOfWaypoints(), 0u);
+
+        Robotics::Trajectory trajectory;
+        EXPECT_EQ(link.drain(trajectory, 2), 2u);
+        EXPECT_EQ(trajectory.numOfWaypoints(), 3u);
+        EXPECT_EQ(link.drain(trajectory), 3u);
+        EXPECT_FALSE(link.isPending());
+        ASSERT_EQ(trajectory.numOfWaypoints(), 8u);
+        for (int i = 1; i <= 8; i++)
+        {
+            EXPECT_NEAR(firstJoint(trajectory.getNextWaypoint()), i, 1e-3);
+        }
+        EXPECT_EQ(link.stalls(), 0u);
+    }
+
+    constexpr size_t LINKED_WAYPOINTS = 300;
+    static LoopbackTransport * core1Transport;
+    static std::atomic_bool core1Done;
+
+    /**
+     * @brief Communication core: the master loads a program through the loopback bus.
+     */
+    static void communicationCore()
+    {
+        RobotArm::startServices(*core1Transport, DispatchMode::Deferred);
+        const uint8_t load[] = {RAW(RobotArm::RxIds::LOAD)};
+        core1Transport->masterWrite(load, sizeof(load));
+        RobotArm::serviceTransport(*core1Transport);
+
+        std::vector<Robotics::Waypoint_t> program(LINKED_WAYPOINTS);
+        for (size_t i = 0; i < LINKED_WAYPOINTS; i++)
+        {
+            program[i] = {static_cast<float>(i), 1, 2, 3, 4, 5};
+        }
+        SegmentedSender sender(RAW(RobotArm::RxIds::PROGRAM_SEGMENT), reinterpret_cast<uint8_t *>(program.data()),
+                               static_cast<uint32_t>(program.size() * sizeof(Robotics::Waypoint_t)));
+        uint8_t frame[BUFFER_SIZE];
+        size_t length;
+        while ((length = sender.nextFrame(frame)) != 0)
+        {
+            core1Transport->masterWrite(frame, length);
+            RobotArm::serviceTransport(*core1Transport);
+        }
+        core1Done = true;
+    }
+
+    /**
+     * @test Verifies that a program received on core1 reaches the trajectory run by core0 whole and
+     *       in order, while core0 keeps running the state machine.
+     */
+    TEST(ProgramLinkTest, TwoCores)
+    {
+        using StateMachine::RobotArm::StateId;
+        auto stateManager = StateMachine::RobotArm::FSMStateManager::getInstance();
+        // The singleton may have been moved by the tests before
+        stateManager->restart(StateId::Init);
+        stateManager->handleEvent(StateMachine::RobotArm::Event::Done);
+        stateManager->run();
+
+        auto link = std::make_shared<ProgramLink>();
+        Robotics::Trajectory trajectory;
+        LoopbackTransport transport;
+        core1Transport = &transport;
+        core1Done = false;
+        RobotArm::installDataContainer(link);
+        multicore_launch_core1(communicationCore);
+
+        size_t loops = 0;
+        while (!core1Done || link->isPending())
+        {
+            link->drain(trajectory);
+            stateManager->run();
+            loops++;
+        }
+        multicore_reset_core1();
+        stateManager->run();
+        RobotArm::stopServices();
+        RobotArm::uninstallDataContainer();
+
+        EXPECT_GT(loops, 0u);
+        EXPECT_EQ(stateManager->getPerformingStateId(), StateId::ReadyAndLoaded);
+        ASSERT_EQ(trajectory.numOfWaypoints(), LINKED_WAYPOINTS);
+        for (size_t i = 0; i < LINKED_WAYPOINTS; i++)
+        {
+            Robotics::Waypoint_t waypoint = trajectory.getNextWaypoint();
+            ASSERT_EQ(waypoint.q1, static_cast<float>(i));
+            ASSERT_EQ(waypoint.q6, 5.0f);
+        }
+    }
+
+} // namespace Tests
@@ -0,0 +1,112 @@
+/***********************************************************************
+ * @file	:	test_crc.cpp
+ * @brief 	:	Test cases for the table driven CRC and frame integrity check.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#include "crc.hpp"
+#include "message_format.hpp"
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace Communication;
+
+namespace Tests {
+
+    static constexpr uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+
+    // Tables and check values are computed at compile time
+    static_assert(Crc16<1>::compute(check, sizeof(check)) == 0x906E);
+    static_assert(Crc32<1>::compute(check, sizeof(check)) == 0xCBF43926);
+    static_assert(Crc32<8>::compute(check, sizeof(check)) == 0xCBF43926);
+    static_assert(Crc32<>::residue() == 0x2144DF1C);
+    static_assert(Crc32<4>::tableBytes() == 4 * 256 * sizeof(uint32_t));
+
+    static std::vector<uint8_t> pattern(size_t length)
+    {
+        std::vector<uint8_t> data(length);
+        for (size_t i = 0; i < length; i++)
+        {
+            data[i] = static_cast<uint8_t>(i * 37 + 11);
+        }
+        return data;
+    }
+
+    /**
+     * @test Verifies that every number of slices gives the byte-wise result, for any length.
+     */
+    TEST(CrcTest, SlicesMatchBytewise)
+    {
+        for (size_t length = 0; length <= 40; length++)
+        {
+            std::vector<uint8_t> data = pattern(length);
+            uint16_t crc16 = Crc16<1>::compute(data.data(), length);
+            EXPECT_EQ(Crc16<2>::compute(data.data(), length), crc16);
+            EXPECT_EQ(Crc16<4>::compute(data.data(), length), crc16);
+            EXPECT_EQ(Crc16<8>::compute(data.data(), length), crc16);
+
+            uint32_t crc32 = Crc32<1>::compute(data.data(), length);
+            EXPECT_EQ(Crc32<2>::compute(data.data(), length), crc32);
+            EXPECT_EQ(Crc32<4>::compute(data.data(), length), crc32);
+            EXPECT_EQ(Crc32<8>::compute(data.data(), length), crc32);
+            EXPECT_EQ(Crc32<16>::compute(data.data(), length), crc32);
+        }
+    }
+
+    /**
+     * @test Verifies that data can be folded in pieces.
+     */
+    TEST(CrcTest, IncrementalUpdate)
+    {
+        std::vector<uint8_t> data = pattern(29);
+        uint32_t crc = Crc32<>::initial();
+        crc = Crc32<>::update(crc, data.data(), 5);
+        crc = Crc32<>::update(crc, data.data() + 5, 24);
+        EXPECT_EQ(Crc32<>::finalize(crc), Crc32<>::compute(data.data(), data.size()));
+    }
+
+    /**
+     * @test Verifies that an appended check is verified and stripped.
+     */
+    TEST(IntegrityTest, AppendAndVerify)
+    {
+        for (Integrity integrity : {Integrity::None, Integrity::Crc16, Integrity::Crc32})
+        {
+            uint8_t frame[BUFFER_SIZE] = {0x07, 1, 2, 3};
+            size_t length = appendIntegrity(integrity, frame, 4);
+            EXPECT_EQ(length, 4 + integritySize(integrity));
+            EXPECT_EQ(verifyIntegrity(integrity, frame, length), 4);
+        }
+    }
+
+    /**
+     * @test Verifies that any single bit error and frames too short are rejected.
+     */
+    TEST(IntegrityTest, CorruptionRejected)
+    {
+        for (Integrity integrity : {Integrity::Crc16, Integrity::Crc32})
+        {
+            uint8_t frame[BUFFER_SIZE] = {0x07, 1, 2, 3};
+            size_t length = appendIntegrity(integrity, frame, 4);
+            for (size_t bit = 0; bit < length * 8; bit++)
+            {
+                frame[bit / 8] ^= static_cast<uint8_t>(1 << (bit % 8));
+                EXPECT_EQ(verifyIntegrity(integrity, frame, length), 0) << "bit " << bit;
+                frame[bit / 8] ^= static_cast<uint8_t>(1 << (bit % 8));
+            }
+            EXPECT_EQ(verifyIntegrity(integrity, frame, integritySize(integrity)), 0);
+        }
+    }
+
+    /**
+     * @test Verifies that a check which doesn't fit in a frame is not appended.
+     */
+    TEST(IntegrityTest, FrameFull)
+    {
+        uint8_t frame[BUFFER_SIZE] = {};
+        EXPECT_EQ(appendIntegrity(Integrity::Crc32, frame, BUFFER_SIZE - 3), 0);
+        EXPECT_EQ(appendIntegrity(Integrity::Crc32, frame, BUFFER_SIZE - 4), BUFFER_SIZE);
+    }
+
+} // namespace Tests
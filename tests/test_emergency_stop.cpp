@@ -0,0 +1,108 @@
+/***********************************************************************
+ * @file	:	test_emergency_stop.cpp
+ * @brief 	:	Test cases for the emergency stop latch and its fast path
+ *              from the I2C receive interrupt.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#include "emergency_stop.hpp"
+#include "i2c_transport.hpp"
+#include "i2c_bus_simulator.hpp"
+#include "communication_handler.hpp"
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+using namespace Motor;
+using namespace Communication;
+using namespace Communication::Hardware;
+
+namespace Tests {
+
+    /**
+     * @brief Mock class for a motor driver.
+     */
+    class MockMotor : public IMotor
+    {
+        public:
+            MOCK_METHOD(void, enable, (), (override));
+            MOCK_METHOD(void, disable, (), (override));
+            MOCK_METHOD(void, setZero, (), (override));
+            MOCK_METHOD(void, setControlMode, (ControlMode mode), (override));
+            MOCK_METHOD(int_fast32_t, getAbsPosition, (), (const, override));
+            MOCK_METHOD(void, setAbsPosition, (int_fast32_t position), (override));
+            MOCK_METHOD(void, setSpeed, (uint_fast32_t speed), (override));
+            MOCK_METHOD(uint_fast32_t, getSpeed, (), (const, override));
+            MOCK_METHOD(void, setDirection, (Direction direction), (override));
+    };
+
+    class EmergencyStopTest : public ::testing::Test
+    {
+        protected:
+            void SetUp() override
+            {
+                EmergencyStopLatch::reset();
+            }
+
+            void TearDown() override
+            {
+                EmergencyStopLatch::reset();
+            }
+    };
+
+    /**
+     * @test Verifies that triggering latches the stop and disables every registered motor.
+     */
+    TEST_F(EmergencyStopTest, Trigger)
+    {
+        MockMotor motors[MAX_STOP_MOTORS + 1];
+        for (size_t i = 0; i < MAX_STOP_MOTORS; i++)
+        {
+            EXPECT_TRUE(EmergencyStopLatch::registerMotor(&motors[i]));
+            EXPECT_CALL(motors[i], disable()).Times(2);
+        }
+        EXPECT_FALSE(EmergencyStopLatch::registerMotor(&motors[MAX_STOP_MOTORS]));
+        EXPECT_FALSE(EmergencyStopLatch::registerMotor(nullptr));
+        EXPECT_CALL(motors[MAX_STOP_MOTORS], disable()).Times(0);
+        EXPECT_FALSE(EmergencyStopLatch::isLatched());
+
+        mockTimeUs = 1234;
+        EmergencyStopLatch::trigger();
+        EXPECT_TRUE(EmergencyStopLatch::isLatched());
+        EXPECT_EQ(EmergencyStopLatch::latchTimeUs(), 1234u);
+
+        // Triggering again disables the motors again but keeps the first latch time
+        mockTimeUs = 2000;
+        EmergencyStopLatch::trigger();
+        EXPECT_EQ(EmergencyStopLatch::latchTimeUs(), 1234u);
+    }
+
+    /**
+     * @test Verifies that an emergency stop received over I2C disables the motors from the
+     *       receive interrupt, before the frame ends and without pumping the transport.
+     */
+    TEST_F(EmergencyStopTest, I2CFastPath)
+    {
+        MockMotor motor;
+        EmergencyStopLatch::registerMotor(&motor);
+        I2CTransport transport;
+        RobotArm::startServices(transport, DispatchMode::Deferred);
+        Mocks::I2CBusSimulator bus;
+
+        uint64_t disabledAt = 0;
+        EXPECT_CALL(motor, disable()).WillOnce([&]() { disabledAt = mockTimeUs; });
+        uint64_t start = mockTimeUs;
+        bus.write({RAW(RobotArm::RxIds::EMERGENCY_STOP), 0xAA, 0xBB, 0xCC}).run();
+        EXPECT_TRUE(EmergencyStopLatch::isLatched());
+        // START and the id byte at 400kHz
+        EXPECT_EQ(disabledAt - start, 25u);
+        EXPECT_LT(disabledAt, mockTimeUs);
+        ::testing::Mock::VerifyAndClearExpectations(&motor);
+
+        // The message is still dispatched, disabling the motors again
+        EXPECT_CALL(motor, disable()).Times(::testing::AtLeast(1));
+        EXPECT_EQ(RobotArm::serviceTransport(transport), 1);
+        RobotArm::stopServices();
+    }
+
+} // namespace Tests
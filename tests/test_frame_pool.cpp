@@ -0,0 +1,231 @@
+/***********************************************************************
+ * @file	:	test_frame_pool.cpp
+ * @brief 	:	Test cases for the received frame pool.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#include "frame_pool.hpp"
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+using namespace Communication;
+
+namespace Tests {
+
+    /**
+     * @brief Emulate the ISR writing a frame into the pool.
+     */
+    template <size_t N>
+    static bool writeFrame(FramePool<N> & pool, uint8_t msgId, uint8_t payload)
+    {
+        Frame * frame = pool.acquire();
+        if (frame == nullptr)
+        {
+            return false;
+        }
+        frame->data[frame->length++] = msgId;
+        frame->data[frame->length++] = payload;
+        return pool.publish();
+    }
+
+    /**
+     * @test Verifies that a published frame can be borrowed without copying.
+     */
+    TEST(FramePoolTest, PublishAndReceive)
+    {
+        FramePool<2> pool;
+        FramePool<2>::View view;
+
+        EXPECT_FALSE(pool.receive(view));
+        ASSERT_TRUE(writeFrame(pool, 0x07, 0xAB));
+        EXPECT_EQ(pool.pending(), 1);
+
+        ASSERT_TRUE(pool.receive(view));
+        EXPECT_TRUE(view.isValid());
+        EXPECT_EQ(view.msgId(), 0x07);
+        EXPECT_EQ(view.payloadLength(), 1);
+        EXPECT_EQ(view.payload()[0], 0xAB);
+        EXPECT_EQ(view.payload(), view.frame().data + 1);
+        view.release();
+        EXPECT_FALSE(view.isValid());
+    }
+
+    /**
+     * @test Verifies that back-to-back frames are kept while earlier ones are still borrowed.
+     */
+    TEST(FramePoolTest, BackToBackFrames)
+    {
+        FramePool<4> pool;
+        FramePool<4>::View first;
+
+        ASSERT_TRUE(writeFrame(pool, 0x01, 1));
+        ASSERT_TRUE(pool.receive(first));
+
+        // Frames keep arriving while the first one is being handled
+        ASSERT_TRUE(writeFrame(pool, 0x02, 2));
+        ASSERT_TRUE(writeFrame(pool, 0x03, 3));
+        ASSERT_TRUE(writeFrame(pool, 0x04, 4));
+        EXPECT_EQ(first.msgId(), 0x01);
+        EXPECT_EQ(first.payload()[0], 1);
+
+        // Every slot is in use, the next frame is dropped
+        EXPECT_FALSE(writeFrame(pool, 0x05, 5));
+        EXPECT_EQ(pool.droppedFrames(), 1);
+
+        first.release();
+        for (uint8_t id = 0x02; id <= 0x04; id++)
+        {
+            FramePool<4>::View view;
+            ASSERT_TRUE(pool.receive(view));
+            EXPECT_EQ(view.msgId(), id);
+            EXPECT_EQ(view.payload()[0], id);
+        }
+        EXPECT_TRUE(writeFrame(pool, 0x05, 5));
+    }
+
+    /**
+     * @test Verifies that an empty frame is not published and its slot is reused.
+     */
+    TEST(FramePoolTest, EmptyFrameNotPublished)
+    {
+        FramePool<1> pool;
+        Frame * frame = pool.acquire();
+        ASSERT_NE(frame, nullptr);
+        EXPECT_FALSE(pool.publish());
+        EXPECT_EQ(pool.acquire(), frame);
+        EXPECT_EQ(pool.droppedFrames(), 0);
+    }
+
+    /**
+     * @test Verifies that views give the slot back when destroyed or overwritten.
+     */
+    TEST(FramePoolTest, ViewReleasesSlot)
+    {
+        FramePool<1> pool;
+        {
+            FramePool<1>::View view;
+            ASSERT_TRUE(writeFrame(pool, 0x01, 1));
+            ASSERT_TRUE(pool.receive(view));
+            EXPECT_EQ(pool.acquire(), nullptr);
+        }
+        ASSERT_TRUE(writeFrame(pool, 0x02, 2));
+
+        FramePool<1>::View view;
+        ASSERT_TRUE(pool.receive(view));
+        FramePool<1>::View moved = std::move(view);
+        EXPECT_FALSE(view.isValid());
+        EXPECT_EQ(moved.msgId(), 0x02);
+        moved = FramePool<1>::View();
+        EXPECT_NE(pool.acquire(), nullptr);
+    }
+
+    static std::vector<uint8_t> dispatchedIds;
+
+    static void recordHandler(RxMessageId msgId, size_t dataLength, const uint8_t * data)
+    {
+        dispatchedIds.push_back(msgId);
+        EXPECT_EQ(dataLength, 1);
+        EXPECT_EQ(data[0], msgId);
+    }
+
+    /**
+     * @test Verifies that deferred dispatch handles frames in order and respects the budget.
+     */
+    TEST(FramePoolTest, DispatchBudget)
+    {
+        FramePool<4> pool;
+        dispatchedIds.clear();
+        for (uint8_t id = 1; id <= 3; id++)
+        {
+            ASSERT_TRUE(writeFrame(pool, id, id));
+        }
+
+        EXPECT_EQ(pool.dispatch(recordHandler, 2), 2);
+        EXPECT_EQ(dispatchedIds, (std::vector<uint8_t>{1, 2}));
+        EXPECT_EQ(pool.pending(), 1);
+
+        EXPECT_EQ(pool.dispatch(recordHandler, 2), 1);
+        EXPECT_EQ(dispatchedIds, (std::vector<uint8_t>{1, 2, 3}));
+        EXPECT_EQ(pool.dispatch(recordHandler, 2), 0);
+
+        // Dispatched slots are free again
+        for (uint8_t id = 4; id <= 7; id++)
+        {
+            ASSERT_TRUE(writeFrame(pool, id, id));
+        }
+    }
+
+    /**
+     * @test Verifies that corrupted frames are dropped and the check is stripped from intact ones.
+     */
+    TEST(FramePoolTest, IntegrityCheck)
+    {
+        FramePool<4> pool;
+        pool.setIntegrity(Integrity::Crc16);
+        for (uint8_t id = 1; id <= 3; id++)
+        {
+            Frame * frame = pool.acquire();
+            ASSERT_NE(frame, nullptr);
+            frame->data[0] = id;
+            frame->data[1] = id;
+            frame->length = appendIntegrity(Integrity::Crc16, frame->data, 2);
+            if (id == 2)
+            {
+                frame->data[1] ^= 0x40; // corrupted on the bus
+            }
+            ASSERT_TRUE(pool.publish());
+        }
+
+        // The rejected slot is reused by the filler
+        Frame * frame = pool.acquire();
+        ASSERT_NE(frame, nullptr);
+        frame->data[frame->length++] = 4;
+        pool.reject();
+        EXPECT_FALSE(pool.publish());
+
+        dispatchedIds.clear();
+        EXPECT_EQ(pool.dispatch(recordHandler, 4), 2);
+        EXPECT_EQ(dispatchedIds, (std::vector<uint8_t>{1, 3}));
+        EXPECT_EQ(pool.corruptedFrames(), 2);
+        EXPECT_EQ(pool.droppedFrames(), 0);
+    }
+
+    /**
+     * @test Verifies that no frame is lost nor corrupted with a concurrent filler and receiver.
+     */
+    TEST(FramePoolTest, ConcurrentFillAndReceive)
+    {
+        constexpr uint32_t count = 20000;
+        FramePool<4> pool;
+
+        std::thread isr([&pool]() {
+            for (uint32_t i = 0; i < count; i++)
+            {
+                while (!writeFrame(pool, static_cast<uint8_t>(i), static_cast<uint8_t>(~i)))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+        uint32_t received = 0;
+        while (received < count)
+        {
+            FramePool<4>::View view;
+            if (pool.receive(view))
+            {
+                ASSERT_EQ(view.msgId(), static_cast<uint8_t>(received));
+                ASSERT_EQ(view.payload()[0], static_cast<uint8_t>(~received));
+                received++;
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+        isr.join();
+    }
+
+} // namespace Tests
@@ -0,0 +1,128 @@
+/***********************************************************************
+ * @file	:	test_frame_trace.cpp
+ * @brief 	:	Test cases for the frame trace recorder and reader.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#include "frame_trace.hpp"
+#include "communication_handler.hpp"
+#include "hardware/timer.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace Communication;
+
+namespace Tests {
+
+    static std::vector<uint8_t> sunk;
+
+    static void collect(const uint8_t * data, size_t length)
+    {
+        sunk.insert(sunk.end(), data, data + length);
+    }
+
+    static std::vector<std::vector<uint8_t>> readFrames(const std::vector<uint8_t> & trace, std::vector<uint64_t> * times = nullptr)
+    {
+        TraceReader reader(trace.data(), trace.size());
+        EXPECT_TRUE(reader.isValid());
+        std::vector<std::vector<uint8_t>> frames;
+        TraceRecord record;
+        while (reader.next(record))
+        {
+            frames.emplace_back(record.frame, record.frame + record.length);
+            if (times != nullptr)
+            {
+                times->push_back(record.timeUs);
+            }
+        }
+        return frames;
+    }
+
+    /**
+     * @test Verifies that recorded frames are read back with their relative times, across a timer wrap.
+     */
+    TEST(FrameTraceTest, RoundTrip)
+    {
+        uint8_t buffer[256];
+        TraceRecorder recorder(buffer, sizeof(buffer));
+        const uint8_t payload[] = {1, 2, 3};
+        EXPECT_TRUE(recorder.record(0xFFFFFF00, 0x07, payload, sizeof(payload)));
+        EXPECT_TRUE(recorder.record(0xFFFFFF10, 0x04, nullptr, 0));
+        EXPECT_TRUE(recorder.record(0x00000100, 0x05, payload, 1));
+        // Header, then 1 byte deltas for 0 and 16, 2 bytes for 0x1F0
+        EXPECT_EQ(recorder.size(), TRACE_HEADER_SIZE + (1 + 5) + (1 + 2) + (2 + 3));
+
+        std::vector<uint64_t> times;
+        std::vector<uint8_t> trace(recorder.buffer(), recorder.buffer() + recorder.size());
+        EXPECT_EQ(readFrames(trace, &times),
+                  (std::vector<std::vector<uint8_t>>{{0x07, 1, 2, 3}, {0x04}, {0x05, 1}}));
+        EXPECT_EQ(times, (std::vector<uint64_t>{0, 0x10, 0x200}));
+    }
+
+    /**
+     * @test Verifies that full buffers go to the sink, and that without a sink frames are dropped.
+     */
+    TEST(FrameTraceTest, Sink)
+    {
+        uint8_t payload[BUFFER_SIZE - 1] = {0};
+        uint8_t buffer[TRACE_HEADER_SIZE + 2 * TRACE_MAX_RECORD];
+        sunk.clear();
+        TraceRecorder streaming(buffer, sizeof(buffer), collect);
+        for (uint8_t id = 0; id < 10; id++)
+        {
+            EXPECT_TRUE(streaming.record(id * 1000u, id, payload, sizeof(payload)));
+        }
+        streaming.flush();
+        EXPECT_EQ(readFrames(sunk).size(), 10u);
+
+        TraceRecorder bounded(buffer, sizeof(buffer));
+        size_t recorded = 0;
+        for (uint8_t id = 0; id < 10; id++)
+        {
+            recorded += bounded.record(id * 1000u, id, payload, sizeof(payload)) ? 1 : 0;
+        }
+        EXPECT_EQ(recorded, 2u);
+        EXPECT_EQ(bounded.droppedRecords(), 8u);
+        EXPECT_FALSE(bounded.record(0, 0x07, payload, BUFFER_SIZE));
+    }
+
+    /**
+     * @test Verifies that truncated or foreign traces are rejected.
+     */
+    TEST(FrameTraceTest, Malformed)
+    {
+        std::vector<uint8_t> trace = {'R', 'A', 'T', 'R', TRACE_VERSION, 0x00, 0x03, 0x07, 0x01};
+        TraceReader truncated(trace.data(), trace.size());
+        TraceRecord record;
+        EXPECT_TRUE(truncated.isValid());
+        EXPECT_FALSE(truncated.next(record));
+
+        trace[4] = TRACE_VERSION + 1;
+        TraceReader foreign(trace.data(), trace.size());
+        EXPECT_FALSE(foreign.isValid());
+        EXPECT_FALSE(foreign.next(record));
+    }
+
+    /**
+     * @test Verifies that rxCallback records the messages it receives.
+     */
+    TEST(FrameTraceTest, RecordReceivedMessages)
+    {
+        uint8_t buffer[128];
+        TraceRecorder recorder(buffer, sizeof(buffer));
+        RobotArm::setTraceRecorder(&recorder);
+        const uint8_t page = 0;
+        mockTimeUs = 5000;
+        RobotArm::rxCallback(RAW(RobotArm::RxIds::DIAGNOSTICS), 1, &page);
+        mockTimeUs = 5250;
+        RobotArm::rxCallback(0x3F, 0, nullptr);
+        RobotArm::setTraceRecorder(nullptr);
+
+        std::vector<uint64_t> times;
+        std::vector<uint8_t> trace(recorder.buffer(), recorder.buffer() + recorder.size());
+        EXPECT_EQ(readFrames(trace, &times), (std::vector<std::vector<uint8_t>>{{0x0A, 0}, {0x3F}}));
+        EXPECT_EQ(times, (std::vector<uint64_t>{0, 250}));
+    }
+
+} // namespace Tests
@@ -14,10 +14,39 @@
 
 namespace Tests {
 
+    /**
+     * @brief Test fixture starting every test with the FSMStateManager singleton in Init.
+     */
+    class FSMStateManagerTest : public ::testing::Test
+    {
+        protected:
+            void SetUp() override
+            {
+                StateMachine::RobotArm::FSMStateManager::getInstance()->restart(StateMachine::RobotArm::StateId::Init);
+            }
+    };
+
+    /**
+     * @brief Test fixture starting every test with the mock state manager singleton in a new
+     *        First state, not entered yet.
+     */
+    class StateManagerTest : public ::testing::Test
+    {
+        protected:
+            void SetUp() override
+            {
+                StateMachine::MockStateFactory::secondStateCreated = false;
+                StateMachine::MockStateFactory::thirdStateCreated = false;
+                StateMachine::MockStateFactory::lastStateData = {0, 0, 0};
+                StateMachine::StateManager<MockStateId, MockEvent, mockStateTransMatrix>::getInstance(MockStateId::First)
+                    ->restart(MockStateId::First);
+            }
+    };
+
     /**
      * @test Verifies the creation of a singleton instance of FSMStateManager.
      */
-    TEST(FSMStateManagerTest, getInstance)
+    TEST_F(FSMStateManagerTest, getInstance)
     {
         // create instance of FSMStateManager
         auto instance = StateMachine::RobotArm::FSMStateManager::getInstance();
@@ -33,7 +62,7 @@ namespace Tests {
     /**
      * @test Verifies the initial state of FSMStateManager.
      */
-    TEST(FSMStateManagerTest, initialState)
+    TEST_F(FSMStateManagerTest, initialState)
     {
         // create instance of FSMStateManager
         auto instance = StateMachine::RobotArm::FSMStateManager::getInstance();
@@ -44,7 +73,7 @@ namespace Tests {
     /**
      * @test Verifies a valid state transition occurs.
      */
-    TEST(FSMStateManagerTest, validStateTransition)
+    TEST_F(FSMStateManagerTest, validStateTransition)
     {
         // create instance of FSMStateManager
         auto instance = StateMachine::RobotArm::FSMStateManager::getInstance();
@@ -57,7 +86,7 @@ namespace Tests {
     /**
      * @test Verifies an invalid state transition does not occur.
      */
-    TEST(FSMStateManagerTest, invalidStateTransition)
+    TEST_F(FSMStateManagerTest, invalidStateTransition)
     {
         // create instance of FSMStateManager
         auto instance = StateMachine::RobotArm::FSMStateManager::getInstance();
@@ -74,7 +103,7 @@ namespace Tests {
     /**
      * @test Verifies the state matrix transitions.
      */
-    TEST(FSMStateManagerTest, stateMatrix)
+    TEST_F(FSMStateManagerTest, stateMatrix)
     {
         // create instance of FSMStateManager
         auto instance = StateMachine::RobotArm::FSMStateManager::getInstance();
@@ -123,7 +152,7 @@ namespace Tests {
     /**
      * @test Verifies the concurrent creation of a singleton from multiple threads.
      */
-    TEST(FSMStateManagerTest, concurrentSingletonCreation)
+    TEST_F(FSMStateManagerTest, concurrentSingletonCreation)
     {
         // create instance of FSMStateManager from multiple threads
         std::vector<std::thread> threads;
@@ -164,10 +193,27 @@ namespace Tests {
         ASSERT_TRUE(dynamic_cast<States::Ready *>(ready.get()) != nullptr);
     }
 
+    /**
+     * @test Verifies that states come from static storage, the same instance on every creation.
+     */
+    TEST(FSMStateFactoryTest, staticStates)
+    {
+        using namespace StateMachine::RobotArm;
+        auto first = FSMStateFactory::createState(StateId::Execute, nullptr);
+        auto second = FSMStateFactory::createState(StateId::Execute, FSMStateManager::getInstance());
+        EXPECT_EQ(first.get(), second.get());
+        EXPECT_FALSE(first.get_deleter().owned);
+        EXPECT_EQ(FSMStateFactory::createState(StateId::Manual, nullptr), nullptr);
+        // Releasing the pointers leaves the state alive
+        first.reset();
+        second.reset();
+        EXPECT_EQ(FSMStateFactory::createState(StateId::Execute, nullptr)->getStateId(), StateId::Execute);
+    }
+
     /**
      * @test Verifies states are run and transitioned correctly.
      */
-    TEST(StateManagerTest, stateRun)
+    TEST_F(StateManagerTest, stateRun)
     {
         // Create instance of StateManager with mock states
         auto instance = StateMachine::StateManager<MockStateId, MockEvent, mockStateTransMatrix>::getInstance(MockStateId::First);
@@ -233,10 +279,38 @@ namespace Tests {
         ASSERT_EQ(third_state->exitedCnt, 0);
     }
 
+    /**
+     * @test Verifies that states passed through between two run() calls are entered and exited.
+     */
+    TEST_F(StateManagerTest, queuedTransitions)
+    {
+        auto instance = StateMachine::StateManager<MockStateId, MockEvent, mockStateTransMatrix>::getInstance(MockStateId::First);
+        instance->run();
+
+        // Second is only passed through
+        instance->handleEvent(MockEvent::Forward);
+        instance->handleEvent(MockEvent::Forward);
+        ASSERT_EQ(instance->getCurrentStateId(), MockStateId::Third);
+        ASSERT_EQ(instance->getPerformingStateId(), MockStateId::First);
+        instance->run();
+
+        ASSERT_TRUE(StateMachine::MockStateFactory::secondStateCreated);
+        ASSERT_EQ(instance->getPerformingStateId(), MockStateId::Third);
+        // Second was entered and exited without running
+        ASSERT_EQ(StateMachine::MockStateFactory::lastStateData.enteredCnt, 1);
+        ASSERT_EQ(StateMachine::MockStateFactory::lastStateData.runCnt, 0);
+        ASSERT_EQ(StateMachine::MockStateFactory::lastStateData.exitedCnt, 1);
+        auto third_state = dynamic_cast<StateMachine::MockStates::Third *>(StateMachine::MockStateFactory::pointers.third);
+        ASSERT_TRUE(third_state != nullptr);
+        ASSERT_EQ(third_state->enteredCnt, 1);
+        ASSERT_EQ(third_state->runCnt, 1);
+        ASSERT_EQ(instance->getDroppedTransitions(), 0u);
+    }
+
     /**
      * @test Verifies states are run and transitioned correctly with concurrent events.
      */
-    TEST(StateManagerTest, stateRunWithEvent)
+    TEST_F(StateManagerTest, stateRunWithEvent)
     {
         // Create instance of StateManager with mock states
         auto instance = StateMachine::StateManager<MockStateId, MockEvent, mockStateTransMatrix>::getInstance(MockStateId::First);
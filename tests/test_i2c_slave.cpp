@@ -0,0 +1,360 @@
+/***********************************************************************
+ * @file	:	test_i2c_slave.cpp
+ * @brief 	:	Test cases for I2CSlave against simulated i2c and DMA registers.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#include "i2c_slave.hpp"
+#include "i2c_bus_simulator.hpp"
+#include <gtest/gtest.h>
+#include <vector>
+#include <memory>
+
+using namespace Communication;
+using namespace Communication::Hardware;
+
+namespace Tests {
+
+    static std::vector<uint8_t> received;
+    static RxMessageId receivedId;
+    static std::vector<std::vector<uint8_t>> frames;
+
+    static void rxHandler(RxMessageId msgId, size_t dataLength, const uint8_t * data)
+    {
+        receivedId = msgId;
+        received.assign(data, data + dataLength);
+        frames.push_back(std::vector<uint8_t>{msgId});
+        frames.back().insert(frames.back().end(), data, data + dataLength);
+    }
+
+    static void txHandler(uint8_t * data)
+    {
+        *data = 0xEE;
+    }
+
+    static std::vector<uint64_t> urgentCalls;
+
+    static void urgentHandler()
+    {
+        urgentCalls.push_back(mockTimeUs);
+    }
+
+    /**
+     * @brief Test fixture driving I2CSlave through the register level bus simulator.
+     */
+    class I2CSlaveTest : public ::testing::Test
+    {
+        protected:
+            void SetUp() override
+            {
+                start(true, DispatchMode::Immediate);
+            }
+
+            void start(bool enableDMA, DispatchMode mode)
+            {
+                // Frames left by a previous test are not handed over
+                RxFrames::View view;
+                while (I2CSlave::receiveFrame(view)) {}
+                received.clear();
+                frames.clear();
+                I2CSlave::init(rxHandler, txHandler, DEFAULT_I2C_SLAVE_ADDRESS, DEFAULT_I2C_BAUD_RATE, enableDMA, mode);
+                ASSERT_NE(mockIrqHandlers[I2C0_IRQ], nullptr);
+                bus = std::make_unique<Mocks::I2CBusSimulator>();
+            }
+
+            void masterWrite(const std::vector<uint8_t> & bytes)
+            {
+                bus->write(bytes).run();
+            }
+
+            std::vector<uint8_t> masterRead(size_t count, bool stop = true)
+            {
+                bus->read(count, stop).run();
+                EXPECT_EQ(bus->badTxWords(), 0u); // CMD, STOP and RESTART bits stay cleared
+                return bus->takeReadBytes();
+            }
+
+            std::unique_ptr<Mocks::I2CBusSimulator> bus;
+    };
+
+    /**
+     * @test Verifies that a frame received by DMA is handed over with its payload length.
+     */
+    TEST_F(I2CSlaveTest, DmaReceive)
+    {
+        masterWrite({0x07, 1, 2, 3});
+        EXPECT_EQ(receivedId, 0x07);
+        EXPECT_EQ(received, (std::vector<uint8_t>{1, 2, 3}));
+    }
+
+    /**
+     * @test Verifies that a published response is sent in order by DMA with a single read request interrupt.
+     */
+    TEST_F(I2CSlaveTest, DmaResponse)
+    {
+        std::vector<uint8_t> response;
+        for (uint8_t i = 0; i < 20; i++)
+        {
+            response.push_back(i + 1);
+        }
+        ASSERT_TRUE(I2CSlave::publishResponse(response.data(), response.size()));
+
+        EXPECT_EQ(masterRead(response.size()), response);
+        EXPECT_EQ(bus->interrupts(RD_REQ), 1);
+    }
+
+    /**
+     * @test Verifies that bytes read past the response, or without a response, come from the txHandler.
+     */
+    TEST_F(I2CSlaveTest, ResponseFallback)
+    {
+        const uint8_t response[] = {0x10, 0x20};
+        ASSERT_TRUE(I2CSlave::publishResponse(response, sizeof(response)));
+        EXPECT_EQ(masterRead(4), (std::vector<uint8_t>{0x10, 0x20, 0xEE, 0xEE}));
+    }
+
+    /**
+     * @test Verifies that a response stays armed for the next reads until a newer one is published.
+     */
+    TEST_F(I2CSlaveTest, ResponseRearmed)
+    {
+        const uint8_t status[] = {0x30, 0x31, 0x32};
+        const uint8_t update[] = {0x40, 0x41, 0x42};
+        ASSERT_TRUE(I2CSlave::publishResponse(status, sizeof(status)));
+        EXPECT_EQ(masterRead(3), (std::vector<uint8_t>{0x30, 0x31, 0x32}));
+        EXPECT_EQ(masterRead(3), (std::vector<uint8_t>{0x30, 0x31, 0x32}));
+        EXPECT_EQ(bus->interrupts(RD_REQ), 2);
+
+        // A newer response replaces it, also after a partial read
+        ASSERT_TRUE(I2CSlave::publishResponse(update, sizeof(update)));
+        EXPECT_EQ(masterRead(3), (std::vector<uint8_t>{0x40, 0x41, 0x42}));
+        EXPECT_EQ(masterRead(1), (std::vector<uint8_t>{0x40}));
+        EXPECT_EQ(masterRead(3), (std::vector<uint8_t>{0x40, 0x41, 0x42}));
+        EXPECT_EQ(bus->interrupts(RD_REQ), 5);
+    }
+
+    /**
+     * @test Verifies that the latest published response replaces a pending one.
+     */
+    TEST_F(I2CSlaveTest, ResponseReplaced)
+    {
+        const uint8_t first[] = {1, 2, 3};
+        const uint8_t second[] = {4, 5, 6};
+        ASSERT_TRUE(I2CSlave::publishResponse(first, sizeof(first)));
+        ASSERT_TRUE(I2CSlave::publishResponse(second, sizeof(second)));
+        EXPECT_EQ(masterRead(3), (std::vector<uint8_t>{4, 5, 6}));
+        EXPECT_FALSE(I2CSlave::publishResponse(first, BUFFER_SIZE + 1));
+    }
+
+    /**
+     * @test Verifies that a transmit abort stops the DMA transfer.
+     */
+    TEST_F(I2CSlaveTest, TxAbort)
+    {
+        uint32_t aborts = I2CSlave::txAborts();
+        uint8_t response[BUFFER_SIZE];
+        for (size_t i = 0; i < BUFFER_SIZE; i++)
+        {
+            response[i] = static_cast<uint8_t>(i);
+        }
+        ASSERT_TRUE(I2CSlave::publishResponse(response, sizeof(response)));
+
+        EXPECT_EQ(masterRead(5, false), (std::vector<uint8_t>{0, 1, 2, 3, 4}));
+        int channel = mockDmaChannelFor(DREQ_I2C0_TX);
+        ASSERT_GE(channel, 0);
+
+        bus->abort().run();
+        EXPECT_FALSE(dma_channel_is_busy(channel));
+        EXPECT_EQ(I2CSlave::txAborts(), aborts + 1);
+
+        // Nothing left to send by DMA
+        EXPECT_EQ(masterRead(1), (std::vector<uint8_t>{0xEE}));
+    }
+
+    /**
+     * @test Verifies that CRC-32 frames are checked by the DMA sniffer and the CRC is stripped.
+     */
+    TEST_F(I2CSlaveTest, SniffedIntegrity)
+    {
+        uint32_t corrupted = I2CSlave::corruptedFrames();
+        I2CSlave::setIntegrity(Integrity::Crc32);
+        ASSERT_TRUE(mockDmaSniffer.enabled);
+
+        uint8_t frame[BUFFER_SIZE] = {0x07, 1, 2, 3};
+        size_t length = appendIntegrity(Integrity::Crc32, frame, 4);
+        masterWrite(std::vector<uint8_t>(frame, frame + length));
+        EXPECT_EQ(received, (std::vector<uint8_t>{1, 2, 3}));
+
+        received.clear();
+        frame[2] ^= 0x01;
+        masterWrite(std::vector<uint8_t>(frame, frame + length));
+        EXPECT_TRUE(received.empty());
+        EXPECT_EQ(I2CSlave::corruptedFrames(), corrupted + 1);
+
+        I2CSlave::setIntegrity(Integrity::None);
+        EXPECT_FALSE(mockDmaSniffer.enabled);
+    }
+
+    /**
+     * @test Verifies that CRC-16 frames are checked in software before reaching the rxHandler.
+     */
+    TEST_F(I2CSlaveTest, SoftwareIntegrity)
+    {
+        uint32_t corrupted = I2CSlave::corruptedFrames();
+        I2CSlave::setIntegrity(Integrity::Crc16);
+        EXPECT_FALSE(mockDmaSniffer.enabled);
+
+        uint8_t frame[BUFFER_SIZE] = {0x05, 9};
+        size_t length = appendIntegrity(Integrity::Crc16, frame, 2);
+        frame[length - 1] ^= 0x80;
+        masterWrite(std::vector<uint8_t>(frame, frame + length));
+        EXPECT_TRUE(received.empty());
+        EXPECT_EQ(I2CSlave::corruptedFrames(), corrupted + 1);
+
+        frame[length - 1] ^= 0x80;
+        masterWrite(std::vector<uint8_t>(frame, frame + length));
+        EXPECT_EQ(receivedId, 0x05);
+        EXPECT_EQ(received, (std::vector<uint8_t>{9}));
+    }
+
+    /**
+     * @test Verifies that without DMA every byte is read by the handler on RX_FULL.
+     */
+    TEST_F(I2CSlaveTest, InterruptReceive)
+    {
+        start(false, DispatchMode::Immediate);
+        masterWrite({0x03, 4, 5});
+        EXPECT_EQ(receivedId, 0x03);
+        EXPECT_EQ(received, (std::vector<uint8_t>{4, 5}));
+        EXPECT_EQ(bus->interrupts(RX_FULL), 3);
+        EXPECT_EQ(masterRead(2), (std::vector<uint8_t>{0xEE, 0xEE}));
+        EXPECT_EQ(bus->interrupts(RD_REQ), 2);
+    }
+
+    /**
+     * @test Verifies that a burst longer than the frame pool is lost only when the main loop lags.
+     */
+    TEST_F(I2CSlaveTest, BurstLoss)
+    {
+        constexpr size_t burst = 3 * RX_FRAME_SLOTS;
+        for (uint64_t period : {200u, 2000u})
+        {
+            start(true, DispatchMode::Deferred);
+            uint32_t dropped = I2CSlave::droppedFrames();
+            bus->every(period, []() { I2CSlave::pump(); });
+            for (uint8_t id = 0; id < burst; id++)
+            {
+                bus->write({id, 1, 2, 3});
+            }
+            bus->runUntil(mockTimeUs + 10000);
+
+            // A 4 byte frame takes about 100us at 400kHz
+            size_t lost = (period == 200u) ? 0 : burst - RX_FRAME_SLOTS;
+            EXPECT_EQ(frames.size(), burst - lost) << "pump period " << period;
+            EXPECT_EQ(I2CSlave::droppedFrames() - dropped, lost);
+            EXPECT_EQ(bus->rxOverruns(), 0);
+        }
+    }
+
+    /**
+     * @test Verifies that the bytes of a frame dropped for lack of a slot do not leak into the next one.
+     */
+    TEST_F(I2CSlaveTest, DroppedFrameDrained)
+    {
+        start(true, DispatchMode::Deferred);
+        for (uint8_t id = 0; id <= RX_FRAME_SLOTS; id++)
+        {
+            masterWrite({id, 0xAA, 0xBB});
+        }
+        EXPECT_EQ(I2CSlave::pump(), RX_FRAME_SLOTS);
+
+        masterWrite({0x07, 1});
+        EXPECT_EQ(I2CSlave::pump(), 1);
+        EXPECT_EQ(frames.back(), (std::vector<uint8_t>{0x07, 1}));
+    }
+
+    /**
+     * @test Verifies that transactions are timed from START_DET to STOP_DET and that frames and
+     *       the pending frames high watermark are counted.
+     */
+    TEST_F(I2CSlaveTest, Statistics)
+    {
+        start(true, DispatchMode::Deferred);
+        commStatistics.reset();
+
+        // START and 4 bytes at 400kHz, 92.5us: [64, 128) bucket
+        masterWrite({0x07, 1, 2, 3});
+        masterWrite({0x07, 1, 2, 3});
+        EXPECT_EQ(commStatistics.transactionLatency.count(Log2Histogram::bucketOf(64)), 2u);
+        EXPECT_EQ(commStatistics.frames.get(), 2u);
+        EXPECT_EQ(commStatistics.pendingFrames.get(), 2u);
+
+        uint32_t isrCalls = 0;
+        for (size_t i = 0; i < HISTOGRAM_BUCKETS; i++)
+        {
+            isrCalls += commStatistics.isrDuration.count(i);
+        }
+        EXPECT_EQ(isrCalls, bus->interrupts(0xFFFFFFFF));
+        EXPECT_EQ(I2CSlave::pump(), 2);
+    }
+
+    /**
+     * @test Verifies that the urgent handler is called on the first data byte, before STOP, and
+     *       that frames are still received whole, with and without DMA.
+     */
+    TEST_F(I2CSlaveTest, UrgentFirstByte)
+    {
+        for (bool enableDMA : {true, false})
+        {
+            start(enableDMA, DispatchMode::Immediate);
+            I2CSlave::setUrgentHandler(0x00, urgentHandler);
+            urgentCalls.clear();
+
+            uint64_t start = mockTimeUs;
+            masterWrite({0x00, 1, 2, 3});
+            ASSERT_EQ(urgentCalls.size(), 1u);
+            // START and the first byte, 10 bit times at 400kHz
+            EXPECT_EQ(urgentCalls[0] - start, 25u);
+            EXPECT_LT(urgentCalls[0], mockTimeUs);
+            EXPECT_EQ(receivedId, 0x00);
+            EXPECT_EQ(received, (std::vector<uint8_t>{1, 2, 3}));
+
+            masterWrite({0x07, 0x00});
+            masterWrite({0x00});
+            EXPECT_EQ(urgentCalls.size(), 2u);
+            EXPECT_EQ(frames.back(), (std::vector<uint8_t>{0x00}));
+
+            // Reads in between do not leave the first byte pending
+            EXPECT_EQ(masterRead(1), (std::vector<uint8_t>{0xEE}));
+            masterWrite({0x05, 4, 5});
+            EXPECT_EQ(urgentCalls.size(), 2u);
+            EXPECT_EQ(frames.back(), (std::vector<uint8_t>{0x05, 4, 5}));
+        }
+    }
+
+    /**
+     * @test Verifies that the DMA sniffer still checks the whole frame when the first byte is
+     *       read by the ISR.
+     */
+    TEST_F(I2CSlaveTest, UrgentFirstByteSniffed)
+    {
+        uint32_t corrupted = I2CSlave::corruptedFrames();
+        I2CSlave::setIntegrity(Integrity::Crc32);
+        I2CSlave::setUrgentHandler(0x00, urgentHandler);
+        urgentCalls.clear();
+
+        uint8_t frame[BUFFER_SIZE] = {0x00, 1, 2, 3};
+        size_t length = appendIntegrity(Integrity::Crc32, frame, 4);
+        masterWrite(std::vector<uint8_t>(frame, frame + length));
+        EXPECT_EQ(urgentCalls.size(), 1u);
+        EXPECT_EQ(frames.back(), (std::vector<uint8_t>{0x00, 1, 2, 3}));
+
+        frame[0] ^= 0x40;
+        masterWrite(std::vector<uint8_t>(frame, frame + length));
+        EXPECT_EQ(frames.size(), 1u);
+        EXPECT_EQ(I2CSlave::corruptedFrames(), corrupted + 1);
+        I2CSlave::setIntegrity(Integrity::None);
+    }
+
+} // namespace Tests
@@ -8,6 +8,7 @@
 #include "message_format.hpp"
 #include "communication_handler.hpp"
 #include <gtest/gtest.h>
+#include <thread>
 
 using namespace Communication;
 
@@ -113,4 +114,98 @@ namespace Tests {
         EXPECT_EQ(*queue.front(), 0); // The front element should be 0
     }
 
+    /**
+     * @test Verifies that the lock-free queue is correctly initialized.
+     */
+    TEST(SpscQueueTest, Initialization) {
+        SpscQueue<uint16_t, 16> queue;
+        EXPECT_TRUE(queue.isEmpty());
+        EXPECT_FALSE(queue.isFull());
+        EXPECT_EQ(queue.size(), 0);
+        EXPECT_EQ(queue.front(), nullptr);
+    }
+
+    /**
+     * @test Verifies that every slot is usable and overflow/underflow are reported.
+     */
+    TEST(SpscQueueTest, OverflowAndUnderflow) {
+        SpscQueue<uint16_t, 16> queue;
+        uint16_t value;
+
+        for (uint16_t i = 0; i < 16; ++i) {
+            EXPECT_TRUE(queue.push(i));
+        }
+        EXPECT_TRUE(queue.isFull());
+        EXPECT_FALSE(queue.push(0));
+
+        for (uint16_t i = 0; i < 16; ++i) {
+            EXPECT_TRUE(queue.pop(value));
+            EXPECT_EQ(value, i);
+        }
+        EXPECT_TRUE(queue.isEmpty());
+        EXPECT_FALSE(queue.pop(value));
+    }
+
+    /**
+     * @test Verifies that elements keep FIFO order when the indices wrap around.
+     */
+    TEST(SpscQueueTest, WrapAround) {
+        SpscQueue<uint32_t, 4> queue;
+        uint32_t value;
+
+        for (uint32_t i = 0; i < 100; ++i) {
+            EXPECT_TRUE(queue.push(i));
+            EXPECT_TRUE(queue.push(i + 1000));
+            EXPECT_EQ(*queue.front(), i);
+            EXPECT_TRUE(queue.pop(value));
+            EXPECT_EQ(value, i);
+            EXPECT_TRUE(queue.pop(value));
+            EXPECT_EQ(value, i + 1000);
+        }
+    }
+
+    /**
+     * @test Verifies that clear discards pending elements.
+     */
+    TEST(SpscQueueTest, Clear) {
+        SpscQueue<uint8_t, 8> queue;
+        for (uint8_t i = 0; i < 5; ++i) {
+            EXPECT_TRUE(queue.push(i));
+        }
+        queue.clear();
+        EXPECT_TRUE(queue.isEmpty());
+        EXPECT_TRUE(queue.push(42));
+        EXPECT_EQ(*queue.front(), 42);
+    }
+
+    /**
+     * @test Verifies that no element is lost nor reordered with a concurrent producer and consumer.
+     */
+    TEST(SpscQueueTest, ConcurrentProducerConsumer) {
+        constexpr uint32_t count = 200000;
+        SpscQueue<uint32_t, 32> queue;
+
+        std::thread producer([&queue]() {
+            for (uint32_t i = 0; i < count; ++i) {
+                while (!queue.push(i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+        uint32_t expected = 0;
+        uint32_t value;
+        while (expected < count) {
+            if (queue.pop(value)) {
+                ASSERT_EQ(value, expected);
+                ++expected;
+            }
+            else {
+                std::this_thread::yield();
+            }
+        }
+        producer.join();
+        EXPECT_TRUE(queue.isEmpty());
+    }
+
 } // namespace Tests
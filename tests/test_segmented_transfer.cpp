@@ -0,0 +1,190 @@
+/***********************************************************************
+ * @file	:	test_segmented_transfer.cpp
+ * @brief 	:	Test cases for the segmented transfer protocol.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#include "segmented_transfer.hpp"
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace Communication;
+
+namespace Tests {
+
+    constexpr size_t RECORD_SIZE = 24;
+    constexpr RxMessageId SEGMENT_ID = 0x09;
+
+    static std::vector<uint8_t> sinkData;
+    static std::vector<size_t> sinkChunks;
+
+    static void sink(const uint8_t * data, size_t length)
+    {
+        sinkData.insert(sinkData.end(), data, data + length);
+        sinkChunks.push_back(length);
+    }
+
+    /**
+     * @brief Test fixture with a message made of records and a receiver.
+     */
+    class SegmentedTransferTest : public ::testing::Test
+    {
+        protected:
+            void SetUp() override
+            {
+                sinkData.clear();
+                sinkChunks.clear();
+                message.resize(RECORD_SIZE * 10);
+                for (size_t i = 0; i < message.size(); i++)
+                {
+                    message[i] = static_cast<uint8_t>(i * 7);
+                }
+            }
+
+            /**
+             * @brief Split the message into frames, as sent by the master.
+             */
+            std::vector<std::vector<uint8_t>> split()
+            {
+                std::vector<std::vector<uint8_t>> frames;
+                SegmentedSender sender(SEGMENT_ID, message.data(), message.size());
+                uint8_t frame[BUFFER_SIZE];
+                size_t length;
+                while ((length = sender.nextFrame(frame)) != 0)
+                {
+                    EXPECT_EQ(frame[0], SEGMENT_ID);
+                    EXPECT_LE(length, BUFFER_SIZE);
+                    frames.emplace_back(frame, frame + length);
+                }
+                EXPECT_TRUE(sender.isComplete());
+                return frames;
+            }
+
+            /**
+             * @brief Deliver a frame payload, i.e. without the message id.
+             */
+            TransferStatus deliver(const std::vector<uint8_t> & frame)
+            {
+                return receiver.receive(frame.data() + 1, frame.size() - 1);
+            }
+
+            std::vector<uint8_t> message;
+            SegmentedReceiver receiver{sink, RECORD_SIZE, 8, 0, 1024};
+    };
+
+    /**
+     * @test Verifies that a message is reassembled in whole records.
+     */
+    TEST_F(SegmentedTransferTest, Reassembly)
+    {
+        auto frames = split();
+        // 26 bytes in the first frame, 30 in each consecutive frame
+        ASSERT_EQ(frames.size(), 9);
+
+        for (size_t i = 0; i < frames.size() - 1; i++)
+        {
+            EXPECT_EQ(deliver(frames[i]), TransferStatus::InProgress);
+        }
+        EXPECT_EQ(deliver(frames.back()), TransferStatus::Complete);
+        EXPECT_EQ(receiver.getReceivedLength(), message.size());
+        EXPECT_EQ(sinkData, message);
+        for (size_t chunk : sinkChunks)
+        {
+            EXPECT_EQ(chunk % RECORD_SIZE, 0);
+        }
+    }
+
+    /**
+     * @test Verifies that a repeated consecutive frame is ignored.
+     */
+    TEST_F(SegmentedTransferTest, DuplicateSegment)
+    {
+        auto frames = split();
+        for (size_t i = 0; i < frames.size(); i++)
+        {
+            deliver(frames[i]);
+            if (i == 3)
+            {
+                EXPECT_EQ(deliver(frames[i]), TransferStatus::InProgress);
+            }
+        }
+        EXPECT_EQ(receiver.getStatus(), TransferStatus::Complete);
+        EXPECT_EQ(receiver.getDuplicates(), 1);
+        EXPECT_EQ(sinkData, message);
+    }
+
+    /**
+     * @test Verifies that a missing consecutive frame aborts the transfer.
+     */
+    TEST_F(SegmentedTransferTest, MissingSegment)
+    {
+        auto frames = split();
+        deliver(frames[0]);
+        deliver(frames[1]);
+        EXPECT_EQ(deliver(frames[3]), TransferStatus::WrongSequence);
+        // Following frames are ignored until a new first frame
+        EXPECT_EQ(deliver(frames[4]), TransferStatus::WrongSequence);
+
+        uint8_t flowControl[FLOW_CONTROL_SIZE];
+        ASSERT_EQ(receiver.flowControl(flowControl), FLOW_CONTROL_SIZE);
+        EXPECT_EQ(flowControl[0], 0x32);
+
+        // Restart
+        sinkData.clear();
+        for (const auto & frame : frames)
+        {
+            deliver(frame);
+        }
+        EXPECT_EQ(receiver.getStatus(), TransferStatus::Complete);
+        EXPECT_EQ(sinkData, message);
+    }
+
+    /**
+     * @test Verifies that the sequence number wraps around on long messages.
+     */
+    TEST_F(SegmentedTransferTest, SequenceWrap)
+    {
+        message.resize(RECORD_SIZE * 40);
+        auto frames = split();
+        ASSERT_GT(frames.size(), 17);
+        EXPECT_EQ(frames[15][1], 0x2F);
+        EXPECT_EQ(frames[16][1], 0x20);
+        EXPECT_EQ(frames[17][1], 0x21);
+        for (const auto & frame : frames)
+        {
+            deliver(frame);
+        }
+        EXPECT_EQ(receiver.getStatus(), TransferStatus::Complete);
+        EXPECT_EQ(sinkData, message);
+    }
+
+    /**
+     * @test Verifies that lengths that are too long or not made of whole records are rejected.
+     */
+    TEST_F(SegmentedTransferTest, LengthRejected)
+    {
+        const uint8_t tooLong[] = {0x10, 0x00, 0x00, 0x10, 0x00};
+        EXPECT_EQ(receiver.receive(tooLong, sizeof(tooLong)), TransferStatus::Overflow);
+        const uint8_t partialRecord[] = {0x10, 0x00, 0x00, 0x00, 0x19};
+        EXPECT_EQ(receiver.receive(partialRecord, sizeof(partialRecord)), TransferStatus::Overflow);
+        const uint8_t shortFrame[] = {0x10, 0x00};
+        EXPECT_EQ(receiver.receive(shortFrame, sizeof(shortFrame)), TransferStatus::Malformed);
+        EXPECT_TRUE(sinkData.empty());
+    }
+
+    /**
+     * @test Verifies the flow control frame while a transfer is in progress.
+     */
+    TEST_F(SegmentedTransferTest, FlowControl)
+    {
+        auto frames = split();
+        deliver(frames[0]);
+        uint8_t flowControl[FLOW_CONTROL_SIZE];
+        ASSERT_EQ(receiver.flowControl(flowControl), FLOW_CONTROL_SIZE);
+        EXPECT_EQ(flowControl[0], 0x30);
+        EXPECT_EQ(flowControl[1], 8);
+        EXPECT_EQ(flowControl[2], 0);
+    }
+
+} // namespace Tests
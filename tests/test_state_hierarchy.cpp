@@ -0,0 +1,149 @@
+/***********************************************************************
+ * @file	:	test_state_hierarchy.cpp
+ * @brief 	:	Test cases for entry and exit chains of hierarchical
+ *              state machines.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#include "state_manager.hpp"
+#include "static_state_manager.hpp"
+#include "state_slab.hpp"
+#include "state_hierarchy.hpp"
+#include "transition_table.hpp"
+#include <gtest/gtest.h>
+#include <utility>
+#include <vector>
+
+using namespace StateMachine;
+
+namespace Tests {
+
+    // Q is the root, P and C are children of Q, A and B are children of P
+    enum class Node : uint8_t { A, B, C, P, Q };
+    enum class Step : uint8_t { Next, Back };
+
+    constexpr Parent<Node> nodeParents[] = {{Node::A, Node::P}, {Node::B, Node::P}, {Node::P, Node::Q}, {Node::C, Node::Q}};
+    constexpr StateHierarchy<Node, 5> nodeHierarchy{nodeParents};
+    constexpr Transition<Node, Step> nodeTransitions[] = {{Node::A, Step::Next, Node::B},
+                                                          {Node::B, Step::Next, Node::C},
+                                                          {Node::C, Step::Next, Node::A},
+                                                          {Node::P, Step::Back, Node::C}};
+    constexpr TransitionTable<Node, Step, 5, 2> nodeTable{nodeTransitions, nodeHierarchy};
+
+    inline Node nodeMatrix(Node node, Step step)
+    {
+        return nodeTable(node, step);
+    }
+
+    enum class Call : uint8_t { Enter, Exit };
+    static std::vector<std::pair<Call, Node>> calls;
+
+    template <Node id>
+    class Logged : public State<Node, Step, nodeMatrix>
+    {
+        public:
+            Logged(StateManager_ * instance) : State(id, instance) {}
+            void run() override {}
+            void onEnter() override { calls.emplace_back(Call::Enter, id); }
+            void onExit() override { calls.emplace_back(Call::Exit, id); }
+    };
+
+} // namespace Tests
+
+namespace StateMachine {
+
+    template <>
+    struct StateHierarchyOf<Tests::Node, Tests::Step, Tests::nodeMatrix>
+    {
+        static constexpr const auto & value = Tests::nodeHierarchy;
+    };
+
+    template <>
+    class StateFactory<Tests::Node, Tests::Step, Tests::nodeMatrix>
+    {
+        public:
+            static StatePtr<Tests::Node, Tests::Step, Tests::nodeMatrix>
+                createState(Tests::Node sId, StateManager<Tests::Node, Tests::Step, Tests::nodeMatrix> * sManager)
+            {
+                static StateSlab<Tests::Node, Tests::Step, Tests::nodeMatrix, 5,
+                                 Tests::Logged<Tests::Node::A>, Tests::Logged<Tests::Node::B>, Tests::Logged<Tests::Node::C>,
+                                 Tests::Logged<Tests::Node::P>, Tests::Logged<Tests::Node::Q>> states;
+                return states.get(sId, sManager);
+            }
+    };
+
+} // namespace StateMachine
+
+namespace Tests {
+
+    class NodeManager : public StateManager<Node, Step, nodeMatrix>
+    {
+        public:
+            NodeManager() : StateManager(Node::A) {}
+    };
+
+    using StaticNodeManager = StaticStateManager<Node, Step, nodeMatrix, 5, Logged<Node::A>, Logged<Node::B>,
+                                                 Logged<Node::C>, Logged<Node::P>, Logged<Node::Q>>;
+
+    using Calls = std::vector<std::pair<Call, Node>>;
+
+    /**
+     * @brief Drive a manager through sibling, cousin and bubbled transitions and check the calls.
+     */
+    template <typename Manager>
+    static void checkChains(Manager & manager)
+    {
+        calls.clear();
+        manager.run();
+        EXPECT_EQ(calls, (Calls{{Call::Enter, Node::Q}, {Call::Enter, Node::P}, {Call::Enter, Node::A}}));
+
+        // Siblings share P
+        calls.clear();
+        manager.handleEvent(Step::Next);
+        manager.run();
+        EXPECT_EQ(calls, (Calls{{Call::Exit, Node::A}, {Call::Enter, Node::B}}));
+
+        // C is a child of Q, P is left
+        calls.clear();
+        manager.handleEvent(Step::Next);
+        manager.run();
+        EXPECT_EQ(calls, (Calls{{Call::Exit, Node::B}, {Call::Exit, Node::P}, {Call::Enter, Node::C}}));
+
+        calls.clear();
+        manager.handleEvent(Step::Next);
+        manager.run();
+        EXPECT_EQ(calls, (Calls{{Call::Exit, Node::C}, {Call::Enter, Node::P}, {Call::Enter, Node::A}}));
+
+        // Back bubbles up from A to P
+        calls.clear();
+        manager.handleEvent(Step::Back);
+        manager.run();
+        EXPECT_EQ(manager.getPerformingStateId(), Node::C);
+        EXPECT_EQ(calls, (Calls{{Call::Exit, Node::A}, {Call::Exit, Node::P}, {Call::Enter, Node::C}}));
+
+        calls.clear();
+        manager.handleEvent(Step::Back);
+        manager.run();
+        EXPECT_TRUE(calls.empty());
+    }
+
+    /**
+     * @test Verifies the entry and exit chains of StateManager.
+     */
+    TEST(StateHierarchyTest, StateManager)
+    {
+        NodeManager manager;
+        checkChains(manager);
+    }
+
+    /**
+     * @test Verifies the entry and exit chains of StaticStateManager.
+     */
+    TEST(StateHierarchyTest, StaticStateManager)
+    {
+        StaticNodeManager manager(Node::A);
+        checkChains(manager);
+    }
+
+} // namespace Tests
@@ -0,0 +1,83 @@
+/***********************************************************************
+ * @file	:	test_state_machine_bank.cpp
+ * @brief 	:	Test cases for banks of independent state machines,
+ *              with the per joint state machines of the robotic arm.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#include "joint_state_machine.hpp"
+#include "fsm_state_manager.hpp"
+#include <gtest/gtest.h>
+#include <memory>
+
+using namespace StateMachine;
+using namespace StateMachine::RobotArm::Joint;
+
+namespace Tests {
+
+    /**
+     * @test Verifies that the joints change state independently, each with its own states.
+     */
+    TEST(StateMachineBankTest, IndependentJoints)
+    {
+        auto joints = std::make_unique<JointBank>(StateId::Unhomed);
+        ASSERT_EQ(JointBank::size(), Robotics::NUM_JOINTS);
+        joints->runAll();
+
+        EXPECT_TRUE((*joints)[0].handleEvent(Event::Home));
+        EXPECT_TRUE((*joints)[2].handleEvent(Event::Fault));
+        joints->runAll();
+        EXPECT_EQ((*joints)[0].getPerformingStateId(), StateId::Homing);
+        EXPECT_EQ((*joints)[1].getPerformingStateId(), StateId::Unhomed);
+        EXPECT_EQ((*joints)[2].getPerformingStateId(), StateId::Fault);
+        EXPECT_NE(&(*joints)[0].getState<States::Homing>(), &(*joints)[1].getState<States::Homing>());
+
+        // Homing is already started on joint 0 and not possible on the faulted joint 2
+        EXPECT_EQ(joints->broadcast(Event::Home), Robotics::NUM_JOINTS - 2);
+        joints->runAll();
+        for (size_t joint = 0; joint < JointBank::size(); joint++)
+        {
+            EXPECT_EQ((*joints)[joint].getPerformingStateId(), (joint == 2) ? StateId::Fault : StateId::Homing);
+        }
+    }
+
+    /**
+     * @test Verifies that the homing timeout faults only the joints not homed in time.
+     */
+    TEST(StateMachineBankTest, HomingTimeout)
+    {
+        auto joints = std::make_unique<JointBank>(StateId::Unhomed);
+        TimerClock clock;
+        joints->broadcast(Event::Home);
+        joints->runAll();
+
+        clock.advance(19999);
+        joints->advanceTimers(clock.now());
+        (*joints)[1].handleEvent(Event::Homed);
+        (*joints)[4].handleEvent(Event::Homed);
+        joints->runAll();
+
+        clock.advance(1);
+        joints->advanceTimers(clock.now());
+        joints->runAll();
+        for (size_t joint = 0; joint < JointBank::size(); joint++)
+        {
+            StateId expected = (joint == 1 || joint == 4) ? StateId::Homed : StateId::Fault;
+            EXPECT_EQ((*joints)[joint].getPerformingStateId(), expected);
+            EXPECT_EQ((*joints)[joint].getTimers().pending(), 0u);
+        }
+    }
+
+    /**
+     * @test Verifies that banks are built in static storage, beside the arm singleton.
+     */
+    TEST(StateMachineBankTest, StaticStorage)
+    {
+        static JointBank joints(StateId::Unhomed);
+        joints.runAll();
+        EXPECT_EQ(joints[5].getPerformingStateId(), joints[5].getCurrentStateId());
+        EXPECT_EQ(RobotArm::FSMStateManager::getInstance(), RobotArm::FSMStateManager::getInstance());
+    }
+
+} // namespace Tests
@@ -0,0 +1,143 @@
+/***********************************************************************
+ * @file	:	test_static_state_manager.cpp
+ * @brief 	:	Test cases for StaticStateManager.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#include "static_state_manager.hpp"
+#include "fsm_state_manager.hpp"
+#include "mock_states.hpp"
+#include <gtest/gtest.h>
+
+using namespace StateMachine;
+
+namespace Tests {
+
+    template <MockStateId id>
+    class Counted : public State<MockStateId, MockEvent, mockStateTransMatrix>
+    {
+        public:
+            Counted(StateManager_ * instance) : State(id, instance) {}
+            void run() override { runCnt++; }
+            void onEnter() override { enteredCnt++; }
+            void onExit() override { exitedCnt++; }
+            int enteredCnt = 0;
+            int exitedCnt = 0;
+            int runCnt = 0;
+    };
+
+    using First = Counted<MockStateId::First>;
+    using Second = Counted<MockStateId::Second>;
+    using Third = Counted<MockStateId::Third>;
+
+    /**
+     * @test Verifies states are entered, run and exited in order, and that states keep their
+     *       members between activations.
+     */
+    TEST(StaticStateManagerTest, stateRun)
+    {
+        StaticStateManager<MockStateId, MockEvent, mockStateTransMatrix, 3, First, Second, Third> manager(MockStateId::First);
+        First & first = manager.getState<First>();
+        Second & second = manager.getState<Second>();
+        EXPECT_EQ(first.enteredCnt, 0);
+
+        manager.run();
+        EXPECT_EQ(first.enteredCnt, 1);
+        EXPECT_EQ(first.runCnt, 1);
+
+        manager.handleEvent(MockEvent::Forward);
+        EXPECT_EQ(manager.getCurrentStateId(), MockStateId::Second);
+        EXPECT_EQ(manager.getPerformingStateId(), MockStateId::First);
+        manager.run();
+        EXPECT_EQ(manager.getPerformingStateId(), MockStateId::Second);
+        EXPECT_EQ(first.exitedCnt, 1);
+        EXPECT_EQ(second.enteredCnt, 1);
+        EXPECT_EQ(second.runCnt, 1);
+
+        // Back to First, then no transition on the second event
+        manager.handleEvent(MockEvent::Backward);
+        manager.handleEvent(MockEvent::Backward);
+        manager.run();
+        manager.run();
+        EXPECT_EQ(manager.getPerformingStateId(), MockStateId::First);
+        EXPECT_EQ(first.enteredCnt, 2);
+        EXPECT_EQ(first.runCnt, 3);
+        EXPECT_EQ(second.exitedCnt, 1);
+        EXPECT_EQ(manager.getState<Third>().runCnt, 0);
+    }
+
+    /**
+     * @test Verifies that a state id without a state class is tracked but runs nothing.
+     */
+    TEST(StaticStateManagerTest, missingState)
+    {
+        StaticStateManager<MockStateId, MockEvent, mockStateTransMatrix, 3, First, Second> manager(MockStateId::First);
+        manager.run();
+        manager.handleEvent(MockEvent::Forward);
+        manager.run();
+        manager.handleEvent(MockEvent::Forward);
+        manager.run();
+        EXPECT_EQ(manager.getPerformingStateId(), MockStateId::Third);
+        EXPECT_EQ(manager.getState<Second>().exitedCnt, 1);
+
+        manager.handleEvent(MockEvent::Backward);
+        manager.run();
+        EXPECT_EQ(manager.getState<Second>().enteredCnt, 2);
+        EXPECT_EQ(manager.getState<Second>().runCnt, 2);
+    }
+
+    /**
+     * @test Verifies that transitions beyond the queue capacity are counted as dropped and that
+     *       run() still ends in the current state.
+     */
+    TEST(StaticStateManagerTest, queueOverflow)
+    {
+        StaticStateManager<MockStateId, MockEvent, mockStateTransMatrix, 3, First, Second, Third> manager(MockStateId::First);
+        constexpr size_t capacity = TransitionQueueCapacity<MockStateId, MockEvent, mockStateTransMatrix>::value;
+        manager.run();
+        for (size_t i = 0; i < capacity + 3; i++)
+        {
+            manager.handleEvent((i % 2 == 0) ? MockEvent::Forward : MockEvent::Backward);
+        }
+        EXPECT_EQ(manager.getDroppedTransitions(), 3u);
+        EXPECT_EQ(manager.getCurrentStateId(), MockStateId::Second);
+        manager.run();
+
+        // Queued transitions are replayed, then the manager skips to the current state
+        EXPECT_EQ(manager.getPerformingStateId(), MockStateId::Second);
+        EXPECT_EQ(manager.getState<Second>().enteredCnt, static_cast<int>(capacity / 2 + 1));
+        EXPECT_EQ(manager.getState<Second>().runCnt, 1);
+        EXPECT_EQ(manager.getState<First>().runCnt, 1);
+
+        manager.handleEvent(MockEvent::Forward);
+        manager.run();
+        EXPECT_EQ(manager.getPerformingStateId(), MockStateId::Third);
+        EXPECT_EQ(manager.getDroppedTransitions(), 3u);
+    }
+
+    /**
+     * @test Verifies that the robotic arm static manager follows the same transitions as
+     *       FSMStateManager.
+     */
+    TEST(StaticStateManagerTest, RobotArm)
+    {
+        using namespace StateMachine::RobotArm;
+        FSMStaticStateManager * instance = FSMStaticStateManager::getInstance();
+        ASSERT_EQ(instance, FSMStaticStateManager::getInstance());
+        EXPECT_EQ(instance->getCurrentStateId(), StateId::Init);
+
+        const Event events[] = {Event::Done, Event::Load, Event::ProgramLoaded, Event::Start, Event::Done,
+                                Event::Pause, Event::Resume, Event::EmergencyStop, Event::Cancel};
+        StateId expected = StateId::Init;
+        instance->run();
+        for (Event event : events)
+        {
+            expected = stateTransMatrix(expected, event);
+            instance->handleEvent(std::move(event));
+            instance->run();
+            EXPECT_EQ(instance->getPerformingStateId(), expected);
+        }
+    }
+
+} // namespace Tests
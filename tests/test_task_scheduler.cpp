@@ -0,0 +1,155 @@
+/***********************************************************************
+ * @file	:	test_task_scheduler.cpp
+ * @brief 	:	Test cases for the cooperative task scheduler, on the
+ *              simulated clock of the hardware mocks.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#include "task_scheduler.hpp"
+#include "hardware/timer.h"
+#include <gtest/gtest.h>
+#include <string>
+
+using namespace Utilities;
+
+namespace Tests {
+
+    /**
+     * @brief Task taking a fixed simulated time, logging its name.
+     */
+    struct SimulatedTask
+    {
+        char name;
+        uint32_t durationUs;
+        std::string * trace;
+
+        static void run(void * context)
+        {
+            SimulatedTask * task = static_cast<SimulatedTask *>(context);
+            if (task->trace != nullptr)
+            {
+                task->trace->push_back(task->name);
+            }
+            mockTimeUs += task->durationUs;
+        }
+    };
+
+    /**
+     * @test Verifies rate-monotonic order: shorter periods first, idle tasks only when nothing is
+     *       released.
+     */
+    TEST(TaskSchedulerTest, RateMonotonicOrder)
+    {
+        mockTimeUs = 0;
+        std::string trace;
+        SimulatedTask telemetry{'T', 100, &trace};
+        SimulatedTask fsm{'F', 100, &trace};
+        SimulatedTask flush{'L', 100, &trace};
+        TaskScheduler scheduler;
+        EXPECT_EQ(scheduler.addTask(SimulatedTask::run, &telemetry, 10000), 0u);
+        EXPECT_EQ(scheduler.addIdleTask(SimulatedTask::run, &flush), 1u);
+        EXPECT_EQ(scheduler.addTask(SimulatedTask::run, &fsm, 1000), 2u);
+        EXPECT_EQ(scheduler.addTask(SimulatedTask::run, &fsm, 0), MAX_TASKS);
+
+        EXPECT_TRUE(scheduler.runOnce());
+        EXPECT_TRUE(scheduler.runOnce());
+        EXPECT_FALSE(scheduler.runOnce());
+        EXPECT_EQ(trace, "FTL");
+
+        // Idle work until the next release of the 1 kHz task
+        while (!scheduler.runOnce()) {}
+        EXPECT_EQ(mockTimeUs, 1100u);
+        EXPECT_EQ(trace.back(), 'F');
+        EXPECT_EQ(scheduler.stats(2).runs, 2u);
+        EXPECT_EQ(scheduler.stats(0).runs, 1u);
+    }
+
+    /**
+     * @test Verifies execution time and jitter statistics over a simulated second, and their
+     *       snapshot words.
+     */
+    TEST(TaskSchedulerTest, Statistics)
+    {
+        mockTimeUs = 0;
+        SimulatedTask fsm{'F', 200, nullptr};
+        SimulatedTask telemetry{'T', 900, nullptr};
+        SimulatedTask flush{'L', 30, nullptr};
+        TaskScheduler scheduler;
+        size_t fsmTask = scheduler.addTask(SimulatedTask::run, &fsm, 1000);
+        size_t telemetryTask = scheduler.addTask(SimulatedTask::run, &telemetry, 10000);
+        size_t flushTask = scheduler.addIdleTask(SimulatedTask::run, &flush);
+
+        while (mockTimeUs < 1000000)
+        {
+            scheduler.runOnce();
+        }
+        const TaskStats & stats = scheduler.stats(fsmTask);
+        EXPECT_GE(stats.runs, 999u);
+        EXPECT_LE(stats.runs, 1000u);
+        EXPECT_EQ(stats.minUs, 200u);
+        EXPECT_EQ(stats.maxUs, 200u);
+        EXPECT_EQ(stats.avgUs(), 200u);
+        EXPECT_EQ(stats.overruns, 0u);
+        // Delayed by telemetry or idle work already started
+        EXPECT_GT(stats.maxJitterUs, 0u);
+        EXPECT_LT(stats.maxJitterUs, 900u);
+        EXPECT_EQ(scheduler.stats(telemetryTask).runs, 100u);
+        EXPECT_GT(scheduler.stats(flushTask).runs, 0u);
+
+        size_t base = fsmTask * TASK_STAT_WORDS;
+        EXPECT_EQ(scheduler.word(base + static_cast<size_t>(TaskStatWord::Runs)), stats.runs);
+        EXPECT_EQ(scheduler.word(base + static_cast<size_t>(TaskStatWord::AvgUs)), 200u);
+        EXPECT_EQ(scheduler.word(base + static_cast<size_t>(TaskStatWord::MaxJitterUs)), stats.maxJitterUs);
+        EXPECT_EQ(scheduler.word(telemetryTask * TASK_STAT_WORDS + static_cast<size_t>(TaskStatWord::MaxUs)), 900u);
+        EXPECT_EQ(scheduler.word(scheduler.taskCount() * TASK_STAT_WORDS), 0u);
+
+        scheduler.resetStats();
+        EXPECT_EQ(scheduler.word(base + static_cast<size_t>(TaskStatWord::MinUs)), 0u);
+    }
+
+    /**
+     * @test Verifies that a task longer than its period counts overruns and keeps its phase.
+     */
+    TEST(TaskSchedulerTest, Overruns)
+    {
+        mockTimeUs = 500;
+        SimulatedTask slow{'S', 2500, nullptr};
+        TaskScheduler scheduler;
+        size_t task = scheduler.addTask(SimulatedTask::run, &slow, 1000);
+
+        EXPECT_TRUE(scheduler.runOnce());
+        // Releases at 1500 and 2500 passed, next one at 3500
+        EXPECT_EQ(scheduler.stats(task).overruns, 2u);
+        EXPECT_FALSE(scheduler.runOnce());
+        mockTimeUs = 3500;
+        EXPECT_TRUE(scheduler.runOnce());
+        EXPECT_EQ(scheduler.stats(task).overruns, 4u);
+        EXPECT_EQ(scheduler.stats(task).maxJitterUs, 0u);
+    }
+
+    /**
+     * @test Verifies that a task ending exactly at its next release does not overrun, and runs
+     *       again at that release.
+     */
+    TEST(TaskSchedulerTest, EndAtRelease)
+    {
+        mockTimeUs = 0;
+        SimulatedTask busy{'B', 1000, nullptr};
+        TaskScheduler scheduler;
+        size_t task = scheduler.addTask(SimulatedTask::run, &busy, 1000);
+
+        EXPECT_TRUE(scheduler.runOnce());
+        EXPECT_TRUE(scheduler.runOnce());
+        EXPECT_EQ(scheduler.stats(task).runs, 2u);
+        EXPECT_EQ(scheduler.stats(task).overruns, 0u);
+        EXPECT_EQ(scheduler.stats(task).maxJitterUs, 0u);
+
+        // Ending 1 us after the release misses it
+        busy.durationUs = 1001;
+        EXPECT_TRUE(scheduler.runOnce());
+        EXPECT_EQ(scheduler.stats(task).overruns, 1u);
+        EXPECT_FALSE(scheduler.runOnce());
+    }
+
+} // namespace Tests
@@ -0,0 +1,219 @@
+/***********************************************************************
+ * @file	:	test_timer_wheel.cpp
+ * @brief 	:	Test cases for the timer wheel and the timeouts of the
+ *              state managers, on a virtual clock.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#include "timer_wheel.hpp"
+#include "fsm_state_manager.hpp"
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+
+using namespace StateMachine;
+
+namespace Tests {
+
+    enum class Owner : uint8_t { A, B, Q = 16 };
+    enum class Tick : uint8_t { T0, T1, T2, T3 };
+
+    using Wheel = TimerWheel<Owner, Tick, 8, 8>;
+    using Posted = std::vector<Tick>;
+
+    /**
+     * @brief Advance a wheel on a virtual clock, collecting the events posted.
+     */
+    template <typename W>
+    static Posted advance(W & wheel, TimerClock & clock, uint32_t ticks)
+    {
+        Posted posted;
+        clock.advance(ticks);
+        wheel.advance(clock.now(), [&posted](Tick event) { posted.push_back(event); });
+        return posted;
+    }
+
+    /**
+     * @test Verifies one-shot expiry in deadline order, including deadlines several laps away.
+     */
+    TEST(TimerWheelTest, OneShot)
+    {
+        Wheel wheel;
+        TimerClock clock;
+        wheel.arm(Tick::T2, 20);
+        wheel.arm(Tick::T0, 3);
+        wheel.arm(Tick::T1, 5);
+        EXPECT_EQ(wheel.pending(), 3u);
+
+        EXPECT_TRUE(advance(wheel, clock, 2).empty());
+        EXPECT_EQ(advance(wheel, clock, 1), Posted{Tick::T0});
+        EXPECT_EQ(advance(wheel, clock, 4), Posted{Tick::T1});
+        // Slot of tick 20 is visited twice before
+        EXPECT_TRUE(advance(wheel, clock, 12).empty());
+        EXPECT_EQ(advance(wheel, clock, 1), Posted{Tick::T2});
+        EXPECT_EQ(wheel.pending(), 0u);
+
+        // A jump of more than a lap posts every timer due
+        wheel.arm(Tick::T0, 2);
+        wheel.arm(Tick::T1, 30);
+        wheel.arm(Tick::T2, 31);
+        EXPECT_EQ(advance(wheel, clock, 30).size(), 2u);
+        EXPECT_EQ(advance(wheel, clock, 1), Posted{Tick::T2});
+    }
+
+    /**
+     * @test Verifies cancellation, stale handles and pool exhaustion.
+     */
+    TEST(TimerWheelTest, Cancel)
+    {
+        Wheel wheel;
+        TimerClock clock;
+        TimerId first = wheel.arm(Tick::T0, 4);
+        TimerId second = wheel.arm(Tick::T1, 4);
+        EXPECT_TRUE(wheel.cancel(first));
+        EXPECT_FALSE(wheel.cancel(first));
+        EXPECT_EQ(advance(wheel, clock, 4), Posted{Tick::T1});
+        EXPECT_FALSE(wheel.cancel(second));
+
+        // The freed timers are reused, old handles stay stale
+        std::vector<TimerId> ids;
+        for (size_t i = 0; i < Wheel::capacity(); i++)
+        {
+            ids.push_back(wheel.arm(Tick::T2, 1 + static_cast<uint32_t>(i)));
+            EXPECT_TRUE(ids.back().isValid());
+        }
+        EXPECT_FALSE(wheel.arm(Tick::T3, 1).isValid());
+        EXPECT_FALSE(wheel.cancel(first));
+        EXPECT_EQ(wheel.pending(), Wheel::capacity());
+        EXPECT_TRUE(wheel.cancel(ids[3]));
+        EXPECT_EQ(advance(wheel, clock, 100).size(), Wheel::capacity() - 1);
+        EXPECT_EQ(wheel.pending(), 0u);
+    }
+
+    /**
+     * @test Verifies that periodic timers repeat and skip the periods missed.
+     */
+    TEST(TimerWheelTest, Periodic)
+    {
+        Wheel wheel;
+        TimerClock clock;
+        TimerId heartbeat = wheel.arm(Tick::T3, 2, 3);
+        EXPECT_EQ(advance(wheel, clock, 2), Posted{Tick::T3});
+        EXPECT_TRUE(advance(wheel, clock, 2).empty());
+        EXPECT_EQ(advance(wheel, clock, 1), Posted{Tick::T3});
+        // Late by several periods, posted once
+        EXPECT_EQ(advance(wheel, clock, 10), Posted{Tick::T3});
+        EXPECT_EQ(advance(wheel, clock, 3), Posted{Tick::T3});
+        EXPECT_TRUE(wheel.cancel(heartbeat));
+        EXPECT_TRUE(advance(wheel, clock, 10).empty());
+    }
+
+    /**
+     * @test Verifies that owner cancellation removes only the timers of the owner, including owners
+     *       sharing a bucket.
+     */
+    TEST(TimerWheelTest, Owners)
+    {
+        Wheel wheel;
+        TimerClock clock;
+        wheel.armOwned(Owner::A, Tick::T0, 5);
+        wheel.armOwned(Owner::Q, Tick::T1, 5);
+        wheel.armOwned(Owner::A, Tick::T2, 6, 6);
+        wheel.arm(Tick::T3, 5);
+        EXPECT_EQ(wheel.cancelOwned(Owner::B), 0u);
+        EXPECT_EQ(wheel.cancelOwned(Owner::A), 2u);
+        EXPECT_EQ(wheel.pending(), 2u);
+        EXPECT_EQ(advance(wheel, clock, 10), (Posted{Tick::T3, Tick::T1}));
+        EXPECT_EQ(wheel.cancelOwned(Owner::Q), 0u);
+    }
+
+    /**
+     * @test Verifies hundreds of pending timers with different deadlines, each posted at its tick.
+     */
+    TEST(TimerWheelTest, ManyTimers)
+    {
+        constexpr uint32_t TIMERS = 500;
+        auto wheel = std::make_unique<TimerWheel<Owner, Tick, TIMERS>>();
+        TimerClock clock;
+        std::vector<TimerId> ids;
+        for (uint32_t i = 0; i < TIMERS; i++)
+        {
+            ids.push_back(wheel->arm(static_cast<Tick>(i % 4), 1 + (i * 7) % 1000));
+        }
+        // Cancel every fifth timer
+        for (uint32_t i = 0; i < TIMERS; i += 5)
+        {
+            EXPECT_TRUE(wheel->cancel(ids[i]));
+        }
+        size_t posted = 0;
+        for (uint32_t tick = 1; tick <= 1000; tick++)
+        {
+            size_t due = 0;
+            for (uint32_t i = 0; i < TIMERS; i++)
+            {
+                due += (i % 5 != 0 && 1 + (i * 7) % 1000 == tick) ? 1 : 0;
+            }
+            EXPECT_EQ(advance(*wheel, clock, 1).size(), due);
+            posted += due;
+        }
+        EXPECT_EQ(posted, TIMERS - TIMERS / 5);
+        EXPECT_EQ(wheel->pending(), 0u);
+    }
+
+    /**
+     * @test Verifies the robotic arm timeouts: armed on entering a state, posting their event when
+     *       due, and cancelled when the state is left before.
+     */
+    TEST(TimerWheelTest, RobotArmTimeouts)
+    {
+        using namespace StateMachine::RobotArm;
+        auto manager = std::make_unique<FSMStaticStateManager>();
+        TimerClock clock;
+        auto step = [&manager, &clock](uint32_t ticks) {
+            clock.advance(ticks);
+            manager->advanceTimers(clock.now());
+            manager->run();
+        };
+        manager->handleEvent(Event::Done);
+        manager->handleEvent(Event::Load);
+        manager->handleEvent(Event::ProgramLoaded);
+        manager->handleEvent(Event::Start);
+        step(0);
+        ASSERT_EQ(manager->getPerformingStateId(), StateId::StartProgram);
+        EXPECT_EQ(manager->getTimers().pending(), 1u);
+
+        // Homing done in time, the timeout is cancelled on exit
+        step(9000);
+        manager->handleEvent(Event::Done);
+        step(0);
+        EXPECT_EQ(manager->getPerformingStateId(), StateId::Execute);
+        EXPECT_EQ(manager->getTimers().pending(), 0u);
+
+        // Paused too long, the program is cancelled
+        manager->handleEvent(Event::Pause);
+        step(1);
+        EXPECT_EQ(manager->getTimers().pending(), 1u);
+        step(59999);
+        EXPECT_EQ(manager->getPerformingStateId(), StateId::Paused);
+        step(1);
+        step(0);
+        EXPECT_EQ(manager->getPerformingStateId(), StateId::ReadyAndLoaded);
+
+        // Homing timeout, through the virtual StateManager
+        auto fsm = std::make_unique<FSMStateManager>();
+        fsm->handleEvent(Event::Done);
+        fsm->handleEvent(Event::Load);
+        fsm->handleEvent(Event::ProgramLoaded);
+        fsm->handleEvent(Event::Start);
+        fsm->advanceTimers(clock.now());
+        fsm->run();
+        ASSERT_EQ(fsm->getPerformingStateId(), StateId::StartProgram);
+        clock.advance(10000);
+        fsm->advanceTimers(clock.now());
+        fsm->run();
+        EXPECT_EQ(fsm->getPerformingStateId(), StateId::ReadyAndLoaded);
+        EXPECT_EQ(fsm->getTimers().pending(), 0u);
+    }
+
+} // namespace Tests
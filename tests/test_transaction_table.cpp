@@ -0,0 +1,71 @@
+/***********************************************************************
+ * @file	:	test_transaction_table.cpp
+ * @brief 	:	Test cases for the transaction table.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#include "transaction_table.hpp"
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace Communication;
+
+namespace Tests {
+
+    template <size_t N>
+    static std::vector<uint8_t> serialize(const TransactionTable<N> & table, size_t capacity = BUFFER_SIZE)
+    {
+        std::vector<uint8_t> out(capacity);
+        out.resize(table.serialize(out.data(), capacity));
+        return out;
+    }
+
+    /**
+     * @test Verifies the positive and negative response format, in completion order.
+     */
+    TEST(TransactionTableTest, Responses)
+    {
+        TransactionTable<4> table;
+        EXPECT_TRUE(serialize(table).empty());
+        table.complete(0x02, 1, ResponseCode::Positive);
+        table.complete(0x05, 2, ResponseCode::ConditionsNotCorrect);
+        table.complete(0x04, 3, ResponseCode::Positive);
+        EXPECT_EQ(serialize(table), (std::vector<uint8_t>{0x42, 1, 0x7F, 0x05, 2, 0x22, 0x44, 3}));
+    }
+
+    /**
+     * @test Verifies that resolved requests move behind the ones completed meanwhile.
+     */
+    TEST(TransactionTableTest, Pending)
+    {
+        TransactionTable<4> table;
+        table.complete(0x09, 1, ResponseCode::Pending);
+        table.complete(0x09, 2, ResponseCode::Pending);
+        table.complete(0x01, 3, ResponseCode::Positive);
+        EXPECT_EQ(serialize(table), (std::vector<uint8_t>{0x7F, 0x09, 1, 0x78, 0x7F, 0x09, 2, 0x78, 0x41, 3}));
+
+        EXPECT_EQ(table.resolve(0x09, ResponseCode::Positive), 2u);
+        EXPECT_EQ(table.resolve(0x09, ResponseCode::Positive), 0u);
+        EXPECT_EQ(serialize(table), (std::vector<uint8_t>{0x41, 3, 0x49, 1, 0x49, 2}));
+    }
+
+    /**
+     * @test Verifies that the oldest requests are evicted, and left out when responses do not fit.
+     */
+    TEST(TransactionTableTest, Eviction)
+    {
+        TransactionTable<3> table;
+        for (uint8_t id = 1; id <= 4; id++)
+        {
+            table.complete(id, id, ResponseCode::Positive);
+        }
+        EXPECT_EQ(table.size(), 3u);
+        EXPECT_EQ(serialize(table), (std::vector<uint8_t>{0x42, 2, 0x43, 3, 0x44, 4}));
+        EXPECT_EQ(serialize(table, 5), (std::vector<uint8_t>{0x43, 3, 0x44, 4}));
+
+        table.clear();
+        EXPECT_TRUE(serialize(table).empty());
+    }
+
+} // namespace Tests
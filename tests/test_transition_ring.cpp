@@ -0,0 +1,305 @@
+/***********************************************************************
+ * @file	:	test_transition_ring.cpp
+ * @brief 	:	Test cases for the lock-free transition ring and
+ *              state managers under concurrent producers.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#include "transition_ring.hpp"
+#include "static_state_manager.hpp"
+#include "fsm_state_manager.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace StateMachine;
+
+namespace Tests {
+
+    // Five states in a cycle, Next and Back move to a neighbour
+    enum class Spot : uint8_t { S0, S1, S2, S3, S4 };
+    enum class Move : uint8_t { Next, Back, Stay };
+    constexpr uint8_t SPOTS = 5;
+
+    inline Spot spotMatrix(Spot spot, Move move)
+    {
+        uint8_t s = static_cast<uint8_t>(spot);
+        switch (move)
+        {
+            case Move::Next: return static_cast<Spot>((s + 1) % SPOTS);
+            case Move::Back: return static_cast<Spot>((s + SPOTS - 1) % SPOTS);
+            default:         return spot;
+        }
+    }
+
+    static bool isNeighbour(Spot a, Spot b)
+    {
+        return spotMatrix(a, Move::Next) == b || spotMatrix(a, Move::Back) == b;
+    }
+
+    /**
+     * @brief Random Next and Back moves from several threads, joined on destruction.
+     */
+    class Producers
+    {
+        public:
+            template <typename Post>
+            Producers(size_t count, size_t moves, Post post)
+            {
+                for (size_t p = 0; p < count; p++)
+                {
+                    threads.emplace_back([this, p, moves, post]() {
+                        std::mt19937 random(static_cast<uint32_t>(p) + 1);
+                        while (!start)
+                        {
+                            std::this_thread::yield();
+                        }
+                        for (size_t i = 0; i < moves; i++)
+                        {
+                            post((random() & 1) ? Move::Next : Move::Back);
+                        }
+                        running--;
+                    });
+                }
+                running = count;
+                start = true;
+            }
+
+            ~Producers()
+            {
+                join();
+            }
+
+            void join()
+            {
+                for (std::thread & thread : threads)
+                {
+                    if (thread.joinable())
+                    {
+                        thread.join();
+                    }
+                }
+            }
+
+            bool isRunning() const
+            {
+                return running > 0;
+            }
+
+        private:
+            std::vector<std::thread> threads;
+            std::atomic_bool start = false;
+            std::atomic<size_t> running = 0;
+    };
+
+    /**
+     * @test Verifies order of popped transitions, and that an overflow drops transitions from the
+     *       log but not from the state.
+     */
+    TEST(TransitionRingTest, TakePop)
+    {
+        TransitionRing<Spot, 4> ring(Spot::S0);
+        auto post = [&ring](Move move) { return ring.take([move](Spot s) { return spotMatrix(s, move); }); };
+        Spot spot;
+        EXPECT_FALSE(ring.pop(spot));
+        EXPECT_FALSE(post(Move::Stay));
+
+        for (int lap = 0; lap < 3; lap++)
+        {
+            EXPECT_TRUE(post(Move::Next));
+            EXPECT_TRUE(post(Move::Next));
+            EXPECT_TRUE(post(Move::Back));
+            ASSERT_TRUE(ring.pop(spot));
+            EXPECT_EQ(spot, static_cast<Spot>((lap + 1) % SPOTS));
+            ASSERT_TRUE(ring.pop(spot));
+            EXPECT_EQ(spot, static_cast<Spot>((lap + 2) % SPOTS));
+            ASSERT_TRUE(ring.pop(spot));
+            EXPECT_EQ(spot, static_cast<Spot>((lap + 1) % SPOTS));
+            EXPECT_FALSE(ring.pop(spot));
+        }
+        EXPECT_EQ(ring.current(), Spot::S3);
+
+        // Six transitions in a ring of four
+        for (int i = 0; i < 6; i++)
+        {
+            EXPECT_TRUE(post(Move::Next));
+        }
+        EXPECT_EQ(ring.current(), Spot::S4);
+        EXPECT_EQ(ring.dropped(), 2u);
+        EXPECT_TRUE(ring.isOverflowed());
+        EXPECT_EQ(ring.resynchronize(), Spot::S4);
+        EXPECT_FALSE(ring.isOverflowed());
+        EXPECT_FALSE(ring.pop(spot));
+
+        // Every slot is usable again
+        for (int i = 0; i < 4; i++)
+        {
+            EXPECT_TRUE(post(Move::Back));
+        }
+        for (int i = 0; i < 4; i++)
+        {
+            ASSERT_TRUE(ring.pop(spot));
+            EXPECT_EQ(spot, static_cast<Spot>(3 - i));
+        }
+        EXPECT_EQ(ring.dropped(), 2u);
+    }
+
+    /**
+     * @brief Consume a ring while producers run, checking that every popped transition continues
+     *        from the previous state. Returns the last state consumed.
+     */
+    template <size_t Capacity>
+    static Spot consume(TransitionRing<Spot, Capacity> & ring, Producers & producers, size_t & popped)
+    {
+        Spot last = Spot::S0;
+        Spot spot;
+        bool draining = true;
+        while (draining)
+        {
+            // Read before popping so transitions published after it are still consumed
+            draining = producers.isRunning();
+            while (ring.pop(spot))
+            {
+                EXPECT_TRUE(isNeighbour(last, spot));
+                last = spot;
+                popped++;
+            }
+            if (ring.isOverflowed())
+            {
+                last = ring.resynchronize();
+            }
+            std::this_thread::yield();
+        }
+        return last;
+    }
+
+    /**
+     * @test Verifies that transitions from concurrent producers are all logged in an order that
+     *       forms a valid walk, ending in the current state.
+     */
+    TEST(TransitionRingTest, ConcurrentProducers)
+    {
+        constexpr size_t PRODUCERS = 4;
+        constexpr size_t MOVES = 20000;
+        auto ring = std::make_unique<TransitionRing<Spot, 1 << 17>>(Spot::S0);
+        size_t popped = 0;
+        Producers producers(PRODUCERS, MOVES, [ring = ring.get()](Move move) {
+            ring->take([move](Spot s) { return spotMatrix(s, move); });
+        });
+        Spot last = consume(*ring, producers, popped);
+
+        EXPECT_EQ(ring->dropped(), 0u);
+        EXPECT_EQ(popped, PRODUCERS * MOVES);
+        EXPECT_EQ(last, ring->current());
+    }
+
+    /**
+     * @test Verifies that a small ring under concurrent producers recovers from overflows and the
+     *       consumer ends in the current state.
+     */
+    TEST(TransitionRingTest, ConcurrentOverflow)
+    {
+        constexpr size_t PRODUCERS = 4;
+        constexpr size_t MOVES = 20000;
+        auto ring = std::make_unique<TransitionRing<Spot, 8>>(Spot::S0);
+        size_t popped = 0;
+        Producers producers(PRODUCERS, MOVES, [ring = ring.get()](Move move) {
+            ring->take([move](Spot s) { return spotMatrix(s, move); });
+        });
+        Spot last = consume(*ring, producers, popped);
+
+        EXPECT_EQ(last, ring->current());
+        EXPECT_LE(popped + ring->dropped(), PRODUCERS * MOVES);
+    }
+
+    template <Spot id>
+    class Visited : public State<Spot, Move, spotMatrix>
+    {
+        public:
+            Visited(StateManager_ * instance) : State(id, instance) {}
+            void run() override { runCnt++; }
+            void onEnter() override { enteredCnt++; }
+            void onExit() override {}
+            size_t enteredCnt = 0;
+            size_t runCnt = 0;
+    };
+
+    /**
+     * @test Verifies that a state manager run while many threads post events ends in the state the
+     *       events lead to, whatever their interleaving.
+     */
+    TEST(TransitionRingTest, StaticStateManager)
+    {
+        constexpr size_t PRODUCERS = 8;
+        constexpr size_t MOVES = 5000;
+        using Manager = StaticStateManager<Spot, Move, spotMatrix, SPOTS, Visited<Spot::S0>, Visited<Spot::S1>,
+                                           Visited<Spot::S2>, Visited<Spot::S3>, Visited<Spot::S4>>;
+        Manager manager(Spot::S0);
+        std::atomic<size_t> transitions = 0;
+        {
+            Producers producers(PRODUCERS, MOVES, [&manager, &transitions](Move move) {
+                transitions += manager.handleEvent(std::move(move)) ? 1 : 0;
+            });
+            while (producers.isRunning())
+            {
+                manager.run();
+                std::this_thread::yield();
+            }
+        }
+        manager.run();
+
+        // Every event moves to a neighbour
+        EXPECT_EQ(transitions, PRODUCERS * MOVES);
+        EXPECT_EQ(manager.getPerformingStateId(), manager.getCurrentStateId());
+        size_t entered = manager.getState<Visited<Spot::S0>>().enteredCnt + manager.getState<Visited<Spot::S1>>().enteredCnt +
+                         manager.getState<Visited<Spot::S2>>().enteredCnt + manager.getState<Visited<Spot::S3>>().enteredCnt +
+                         manager.getState<Visited<Spot::S4>>().enteredCnt;
+        // The initial entry, one per logged transition and one per resynchronization, which
+        // skips at least one transition
+        EXPECT_LE(entered, 1 + PRODUCERS * MOVES);
+        EXPECT_GT(entered, 1u);
+    }
+
+    /**
+     * @test Verifies the robotic arm manager under concurrent producers of random events.
+     */
+    TEST(TransitionRingTest, RobotArm)
+    {
+        using namespace StateMachine::RobotArm;
+        auto manager = FSMStateManager::getInstance();
+        std::atomic_bool done = false;
+        std::vector<std::thread> producers;
+        for (uint32_t p = 0; p < 4; p++)
+        {
+            producers.emplace_back([manager, p]() {
+                std::mt19937 random(p);
+                for (int i = 0; i < 5000; i++)
+                {
+                    // No emergency stop, it is only left by a reset
+                    Event event = static_cast<Event>(1 + random() % (NUM_EVENTS - 1));
+                    manager->handleEvent(std::move(event));
+                }
+            });
+        }
+        std::thread consumer([manager, &done]() {
+            while (!done)
+            {
+                manager->run();
+                std::this_thread::yield();
+            }
+        });
+        for (std::thread & producer : producers)
+        {
+            producer.join();
+        }
+        done = true;
+        consumer.join();
+        manager->run();
+        EXPECT_EQ(manager->getPerformingStateId(), manager->getCurrentStateId());
+    }
+
+} // namespace Tests
@@ -0,0 +1,145 @@
+/***********************************************************************
+ * @file	:	test_transition_table.cpp
+ * @brief 	:	Test cases for the compile time transition table.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#include "transition_table.hpp"
+#include "fsm_state_manager.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+
+using namespace StateMachine;
+
+namespace Tests {
+
+    enum class Light : uint8_t { Off, Red, Green, Broken };
+    enum class Switch : uint8_t { Next, Fail };
+    using LightTransition = Transition<Light, Switch>;
+
+    constexpr LightTransition lightCycle[] = {{Light::Off, Switch::Next, Light::Red},
+                                              {Light::Red, Switch::Next, Light::Green},
+                                              {Light::Green, Switch::Next, Light::Red}};
+    constexpr LightTransition duplicate[] = {{Light::Off, Switch::Next, Light::Red},
+                                             {Light::Off, Switch::Next, Light::Green}};
+    constexpr Light working[] = {Light::Off, Light::Red, Light::Green};
+    constexpr Light all[] = {Light::Off, Light::Red, Light::Green, Light::Broken};
+
+    static_assert(hasUniqueTransitions(lightCycle));
+    static_assert(!hasUniqueTransitions(duplicate));
+    static_assert(usesOnlyStates(lightCycle, working));
+    static_assert(!usesOnlyStates(lightCycle, {Light::Off, Light::Red}));
+    static_assert(reachesStates(lightCycle, Light::Off, working));
+    static_assert(!reachesStates(lightCycle, Light::Off, all));
+    static_assert(!reachesStates(lightCycle, Light::Red, working));
+
+    /**
+     * @test Verifies lookups, including events without a transition and out of range values.
+     */
+    TEST(TransitionTableTest, Lookup)
+    {
+        constexpr TransitionTable<Light, Switch, 4, 2> table{lightCycle};
+        static_assert(table(Light::Off, Switch::Next) == Light::Red);
+        EXPECT_EQ(table(Light::Green, Switch::Next), Light::Red);
+        EXPECT_EQ(table(Light::Green, Switch::Fail), Light::Green);
+        EXPECT_EQ(table(Light::Broken, Switch::Next), Light::Broken);
+        EXPECT_EQ(table(static_cast<Light>(9), Switch::Next), static_cast<Light>(9));
+        EXPECT_EQ(table(Light::Red, static_cast<Switch>(9)), Light::Red);
+    }
+
+    /**
+     * @test Verifies hierarchical tables, where events bubble up to the closest ancestor handling
+     *       them and parent states themselves inherit from theirs.
+     */
+    TEST(TransitionTableTest, Hierarchy)
+    {
+        // Off and Broken are roots, Red and Green are children of Off
+        constexpr Parent<Light> lightParents[] = {{Light::Red, Light::Off}, {Light::Green, Light::Off}};
+        constexpr StateHierarchy<Light, 4> lights{lightParents};
+        constexpr LightTransition lightEdges[] = {{Light::Off, Switch::Fail, Light::Broken},
+                                                  {Light::Red, Switch::Next, Light::Green},
+                                                  {Light::Green, Switch::Next, Light::Red},
+                                                  {Light::Red, Switch::Fail, Light::Red}};
+        constexpr TransitionTable<Light, Switch, 4, 2> table{lightEdges, lights};
+        static_assert(lights.isWellFormed());
+        constexpr LightTransition toParent[] = {{Light::Broken, Switch::Next, Light::Off}};
+        static_assert(targetsLeaves(lightEdges, lights));
+        static_assert(!targetsLeaves(toParent, lights));
+        static_assert(reachesStates(table, Light::Green, {Light::Red, Light::Broken}));
+
+        EXPECT_EQ(table(Light::Green, Switch::Fail), Light::Broken);
+        EXPECT_EQ(table(Light::Red, Switch::Fail), Light::Red);
+        EXPECT_EQ(table(Light::Off, Switch::Next), Light::Off);
+        EXPECT_EQ(table(Light::Broken, Switch::Fail), Light::Broken);
+
+        EXPECT_EQ(lights.level(Light::Green), 2u);
+        EXPECT_EQ(lights.ancestor(Light::Green, 1), Light::Off);
+        EXPECT_EQ(lights.parent(Light::Broken), Light::Broken);
+        EXPECT_EQ(lights.sharedLevels(Light::Red, Light::Green), 1u);
+        EXPECT_EQ(lights.sharedLevels(Light::Red, Light::Red), 2u);
+        EXPECT_EQ(lights.sharedLevels(Light::Red, Light::Broken), 0u);
+        EXPECT_FALSE(lights.isLeaf(Light::Off));
+
+        constexpr Parent<Light> cycle[] = {{Light::Red, Light::Green}, {Light::Green, Light::Red}};
+        static_assert(!StateHierarchy<Light, 4>{cycle}.isWellFormed());
+    }
+
+    /**
+     * @test Verifies that the hierarchical robotic arm table behaves as the flat transition list
+     *       it replaced, and that the factory creates exactly the states transitions involve.
+     */
+    TEST(TransitionTableTest, RobotArm)
+    {
+        using namespace StateMachine::RobotArm;
+        constexpr Transition_ flatTransitions[] =
+            {
+                {StateId::Init,             Event::Done,            StateId::Ready},
+                {StateId::Init,             Event::EmergencyStop,   StateId::EmergencyStop},
+                {StateId::Ready,            Event::Load,            StateId::LoadProgram},
+                {StateId::Ready,            Event::Teach,           StateId::Teach},
+                {StateId::Ready,            Event::EmergencyStop,   StateId::EmergencyStop},
+                {StateId::LoadProgram,      Event::Cancel,          StateId::Ready},
+                {StateId::LoadProgram,      Event::ProgramLoaded,   StateId::ReadyAndLoaded},
+                {StateId::LoadProgram,      Event::EmergencyStop,   StateId::EmergencyStop},
+                {StateId::Teach,            Event::Cancel,          StateId::Ready},
+                {StateId::Teach,            Event::ProgramLoaded,   StateId::ReadyAndLoaded},
+                {StateId::Teach,            Event::EmergencyStop,   StateId::EmergencyStop},
+                {StateId::ReadyAndLoaded,   Event::Start,           StateId::StartProgram},
+                {StateId::ReadyAndLoaded,   Event::Load,            StateId::LoadProgram},
+                {StateId::ReadyAndLoaded,   Event::Teach,           StateId::Teach},
+                {StateId::ReadyAndLoaded,   Event::EmergencyStop,   StateId::EmergencyStop},
+                {StateId::StartProgram,     Event::Cancel,          StateId::ReadyAndLoaded},
+                {StateId::StartProgram,     Event::Done,            StateId::Execute},
+                {StateId::StartProgram,     Event::EmergencyStop,   StateId::EmergencyStop},
+                {StateId::Execute,          Event::Start,           StateId::StartProgram},
+                {StateId::Execute,          Event::Pause,           StateId::Paused},
+                {StateId::Execute,          Event::Done,            StateId::ReadyAndLoaded},
+                {StateId::Execute,          Event::Cancel,          StateId::ReadyAndLoaded},
+                {StateId::Execute,          Event::EmergencyStop,   StateId::EmergencyStop},
+                {StateId::Paused,           Event::Start,           StateId::StartProgram},
+                {StateId::Paused,           Event::Resume,          StateId::Execute},
+                {StateId::Paused,           Event::Cancel,          StateId::ReadyAndLoaded},
+                {StateId::Paused,           Event::EmergencyStop,   StateId::EmergencyStop}
+            };
+        constexpr TransitionTable<StateId, Event, NUM_STATES, NUM_EVENTS> flat{flatTransitions};
+        for (StateId state : leafStates)
+        {
+            for (size_t e = 0; e < NUM_EVENTS; e++)
+            {
+                Event event = static_cast<Event>(e);
+                EXPECT_EQ(stateTransMatrix(state, event), flat(state, event));
+            }
+        }
+        EXPECT_LT(std::size(transitions), std::size(flatTransitions));
+        EXPECT_EQ(stateTransMatrix(StateId::EmergencyStop, Event::Cancel), StateId::EmergencyStop);
+
+        for (size_t s = 0; s < NUM_STATES; s++)
+        {
+            StateId state = static_cast<StateId>(s);
+            bool created = std::find(std::begin(factoryStates), std::end(factoryStates), state) != std::end(factoryStates);
+            EXPECT_EQ(FSMStateFactory::createState(state, nullptr) != nullptr, created);
+        }
+    }
+
+} // namespace Tests
@@ -0,0 +1,359 @@
+/***********************************************************************
+ * @file	:	test_transport.cpp
+ * @brief 	:	Test cases for the transports the services run on.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#include "transport.hpp"
+#include "stream_framing.hpp"
+#include "loopback_transport.hpp"
+#include "uart_transport.hpp"
+#include "spi_transport.hpp"
+#include "communication_handler.hpp"
+#include "fsm_state_manager.hpp"
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace Communication;
+using namespace Communication::Hardware;
+
+namespace Tests {
+
+    struct ReceivedFrame
+    {
+        RxMessageId msgId;
+        std::vector<uint8_t> payload;
+
+        bool operator==(const ReceivedFrame & other) const
+        {
+            return msgId == other.msgId && payload == other.payload;
+        }
+    };
+
+    static std::vector<ReceivedFrame> frames;
+
+    static void recordFrame(RxMessageId msgId, size_t dataLength, const uint8_t * data)
+    {
+        frames.push_back({msgId, std::vector<uint8_t>(data, data + dataLength)});
+    }
+
+    static void fillByte(uint8_t * data)
+    {
+        *data = 0xEE;
+    }
+
+    static std::vector<uint8_t> streamFrame(const std::vector<uint8_t> & frame)
+    {
+        uint8_t out[STREAM_FRAME_SIZE];
+        size_t length = encodeStreamFrame(frame.data(), frame.size(), out);
+        return std::vector<uint8_t>(out, out + length);
+    }
+
+    /**
+     * @test Verifies that stream frames are cut and resynchronized after garbage.
+     */
+    TEST(StreamDecoderTest, ResyncAfterGarbage)
+    {
+        RxFrames pool;
+        StreamDecoder decoder(pool);
+        std::vector<uint8_t> stream = {0x00, 0x11, STREAM_SYNC, 0x00, STREAM_SYNC, STREAM_SYNC};
+        std::vector<uint8_t> frame = streamFrame({0x07, 1, 2});
+        // The last sync byte of the garbage is the first one of the frame
+        stream.insert(stream.end(), frame.begin() + 1, frame.end());
+        stream.push_back(STREAM_SYNC);
+        stream.push_back(BUFFER_SIZE + 1);
+        frame = streamFrame({0x05});
+        stream.insert(stream.end(), frame.begin(), frame.end());
+
+        size_t completed = 0;
+        for (uint8_t byte : stream)
+        {
+            if (decoder.feed(byte))
+            {
+                EXPECT_TRUE(pool.publish());
+                completed++;
+            }
+        }
+        EXPECT_EQ(completed, 2);
+
+        RxFrames::View view;
+        ASSERT_TRUE(pool.receive(view));
+        EXPECT_EQ(view.msgId(), 0x07);
+        EXPECT_EQ(view.payloadLength(), 2);
+        ASSERT_TRUE(pool.receive(view));
+        EXPECT_EQ(view.msgId(), 0x05);
+        EXPECT_EQ(view.payloadLength(), 0);
+    }
+
+    /**
+     * @test Verifies that frames which cannot be encoded are refused.
+     */
+    TEST(StreamDecoderTest, EncodeLimits)
+    {
+        uint8_t frame[BUFFER_SIZE + 1] = {};
+        uint8_t out[STREAM_FRAME_SIZE];
+        EXPECT_EQ(encodeStreamFrame(frame, 0, out), 0);
+        EXPECT_EQ(encodeStreamFrame(frame, BUFFER_SIZE + 1, out), 0);
+        EXPECT_EQ(encodeStreamFrame(frame, BUFFER_SIZE, out), STREAM_FRAME_SIZE);
+    }
+
+    /**
+     * @test Verifies that frames written by the master are dispatched from pump() and responses read back.
+     */
+    TEST(LoopbackTransportTest, DeferredRoundTrip)
+    {
+        LoopbackTransport transport;
+        transport.start(recordFrame, fillByte, DispatchMode::Deferred);
+        frames.clear();
+
+        const uint8_t frame[] = {0x03, 9, 8};
+        ASSERT_TRUE(transport.masterWrite(frame, sizeof(frame)));
+        EXPECT_TRUE(frames.empty());
+        EXPECT_EQ(transport.pump(), 1);
+        ASSERT_EQ(frames.size(), 1);
+        EXPECT_EQ(frames[0], (ReceivedFrame{0x03, {9, 8}}));
+
+        const uint8_t response[] = {0x10, 0x20};
+        ASSERT_TRUE(transport.publishResponse(response, sizeof(response)));
+        uint8_t read[4];
+        EXPECT_EQ(transport.masterRead(read, sizeof(read)), 2);
+        EXPECT_EQ(std::vector<uint8_t>(read, read + 4), (std::vector<uint8_t>{0x10, 0x20, 0xEE, 0xEE}));
+        EXPECT_EQ(transport.pendingResponses(), 0);
+    }
+
+    /**
+     * @test Verifies that in Immediate mode frames are dispatched by the write and limits are reported.
+     */
+    TEST(LoopbackTransportTest, ImmediateAndLimits)
+    {
+        LoopbackTransport transport;
+        transport.start(recordFrame, nullptr, DispatchMode::Immediate);
+        frames.clear();
+
+        const uint8_t frame[] = {0x01};
+        ASSERT_TRUE(transport.masterWrite(frame, sizeof(frame)));
+        EXPECT_EQ(frames.size(), 1);
+        EXPECT_EQ(transport.pump(), 0);
+        EXPECT_FALSE(transport.masterWrite(frame, 0));
+
+        for (size_t i = 0; i < LOOPBACK_RESPONSE_SLOTS; i++)
+        {
+            EXPECT_TRUE(transport.publishResponse(frame, sizeof(frame)));
+        }
+        EXPECT_FALSE(transport.publishResponse(frame, sizeof(frame)));
+    }
+
+    /**
+     * @test Verifies that corrupted frames are dropped by any pooled transport.
+     */
+    TEST(LoopbackTransportTest, Integrity)
+    {
+        LoopbackTransport transport;
+        transport.start(recordFrame, nullptr, DispatchMode::Deferred);
+        transport.setIntegrity(Integrity::Crc32);
+        frames.clear();
+
+        uint8_t frame[BUFFER_SIZE] = {0x02, 1};
+        size_t length = appendIntegrity(Integrity::Crc32, frame, 2);
+        ASSERT_TRUE(transport.masterWrite(frame, length));
+        frame[1] = 2;
+        ASSERT_TRUE(transport.masterWrite(frame, length));
+        EXPECT_EQ(transport.pump(), 1);
+        EXPECT_EQ(frames, (std::vector<ReceivedFrame>{{0x02, {1}}}));
+        EXPECT_EQ(transport.corruptedFrames(), 1);
+    }
+
+    /**
+     * @test Verifies that the robot arm services run unchanged over the loopback transport.
+     */
+    TEST(LoopbackTransportTest, RobotArmServices)
+    {
+        LoopbackTransport transport;
+        RobotArm::startServices(transport, DispatchMode::Deferred);
+
+        // Program data outside of LoadProgram is ignored but answered
+        const uint8_t frame[] = {RAW(RobotArm::RxIds::PROGRAM_DATA), 1, 2, 3, 4};
+        ASSERT_TRUE(transport.masterWrite(frame, sizeof(frame)));
+        EXPECT_EQ(RobotArm::serviceTransport(transport), 1);
+        EXPECT_EQ(RobotArm::serviceTransport(transport), 0);
+
+        uint8_t read[1];
+        EXPECT_EQ(transport.masterRead(read, sizeof(read)), 1);
+        EXPECT_EQ(read[0], 0x07);
+        EXPECT_EQ(transport.pendingResponses(), 0);
+        RobotArm::stopServices();
+    }
+
+    /**
+     * @test Verifies that requests with transaction ids written back to back are answered by a
+     *       single read, in completion order, including a program loaded right after LOAD.
+     */
+    TEST(LoopbackTransportTest, PipelinedTransactions)
+    {
+        using StateMachine::RobotArm::Event;
+        using StateMachine::RobotArm::StateId;
+        auto stateManager = StateMachine::RobotArm::FSMStateManager::getInstance();
+        // The singleton may have been moved by the tests before
+        stateManager->restart(StateId::Init);
+        stateManager->handleEvent(Event::Done);
+        stateManager->run();
+        ASSERT_EQ(stateManager->getPerformingStateId(), StateId::Ready);
+
+        LoopbackTransport transport;
+        RobotArm::startServices(transport, DispatchMode::Deferred);
+        constexpr uint8_t flag = TRANSACTION_FLAG;
+
+        // LOAD, then a single waypoint program as a segmented first frame
+        const uint8_t load[] = {flag | RAW(RobotArm::RxIds::LOAD), 1};
+        uint8_t program[BUFFER_SIZE] = {flag | RAW(RobotArm::RxIds::PROGRAM_SEGMENT), 2, 0x10, 0, 0, 0,
+                                        sizeof(Robotics::Waypoint_t)};
+        static_assert(7 + sizeof(Robotics::Waypoint_t) <= BUFFER_SIZE);
+        const uint8_t start[] = {flag | RAW(RobotArm::RxIds::START), 3};
+        // Not accepted while starting
+        const uint8_t teach[] = {flag | RAW(RobotArm::RxIds::TEACH), 4};
+        ASSERT_TRUE(transport.masterWrite(load, sizeof(load)));
+        ASSERT_TRUE(transport.masterWrite(program, 7 + sizeof(Robotics::Waypoint_t)));
+        ASSERT_TRUE(transport.masterWrite(start, sizeof(start)));
+        ASSERT_TRUE(transport.masterWrite(teach, sizeof(teach)));
+        EXPECT_EQ(RobotArm::serviceTransport(transport), 4);
+
+        uint8_t read[BUFFER_SIZE];
+        ASSERT_EQ(transport.masterRead(read, 10), 10);
+        EXPECT_EQ(std::vector<uint8_t>(read, read + 10),
+                  (std::vector<uint8_t>{0x42, 1, 0x49, 2, 0x44, 3, 0x7F, 0x03, 4, 0x22}));
+        EXPECT_EQ(stateManager->getCurrentStateId(), StateId::StartProgram);
+
+        // Unknown services and requests without a transaction id are answered negatively
+        const uint8_t unknown[] = {flag | 0x3F, 5};
+        const uint8_t noId[] = {flag | RAW(RobotArm::RxIds::CANCEL)};
+        ASSERT_TRUE(transport.masterWrite(unknown, sizeof(unknown)));
+        ASSERT_TRUE(transport.masterWrite(noId, sizeof(noId)));
+        EXPECT_EQ(RobotArm::serviceTransport(transport), 2);
+        ASSERT_EQ(transport.masterRead(read, BUFFER_SIZE), 18);
+        EXPECT_EQ(std::vector<uint8_t>(read + 10, read + 18),
+                  (std::vector<uint8_t>{0x7F, 0x3F, 5, 0x11, 0x7F, 0x01, 0, 0x13}));
+        RobotArm::stopServices();
+    }
+
+    /**
+     * @test Verifies that the uart transport decodes frames written by DMA into its ring, across wraps.
+     */
+    TEST(UartTransportTest, ReceiveAndRespond)
+    {
+        UartTransport transport(uart1);
+        transport.start(recordFrame, nullptr, DispatchMode::Deferred);
+        frames.clear();
+
+        int rxChannel = mockDmaChannelFor(DREQ_UART1_RX);
+        ASSERT_GE(rxChannel, 0);
+
+        // More bytes than the ring holds, pumped as they arrive
+        uint32_t wraps = commStatistics.ringWraps.get();
+        size_t sent = 0;
+        uint8_t id = 0;
+        while (sent < 3 * UART_RX_RING_SIZE)
+        {
+            std::vector<uint8_t> frame = streamFrame({id, static_cast<uint8_t>(~id), 0x55});
+            for (uint8_t byte : frame)
+            {
+                ASSERT_TRUE(mockDmaPush(rxChannel, byte));
+            }
+            sent += frame.size();
+            EXPECT_EQ(transport.pump(), 1);
+            ASSERT_EQ(frames.size(), id + 1u);
+            EXPECT_EQ(frames.back(), (ReceivedFrame{id, {static_cast<uint8_t>(~id), 0x55}}));
+            id++;
+        }
+        EXPECT_EQ(commStatistics.ringWraps.get() - wraps, sent / UART_RX_RING_SIZE);
+
+        const uint8_t response[] = {0x07};
+        ASSERT_TRUE(transport.publishResponse(response, sizeof(response)));
+        EXPECT_FALSE(transport.publishResponse(response, sizeof(response)));
+        int txChannel = mockDmaChannelFor(DREQ_UART1_TX);
+        ASSERT_GE(txChannel, 0);
+        std::vector<uint8_t> sentResponse;
+        uint32_t value;
+        while (mockDmaPull(txChannel, value))
+        {
+            sentResponse.push_back(static_cast<uint8_t>(value));
+        }
+        EXPECT_EQ(sentResponse, streamFrame({0x07}));
+        EXPECT_TRUE(transport.publishResponse(response, sizeof(response)));
+    }
+
+    /**
+     * @test Verifies that bytes overwritten in the ring before being pumped are counted and that
+     *       decoding resumes with the next frame.
+     */
+    TEST(UartTransportTest, RingOverrun)
+    {
+        UartTransport transport(uart1);
+        transport.start(recordFrame, nullptr, DispatchMode::Deferred);
+        frames.clear();
+        int rxChannel = mockDmaChannelFor(DREQ_UART1_RX);
+        ASSERT_GE(rxChannel, 0);
+
+        uint32_t overruns = commStatistics.ringOverruns.get();
+        for (size_t i = 0; i < UART_RX_RING_SIZE + 8; i++)
+        {
+            ASSERT_TRUE(mockDmaPush(rxChannel, 0x55));
+        }
+        EXPECT_EQ(transport.pump(), 0);
+        EXPECT_EQ(commStatistics.ringOverruns.get() - overruns, 1u);
+
+        for (uint8_t byte : streamFrame({0x04, 0x01}))
+        {
+            ASSERT_TRUE(mockDmaPush(rxChannel, byte));
+        }
+        EXPECT_EQ(transport.pump(), 1);
+        ASSERT_EQ(frames.size(), 1u);
+        EXPECT_EQ(frames.back(), (ReceivedFrame{0x04, {0x01}}));
+        EXPECT_EQ(commStatistics.ringOverruns.get() - overruns, 1u);
+    }
+
+    /**
+     * @test Verifies that the spi transport receives one frame per chip select and answers in the next one.
+     */
+    TEST(SpiTransportTest, FramePerChipSelect)
+    {
+        SpiTransport transport(spi0);
+        transport.start(recordFrame, nullptr, DispatchMode::Immediate);
+        frames.clear();
+
+        auto transaction = [](const std::vector<uint8_t> & mosi) {
+            std::vector<uint8_t> miso;
+            mockGpioEdge(DEFAULT_SPI_CS_PIN, GPIO_IRQ_EDGE_FALL);
+            int rxChannel = mockDmaChannelFor(DREQ_SPI0_RX);
+            int txChannel = mockDmaChannelFor(DREQ_SPI0_TX);
+            EXPECT_GE(txChannel, 0);
+            for (uint8_t byte : mosi)
+            {
+                uint32_t value = 0;
+                if (txChannel >= 0)
+                {
+                    mockDmaPull(txChannel, value);
+                }
+                miso.push_back(static_cast<uint8_t>(value));
+                if (rxChannel >= 0)
+                {
+                    mockDmaPush(rxChannel, byte);
+                }
+            }
+            mockGpioEdge(DEFAULT_SPI_CS_PIN, GPIO_IRQ_EDGE_RISE);
+            return miso;
+        };
+
+        EXPECT_EQ(transaction({0x04, 1, 2}), (std::vector<uint8_t>{0, 0, 0}));
+        EXPECT_EQ(frames, (std::vector<ReceivedFrame>{{0x04, {1, 2}}}));
+
+        const uint8_t response[] = {0x07, 0x08};
+        ASSERT_TRUE(transport.publishResponse(response, sizeof(response)));
+        EXPECT_EQ(transaction({0x05, 0, 0}), (std::vector<uint8_t>{0x07, 0x08, 0}));
+        EXPECT_EQ(frames.size(), 2);
+
+        // Responses are sent once
+        EXPECT_EQ(transaction({0x06}), (std::vector<uint8_t>{0}));
+    }
+
+} // namespace Tests
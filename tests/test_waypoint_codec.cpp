@@ -0,0 +1,107 @@
+/***********************************************************************
+ * @file	:	test_waypoint_codec.cpp
+ * @brief 	:	Test cases for the delta varint waypoint codec.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#include "waypoint_codec.hpp"
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace Robotics;
+
+namespace Tests {
+
+    static std::vector<QuantizedWaypoint_t> decoded;
+
+    static void collect(const QuantizedWaypoint_t * waypoints, size_t count)
+    {
+        EXPECT_LE(count, DECODE_BATCH);
+        decoded.insert(decoded.end(), waypoints, waypoints + count);
+    }
+
+    static std::vector<uint8_t> encode(const std::vector<QuantizedWaypoint_t> & waypoints)
+    {
+        WaypointEncoder encoder;
+        std::vector<uint8_t> stream;
+        uint8_t out[MAX_ENCODED_WAYPOINT];
+        for (const QuantizedWaypoint_t & waypoint : waypoints)
+        {
+            size_t length = encoder.encode(waypoint, out);
+            EXPECT_LE(length, MAX_ENCODED_WAYPOINT);
+            stream.insert(stream.end(), out, out + length);
+        }
+        return stream;
+    }
+
+    /**
+     * @test Verifies that small increments take a byte per joint and the largest ones three.
+     */
+    TEST(WaypointCodecTest, EncodedSize)
+    {
+        std::vector<QuantizedWaypoint_t> program = {{{0, 1, -1, 63, -64, 0}},
+                                                    {{0, 1, -1, 63, -64, 0}},
+                                                    {{INT16_MIN, INT16_MAX, 64, 63, -64, 0}},
+                                                    {{INT16_MAX, INT16_MIN, 64, 63, -64, 0}}};
+        std::vector<uint8_t> stream = encode(program);
+        EXPECT_EQ(stream.size(), 6u + 6u + (3 + 3 + 2 + 1 + 1 + 1) + (3 + 3 + 1 + 1 + 1 + 1));
+        EXPECT_EQ(std::vector<uint8_t>(stream.begin(), stream.begin() + 6),
+                  (std::vector<uint8_t>{0x00, 0x02, 0x01, 0x7E, 0x7F, 0x00}));
+    }
+
+    /**
+     * @test Verifies that the stream decodes the same whatever the pieces it is received in.
+     */
+    TEST(WaypointCodecTest, IncrementalDecode)
+    {
+        std::vector<QuantizedWaypoint_t> program;
+        for (int i = 0; i < 50; i++)
+        {
+            int16_t q = static_cast<int16_t>(i * i * 13 - 16000);
+            program.push_back({{q, static_cast<int16_t>(-q), static_cast<int16_t>(i), 0, INT16_MIN, INT16_MAX}});
+        }
+        std::vector<uint8_t> stream = encode(program);
+
+        for (size_t piece : {size_t(1), size_t(2), size_t(7), size_t(31), stream.size()})
+        {
+            decoded.clear();
+            WaypointDecoder decoder(collect);
+            for (size_t offset = 0; offset < stream.size(); offset += piece)
+            {
+                size_t length = std::min(piece, stream.size() - offset);
+                ASSERT_TRUE(decoder.decode(stream.data() + offset, length));
+                // Whole waypoints are handed over by the end of each piece
+                EXPECT_EQ(decoded.size(), decoder.getDecodedWaypoints());
+            }
+            EXPECT_TRUE(decoder.atWaypointBoundary());
+            ASSERT_EQ(decoded.size(), program.size());
+            EXPECT_EQ(memcmp(decoded.data(), program.data(), program.size() * sizeof(QuantizedWaypoint_t)), 0);
+        }
+    }
+
+    /**
+     * @test Verifies that over long varints, out of range values and truncated streams are detected.
+     */
+    TEST(WaypointCodecTest, Malformed)
+    {
+        decoded.clear();
+        WaypointDecoder decoder(collect);
+        const uint8_t truncated[] = {0x02, 0x02, 0x02, 0x82};
+        EXPECT_TRUE(decoder.decode(truncated, sizeof(truncated)));
+        EXPECT_FALSE(decoder.atWaypointBoundary());
+
+        const uint8_t tooLong[] = {0x80, 0x80, 0x80, 0x01};
+        decoder.reset();
+        EXPECT_FALSE(decoder.decode(tooLong, sizeof(tooLong)));
+        EXPECT_TRUE(decoder.isMalformed());
+        EXPECT_FALSE(decoder.decode(truncated, sizeof(truncated)));
+
+        // 0 + 32768 is beyond int16
+        const uint8_t outOfRange[] = {0x80, 0x80, 0x04};
+        decoder.reset();
+        EXPECT_FALSE(decoder.decode(outOfRange, sizeof(outOfRange)));
+        EXPECT_TRUE(decoded.empty());
+    }
+
+} // namespace Tests
@@ -0,0 +1,118 @@
+/***********************************************************************
+ * @file	:	test_waypoint_quantization.cpp
+ * @brief 	:	Test cases for quantized waypoints and their precision.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ ***********************************************************************/
+
+#include "waypoint_quantization.hpp"
+#include "trajectory.hpp"
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace Robotics;
+
+namespace Tests {
+
+    static float joint(const Waypoint_t & waypoint, size_t index)
+    {
+        float joints[NUM_JOINTS];
+        memcpy(joints, &waypoint, sizeof(joints));
+        return joints[index];
+    }
+
+    /**
+     * @test Verifies the format sizes: half the wire size of Waypoint_t, a scale header of whole records.
+     */
+    TEST(WaypointQuantizationTest, Sizes)
+    {
+        EXPECT_EQ(sizeof(QuantizedWaypoint_t), 12u);
+        EXPECT_EQ(2 * sizeof(QuantizedWaypoint_t), sizeof(Waypoint_t));
+        EXPECT_EQ(sizeof(WaypointScale_t), 4 * sizeof(QuantizedWaypoint_t));
+    }
+
+    /**
+     * @test Verifies that the error is at most half a step over the coordinate limits, 4.8e-5 rad
+     *       (0.0027 deg) for a full turn, and smaller over a narrower program scale.
+     */
+    TEST(WaypointQuantizationTest, Precision)
+    {
+        const JointScale_t fullTurn = coordinateScale().q[0];
+        const JointScale_t narrow = {-0.5f, 0.5f};
+        EXPECT_NEAR(quantizationStep(fullTurn), 2 * PI / 65535, 1e-9);
+        EXPECT_LT(quantizationStep(fullTurn) / 2, 4.8e-5f);
+
+        std::mt19937 generator(7);
+        for (const JointScale_t & scale : {fullTurn, narrow})
+        {
+            std::uniform_real_distribution<float> values(scale.min, scale.max);
+            // Half a step, plus the float rounding of values around max
+            float bound = quantizationStep(scale) / 2 + 4 * std::numeric_limits<float>::epsilon() * scale.max;
+            float worst = 0;
+            for (int i = 0; i < 100000; i++)
+            {
+                float value = values(generator);
+                worst = std::max(worst, std::fabs(dequantize(quantize(value, scale), scale) - value));
+            }
+            EXPECT_LE(worst, bound);
+        }
+    }
+
+    /**
+     * @test Verifies that the limits are exact, values beyond them clamped and empty ranges handled.
+     */
+    TEST(WaypointQuantizationTest, Limits)
+    {
+        const JointScale_t scale = {-2.0f, 3.0f};
+        EXPECT_EQ(quantize(-2.0f, scale), INT16_MIN);
+        EXPECT_EQ(quantize(3.0f, scale), INT16_MAX);
+        EXPECT_EQ(dequantize(INT16_MIN, scale), -2.0f);
+        EXPECT_NEAR(dequantize(INT16_MAX, scale), 3.0f, 1e-6);
+        EXPECT_EQ(quantize(-10.0f, scale), INT16_MIN);
+        EXPECT_EQ(quantize(10.0f, scale), INT16_MAX);
+        EXPECT_EQ(quantize(NAN, scale), INT16_MIN);
+
+        const JointScale_t empty = {1.0f, 1.0f};
+        EXPECT_EQ(quantize(1.0f, empty), INT16_MIN);
+        EXPECT_EQ(dequantize(INT16_MAX, empty), 1.0f);
+    }
+
+    /**
+     * @test Verifies that the trajectory stores quantized waypoints and decodes them with the program
+     *       scale when taken, after the float waypoints.
+     */
+    TEST(WaypointQuantizationTest, Trajectory)
+    {
+        WaypointScale_t scale = {{{0, 1}, {0, 2}, {0, 3}, {0, 4}, {0, 5}, {-PI, PI}}};
+        Waypoint_t program[2] = {{0.25f, 0.5f, 0.75f, 1.0f, 1.25f, -1.0f}, {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, PI}};
+        QuantizedWaypoint_t quantized[2] = {quantize(program[0], scale), quantize(program[1], scale)};
+        Waypoint_t first = {9, 9, 9, 9, 9, 9};
+
+        Trajectory trajectory;
+        trajectory.saveWaypoints(&first, 1);
+        trajectory.setScale(scale);
+        trajectory.saveQuantizedWaypoints(reinterpret_cast<const uint8_t *>(quantized), sizeof(quantized));
+        EXPECT_EQ(trajectory.numOfWaypoints(), 3u);
+
+        EXPECT_EQ(joint(trajectory.getNextWaypoint(), 0), 9.0f);
+        for (const Waypoint_t & expected : program)
+        {
+            ASSERT_FALSE(trajectory.isTrajectoryComplete());
+            Waypoint_t waypoint = trajectory.getNextWaypoint();
+            for (size_t i = 0; i < NUM_JOINTS; i++)
+            {
+                EXPECT_NEAR(joint(waypoint, i), joint(expected, i), quantizationStep(scale.q[i]));
+            }
+        }
+        EXPECT_TRUE(trajectory.isTrajectoryComplete());
+
+        // Clearing restores the coordinate limits as scale
+        trajectory.saveQuantizedWaypoints(reinterpret_cast<const uint8_t *>(quantized), sizeof(quantized));
+        trajectory.clearWaypoints();
+        EXPECT_EQ(trajectory.numOfWaypoints(), 0u);
+        QuantizedWaypoint_t lowest = {{INT16_MIN, INT16_MIN, INT16_MIN, INT16_MIN, INT16_MIN, INT16_MIN}};
+        trajectory.saveQuantizedWaypoints(reinterpret_cast<const uint8_t *>(&lowest), sizeof(lowest));
+        EXPECT_EQ(joint(trajectory.getNextWaypoint(), 0), -PI);
+    }
+
+} // namespace Tests
@@ -0,0 +1,194 @@
+/***********************************************************************
+ * @file	:	trace_replay.cpp
+ * @brief 	:	Host replay of recorded bus traffic.
+ *              Feeds a frame trace to rxCallback with the real state
+ *              manager and trajectory, and reports frames per second
+ *              and per-frame handler latency percentiles.
+ * @author	:	Marco Valdez @mvaldezc
+ *
+ *  Usage: trace_replay <trace> [--realtime] [--repeat N]
+ *         trace_replay --synthesize <trace> [waypoints]
+ *
+ ***********************************************************************/
+
+#include "communication_handler.hpp"
+#include "frame_trace.hpp"
+#include "segmented_transfer.hpp"
+#include "fsm_state_manager.hpp"
+#include "trajectory.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+using namespace Communication;
+using namespace Communication::RobotArm;
+using Clock = std::chrono::steady_clock;
+
+// Bus time of a frame at 400kHz, START, bytes of 9 bits and STOP
+static uint32_t frameTimeUs(size_t length)
+{
+    return static_cast<uint32_t>((2 + 9 * length) * 2.5);
+}
+
+/**
+ * @brief Write a trace of a program load and run as sent by the master: LOAD, the program as a
+ *        segmented message, START, then PAUSE and RESUME.
+ */
+static int synthesize(const char * path, size_t waypoints)
+{
+    std::vector<Robotics::Waypoint_t> program(waypoints);
+    for (size_t i = 0; i < waypoints; i++)
+    {
+        float q = static_cast<float>(i);
+        program[i] = {q, q + 1, q + 2, q + 3, q + 4, q + 5};
+    }
+    const size_t programBytes = waypoints * sizeof(Robotics::Waypoint_t);
+    std::vector<uint8_t> trace(TRACE_HEADER_SIZE + (4 + programBytes / 8) * TRACE_MAX_RECORD);
+    TraceRecorder recorder(trace.data(), trace.size());
+
+    uint32_t timeUs = 0;
+    auto send = [&](const uint8_t * frame, size_t length) {
+        recorder.record(timeUs, frame[0], frame + 1, length - 1);
+        // Master polls the response between frames
+        timeUs += frameTimeUs(length) + frameTimeUs(1) + 100;
+    };
+    const uint8_t load[] = {RAW(RxIds::LOAD)};
+    send(load, sizeof(load));
+    SegmentedSender sender(RAW(RxIds::PROGRAM_SEGMENT), reinterpret_cast<const uint8_t *>(program.data()),
+                           static_cast<uint32_t>(programBytes));
+    uint8_t frame[BUFFER_SIZE];
+    size_t length;
+    while ((length = sender.nextFrame(frame)) != 0)
+    {
+        send(frame, length);
+    }
+    for (RxIds id : {RxIds::START, RxIds::PAUSE, RxIds::RESUME})
+    {
+        const uint8_t command[] = {RAW(id)};
+        send(command, sizeof(command));
+    }
+
+    std::ofstream out(path, std::ios::binary);
+    out.write(reinterpret_cast<const char *>(recorder.buffer()), static_cast<std::streamsize>(recorder.size()));
+    if (!out || recorder.droppedRecords() > 0)
+    {
+        fprintf(stderr, "Failed to write %s\n", path);
+        return 1;
+    }
+    printf("%s: %zu waypoints, %zu bytes\n", path, waypoints, recorder.size());
+    return 0;
+}
+
+static double percentile(const std::vector<double> & sorted, double p)
+{
+    size_t index = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[index];
+}
+
+/**
+ * @brief Replay a trace into rxCallback, running the state machine after every frame as the
+ *        main loop does.
+ */
+static int replay(const char * path, bool realtime, size_t repeat)
+{
+    std::ifstream in(path, std::ios::binary);
+    std::vector<uint8_t> trace((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    TraceReader header(trace.data(), trace.size());
+    if (!in.good() && !in.eof())
+    {
+        fprintf(stderr, "Cannot read %s\n", path);
+        return 1;
+    }
+    if (!header.isValid())
+    {
+        fprintf(stderr, "%s is not a frame trace\n", path);
+        return 1;
+    }
+
+    auto stateManager = StateMachine::RobotArm::FSMStateManager::getInstance();
+    stateManager->handleEvent(StateMachine::RobotArm::Event::Done);
+    stateManager->run();
+    auto trajectory = std::make_shared<Robotics::Trajectory>();
+    installDataContainer(trajectory);
+
+    std::vector<double> latenciesUs;
+    Clock::time_point start = Clock::now();
+    for (size_t pass = 0; pass < repeat; pass++)
+    {
+        trajectory->clearWaypoints();
+        TraceReader reader(trace.data(), trace.size());
+        TraceRecord record;
+        Clock::time_point passStart = Clock::now();
+        while (reader.next(record))
+        {
+            if (realtime)
+            {
+                std::this_thread::sleep_until(passStart + std::chrono::microseconds(record.timeUs));
+            }
+            Clock::time_point frameStart = Clock::now();
+            rxCallback(record.frame[0], record.length - 1, record.frame + 1);
+            stateManager->run();
+            std::chrono::duration<double, std::micro> latency = Clock::now() - frameStart;
+            latenciesUs.push_back(latency.count());
+        }
+    }
+    std::chrono::duration<double> elapsed = Clock::now() - start;
+    uninstallDataContainer();
+
+    if (latenciesUs.empty())
+    {
+        fprintf(stderr, "%s holds no frames\n", path);
+        return 1;
+    }
+    double handlerUs = 0;
+    for (double latency : latenciesUs)
+    {
+        handlerUs += latency;
+    }
+    std::sort(latenciesUs.begin(), latenciesUs.end());
+    printf("frames:             %zu\n", latenciesUs.size());
+    printf("elapsed:            %.3f s\n", elapsed.count());
+    printf("frames/s:           %.0f\n", static_cast<double>(latenciesUs.size()) / elapsed.count());
+    printf("handler frames/s:   %.0f\n", 1e6 * static_cast<double>(latenciesUs.size()) / handlerUs);
+    printf("latency us p50:     %.3f\n", percentile(latenciesUs, 0.50));
+    printf("latency us p90:     %.3f\n", percentile(latenciesUs, 0.90));
+    printf("latency us p99:     %.3f\n", percentile(latenciesUs, 0.99));
+    printf("latency us max:     %.3f\n", latenciesUs.back());
+    printf("final state:        %d\n", static_cast<int>(stateManager->getPerformingStateId()));
+    return 0;
+}
+
+int main(int argc, char ** argv)
+{
+    if (argc >= 3 && strcmp(argv[1], "--synthesize") == 0)
+    {
+        size_t waypoints = (argc >= 4) ? strtoul(argv[3], nullptr, 10) : 1000;
+        return synthesize(argv[2], waypoints);
+    }
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s <trace> [--realtime] [--repeat N]\n"
+                        "       %s --synthesize <trace> [waypoints]\n", argv[0], argv[0]);
+        return 2;
+    }
+    bool realtime = false;
+    size_t repeat = 1;
+    for (int i = 2; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--realtime") == 0)
+        {
+            realtime = true;
+        }
+        else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+        {
+            repeat = std::max<size_t>(1, strtoul(argv[++i], nullptr, 10));
+        }
+    }
+    return replay(argv[1], realtime, repeat);
+}